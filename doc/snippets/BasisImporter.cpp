@@ -85,6 +85,33 @@ image = importer->image2D(0);
 /* [target-format-config] */
 }
 
+{
+PluginManager::Manager<Trade::AbstractImporter> manager;
+Containers::Optional<Trade::ImageData2D> image;
+/* [cache-formats] */
+Containers::Pointer<Trade::AbstractImporter> importer =
+    manager.instantiate("BasisImporter");
+
+/* Transcode to BC7 and ASTC at the same time, and keep up to 64 MB of the
+   returned data around */
+importer->configuration().setValue("format", "Bc7RGBA");
+importer->configuration().setValue("cacheFormats", "Astc4x4RGBA");
+importer->configuration().setValue("cacheSize", 64*1024*1024);
+importer->openFile("mytexture.basis");
+for(UnsignedInt level = 0; level != importer->image2DLevelCount(0); ++level) {
+    image = importer->image2D(0, level);
+    // ...
+}
+
+/* All levels returned from the cache without transcoding again */
+importer->configuration().setValue("format", "Astc4x4RGBA");
+for(UnsignedInt level = 0; level != importer->image2DLevelCount(0); ++level) {
+    image = importer->image2D(0, level);
+    // ...
+}
+/* [cache-formats] */
+}
+
 #ifdef MAGNUM_TARGET_GL
 {
 PluginManager::Manager<Trade::AbstractImporter> manager;
@@ -695,6 +695,15 @@ foreach(_component ${MagnumPlugins_FIND_COMPONENTS})
                     INTERFACE_LINK_LIBRARIES PNG::PNG)
             endif()
 
+            # PngImageConverter additionally uses zlib directly for the
+            # multithreaded compression. With Emscripten ports it's implied
+            # by USE_LIBPNG.
+            if(_component STREQUAL PngImageConverter AND NOT MAGNUM_USE_EMSCRIPTEN_PORTS_LIBPNG)
+                find_package(ZLIB REQUIRED)
+                set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                    INTERFACE_LINK_LIBRARIES ZLIB::ZLIB)
+            endif()
+
         # PrimitiveImporter has no dependencies
 
         # ResvgImporter plugin dependencies
@@ -749,12 +758,18 @@ foreach(_component ${MagnumPlugins_FIND_COMPONENTS})
         # UfbxImporter has no dependencies
         # TinyGltfImporter has no dependencies
 
-        # WebPImageConverter / WebPImporter plugin dependencies
-        elseif(_component STREQUAL WebPImageConverter OR _component STREQUAL WebPImporter)
+        # WebPImageConverter plugin dependencies
+        elseif(_component STREQUAL WebPImageConverter)
             find_package(WebP REQUIRED)
             set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
                 INTERFACE_LINK_LIBRARIES WebP::WebP)
 
+        # WebPImporter plugin dependencies
+        elseif(_component STREQUAL WebPImporter)
+            find_package(WebP REQUIRED COMPONENTS Demux)
+            set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                INTERFACE_LINK_LIBRARIES WebP::WebP WebP::Demux)
+
         endif()
 
         # Automatic import of static plugins
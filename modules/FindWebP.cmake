@@ -7,9 +7,16 @@
 #  WebP_FOUND           - True if WebP library is found
 #  WebP::WebP           - WebP imported target
 #
+# Additionally, if the Demux component is requested, the following is
+# defined. The demux library is needed for decoding animated files.
+#
+#  WebP_Demux_FOUND     - True if the WebP demux library is found
+#  WebP::Demux          - WebP demux imported target
+#
 # Additionally these variables are defined for internal usage:
 #
 #  WebP_LIBRARY         - WebP library
+#  WebP_DEMUX_LIBRARY   - WebP demux library
 #  WebP_INCLUDE_DIR     - Include dir
 #
 
@@ -49,12 +56,15 @@ endif()
 # Unfortunately the CMake project itself doesn't provide namespaced ALIAS
 # targets so we have to do this insane branching here.
 set(_WEBP_TARGET )
+set(_WEBP_DEMUX_TARGET )
 set(_WEBP_SUBPROJECT )
 if(TARGET webp)
     set(_WEBP_TARGET webp)
+    set(_WEBP_DEMUX_TARGET webpdemux)
     set(_WEBP_SUBPROJECT ON)
 elseif(TARGET WebP::webp)
     set(_WEBP_TARGET WebP::webp)
+    set(_WEBP_DEMUX_TARGET WebP::webpdemux)
 endif()
 if(_WEBP_TARGET)
     # The webp target doesn't define any usable INTERFACE_INCLUDE_DIRECTORIES
@@ -86,10 +96,22 @@ if(_WEBP_TARGET)
             INTERFACE_LINK_LIBRARIES ${_WEBP_TARGET})
     endif()
 
+    # The demux library is a separate target in both the subproject and the
+    # config file case
+    if("Demux" IN_LIST WebP_FIND_COMPONENTS AND TARGET ${_WEBP_DEMUX_TARGET})
+        set(WebP_Demux_FOUND TRUE)
+        if(NOT TARGET WebP::Demux)
+            add_library(WebP::Demux INTERFACE IMPORTED)
+            set_target_properties(WebP::Demux PROPERTIES
+                INTERFACE_LINK_LIBRARIES "WebP::WebP;${_WEBP_DEMUX_TARGET}")
+        endif()
+    endif()
+
     # Just to make FPHSA print some meaningful location, nothing else
     include(FindPackageHandleStandardArgs)
-    find_package_handle_standard_args(WebP DEFAULT_MSG
-        _WEBP_INTERFACE_INCLUDE_DIRECTORIES)
+    find_package_handle_standard_args(WebP
+        REQUIRED_VARS _WEBP_INTERFACE_INCLUDE_DIRECTORIES
+        HANDLE_COMPONENTS)
     return()
 endif()
 
@@ -103,10 +125,19 @@ find_library(WebP_LIBRARY NAMES webp
 find_path(WebP_INCLUDE_DIR
     NAMES webp/decode.h)
 
+# Demux library, if requested
+if("Demux" IN_LIST WebP_FIND_COMPONENTS)
+    find_library(WebP_DEMUX_LIBRARY NAMES webpdemux libwebpdemux)
+    if(WebP_DEMUX_LIBRARY)
+        set(WebP_Demux_FOUND TRUE)
+    endif()
+    mark_as_advanced(FORCE WebP_DEMUX_LIBRARY)
+endif()
+
 include(FindPackageHandleStandardArgs)
-find_package_handle_standard_args(WebP DEFAULT_MSG
-    WebP_LIBRARY
-    WebP_INCLUDE_DIR)
+find_package_handle_standard_args(WebP
+    REQUIRED_VARS WebP_LIBRARY WebP_INCLUDE_DIR
+    HANDLE_COMPONENTS)
 
 mark_as_advanced(FORCE
     WebP_INCLUDE_DIR
@@ -118,3 +149,10 @@ if(NOT TARGET WebP::WebP)
         IMPORTED_LOCATION ${WebP_LIBRARY}
         INTERFACE_INCLUDE_DIRECTORIES ${WebP_INCLUDE_DIR})
 endif()
+
+if(WebP_Demux_FOUND AND NOT TARGET WebP::Demux)
+    add_library(WebP::Demux UNKNOWN IMPORTED)
+    set_target_properties(WebP::Demux PROPERTIES
+        IMPORTED_LOCATION ${WebP_DEMUX_LIBRARY}
+        INTERFACE_LINK_LIBRARIES WebP::WebP)
+endif()
@@ -0,0 +1,68 @@
+#ifndef Magnum_Implementation_mapFile_h
+#define Magnum_Implementation_mapFile_h
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringView.h>
+#include <Corrade/Utility/Move.h>
+#include <Corrade/Utility/Path.h>
+
+/* Common code for importers that memory-map files opened with openFile()
+   instead of reading them into memory. Header-only for the same reason as
+   threadsAndCache.h. */
+#if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+namespace Magnum { namespace Implementation { namespace {
+
+/* Maps given file and passes it to open(). Files that don't exist or are
+   empty can't be mapped, fallback() is called for those instead, which is
+   expected to delegate to the base AbstractImporter::doOpenFile()
+   implementation so there's just the usual error message. If the size
+   can't be queried or the mapping fails, the Path functions already printed
+   a message and there's no point in trying to read the file again, so
+   neither is called. */
+template<class Fallback, class Open> void openMappedFile(const Containers::StringView filename, const Fallback& fallback, const Open& open) {
+    if(!Utility::Path::exists(filename))
+        return fallback();
+    const Containers::Optional<std::size_t> size = Utility::Path::size(filename);
+    if(!size)
+        return;
+    if(!*size)
+        return fallback();
+
+    Containers::Optional<Containers::Array<const char, Utility::Path::MapDeleter>> mapped = Utility::Path::mapRead(filename);
+    if(!mapped)
+        return;
+
+    open(*Utility::move(mapped));
+}
+
+}}}
+#endif
+
+#endif
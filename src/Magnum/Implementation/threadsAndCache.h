@@ -0,0 +1,151 @@
+#ifndef Magnum_Implementation_threadsAndCache_h
+#define Magnum_Implementation_threadsAndCache_h
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <thread>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+
+/* Common code used by plugins that distribute work among multiple threads or
+   keep a cache of previously produced data. Header-only so the plugins don't
+   need to link to anything extra. See the cmake-plugins-threads section in
+   doc/cmake-plugins.dox for why the plugins themselves can't link to
+   pthread. */
+namespace Magnum { namespace Implementation { namespace {
+
+/* Thread count for given value of a threads configuration option, with 0
+   meaning all hardware threads. The standard allows hardware_concurrency() to
+   return 0 if the value can't be determined, fall back to a single thread in
+   that case. */
+inline UnsignedInt threadCount(const UnsignedInt threads) {
+    return threads ? threads : Math::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/* Runs the worker in given count of threads, with the calling thread being
+   one of them. The worker is expected to pick the work to do on its own,
+   which allows it to set up per-thread state first. */
+template<class Worker> void runInThreads(const std::size_t threadCount, const Worker& worker) {
+    if(threadCount <= 1) {
+        worker();
+        return;
+    }
+
+    Containers::Array<std::thread> threads{ValueInit, threadCount - 1};
+    for(std::thread& thread: threads)
+        thread = std::thread{worker};
+    worker();
+    for(std::thread& thread: threads)
+        thread.join();
+}
+
+/* Calls job(i) for every i in [0, jobCount) in at most given count of
+   threads, with the calling thread being one of them. Each thread picks the
+   next unprocessed job until there's none left, so it doesn't matter if some
+   jobs take longer than others. */
+template<class Job> void parallelFor(const std::size_t threadCount, const std::size_t jobCount, const Job& job) {
+    std::atomic<std::size_t> nextJob{0};
+    runInThreads(Math::min(threadCount, jobCount), [&]() {
+        for(std::size_t i; (i = nextJob++) < jobCount; )
+            job(i);
+    });
+}
+
+/* Removes least recently used entries until their total size fits into the
+   budget. The entries are expected to have a lastUsed counter and a data
+   array. Order of the entries doesn't matter, so a removed entry is replaced
+   with the last one. */
+template<class T> void shrinkCache(Containers::Array<T>& cache, const std::size_t budget) {
+    for(;;) {
+        std::size_t size = 0;
+        std::size_t leastRecentlyUsed = ~std::size_t{};
+        for(std::size_t i = 0; i != cache.size(); ++i) {
+            size += cache[i].data.size();
+            if(leastRecentlyUsed == ~std::size_t{} || cache[i].lastUsed < cache[leastRecentlyUsed].lastUsed)
+                leastRecentlyUsed = i;
+        }
+
+        if(size <= budget)
+            return;
+        if(leastRecentlyUsed != cache.size() - 1)
+            cache[leastRecentlyUsed] = Utility::move(cache.back());
+        arrayRemoveSuffix(cache, 1);
+    }
+}
+
+/* An image rasterized at given scaling, in whatever format the rasterizer
+   produces */
+struct CachedImage {
+    Float scaling;
+    UnsignedLong lastUsed;
+    Containers::Array<char> data;
+};
+
+/* Rasterized images kept for repeated imports by the SVG importers */
+struct ImageCache {
+    Containers::Array<CachedImage> images;
+    UnsignedLong useCounter{};
+};
+
+/* If an image rasterized at given scaling is in the cache, returns a copy of
+   it. Otherwise calls render() and if the result fits into the budget, puts a
+   copy of it into the cache. Then drops least recently used images that no
+   longer fit, which is done also on a cache hit as the budget may have been
+   made smaller. */
+template<class Render> Containers::Array<char> renderCached(ImageCache& cache, const Float scaling, const std::size_t budget, const Render& render) {
+    Containers::Array<char> data;
+    std::size_t cached = ~std::size_t{};
+    for(std::size_t i = 0; i != cache.images.size(); ++i) {
+        if(cache.images[i].scaling == scaling) {
+            cached = i;
+            break;
+        }
+    }
+
+    if(cached != ~std::size_t{}) {
+        CachedImage& image = cache.images[cached];
+        data = Containers::Array<char>{NoInit, image.data.size()};
+        Utility::copy(image.data, data);
+        image.lastUsed = ++cache.useCounter;
+    } else {
+        data = render();
+        if(data.size() <= budget) {
+            Containers::Array<char> copy{NoInit, data.size()};
+            Utility::copy(data, copy);
+            arrayAppend(cache.images, InPlaceInit, scaling, ++cache.useCounter, Utility::move(copy));
+        }
+    }
+
+    shrinkCache(cache.images, budget);
+    return data;
+}
+
+}}}
+
+#endif
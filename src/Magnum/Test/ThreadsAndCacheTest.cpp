@@ -0,0 +1,201 @@
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/TestSuite/Tester.h>
+
+#include "Magnum/Magnum.h"
+#include "Magnum/Implementation/threadsAndCache.h"
+
+namespace Magnum { namespace Test { namespace {
+
+struct ThreadsAndCacheTest: TestSuite::Tester {
+    explicit ThreadsAndCacheTest();
+
+    void threadCount();
+
+    void runInThreads();
+    void parallelFor();
+    void parallelForNoJobs();
+
+    void shrinkCache();
+    void renderCached();
+};
+
+const struct {
+    const char* name;
+    std::size_t threadCount, jobCount;
+} ParallelForData[]{
+    {"single thread", 1, 17},
+    {"zero threads", 0, 17},
+    {"four threads", 4, 17},
+    {"more threads than jobs", 32, 3},
+};
+
+ThreadsAndCacheTest::ThreadsAndCacheTest() {
+    addTests({&ThreadsAndCacheTest::threadCount,
+
+              &ThreadsAndCacheTest::runInThreads});
+
+    addInstancedTests({&ThreadsAndCacheTest::parallelFor},
+        Containers::arraySize(ParallelForData));
+
+    addTests({&ThreadsAndCacheTest::parallelForNoJobs,
+
+              &ThreadsAndCacheTest::shrinkCache,
+              &ThreadsAndCacheTest::renderCached});
+}
+
+void ThreadsAndCacheTest::threadCount() {
+    CORRADE_COMPARE(Implementation::threadCount(1), 1);
+    CORRADE_COMPARE(Implementation::threadCount(7), 7);
+    /* Can't really test the case where hardware_concurrency() returns 0 */
+    CORRADE_COMPARE(Implementation::threadCount(0), Math::max(std::thread::hardware_concurrency(), 1u));
+}
+
+void ThreadsAndCacheTest::runInThreads() {
+    /* The worker should be called exactly once in each thread */
+    std::atomic<std::size_t> calls{0};
+    Implementation::runInThreads(5, [&]() { ++calls; });
+    CORRADE_COMPARE(std::size_t(calls), 5);
+
+    calls = 0;
+    Implementation::runInThreads(1, [&]() { ++calls; });
+    CORRADE_COMPARE(std::size_t(calls), 1);
+
+    /* Zero is treated the same as one */
+    calls = 0;
+    Implementation::runInThreads(0, [&]() { ++calls; });
+    CORRADE_COMPARE(std::size_t(calls), 1);
+}
+
+void ThreadsAndCacheTest::parallelFor() {
+    auto&& data = ParallelForData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Each job should be done exactly once */
+    Containers::Array<std::atomic<int>> jobs{ValueInit, data.jobCount};
+    Implementation::parallelFor(data.threadCount, data.jobCount, [&](const std::size_t i) {
+        ++jobs[i];
+    });
+    for(std::size_t i = 0; i != jobs.size(); ++i) {
+        CORRADE_ITERATION(i);
+        CORRADE_COMPARE(int(jobs[i]), 1);
+    }
+}
+
+void ThreadsAndCacheTest::parallelForNoJobs() {
+    bool called = false;
+    Implementation::parallelFor(4, 0, [&](std::size_t) {
+        called = true;
+    });
+    CORRADE_VERIFY(!called);
+}
+
+void ThreadsAndCacheTest::shrinkCache() {
+    struct Entry {
+        int id;
+        UnsignedLong lastUsed;
+        Containers::Array<char> data;
+    };
+
+    Containers::Array<Entry> cache;
+    arrayAppend(cache, InPlaceInit, 0, UnsignedLong{3}, Containers::Array<char>{ValueInit, 10});
+    arrayAppend(cache, InPlaceInit, 1, UnsignedLong{1}, Containers::Array<char>{ValueInit, 20});
+    arrayAppend(cache, InPlaceInit, 2, UnsignedLong{4}, Containers::Array<char>{ValueInit, 30});
+    arrayAppend(cache, InPlaceInit, 3, UnsignedLong{2}, Containers::Array<char>{ValueInit, 5});
+
+    /* Fits, nothing is removed */
+    Implementation::shrinkCache(cache, 65);
+    CORRADE_COMPARE(cache.size(), 4);
+
+    /* Removes the least recently used entry, which gets replaced with the last
+       one */
+    Implementation::shrinkCache(cache, 64);
+    CORRADE_COMPARE(cache.size(), 3);
+    CORRADE_COMPARE(cache[0].id, 0);
+    CORRADE_COMPARE(cache[1].id, 3);
+    CORRADE_COMPARE(cache[2].id, 2);
+
+    /* Removes as many as needed */
+    Implementation::shrinkCache(cache, 30);
+    CORRADE_COMPARE(cache.size(), 1);
+    CORRADE_COMPARE(cache[0].id, 2);
+
+    /* A zero budget removes everything */
+    Implementation::shrinkCache(cache, 0);
+    CORRADE_COMPARE(cache.size(), 0);
+}
+
+void ThreadsAndCacheTest::renderCached() {
+    Implementation::ImageCache cache;
+    int renders = 0;
+    auto render = [&](char value) {
+        return [&renders, value]() {
+            ++renders;
+            return Containers::Array<char>{DirectInit, 10, value};
+        };
+    };
+
+    /* First render gets cached */
+    Containers::Array<char> a = Implementation::renderCached(cache, 1.0f, 25, render('a'));
+    CORRADE_COMPARE(renders, 1);
+    CORRADE_COMPARE(a.size(), 10);
+    CORRADE_COMPARE(a[9], 'a');
+    CORRADE_COMPARE(cache.images.size(), 1);
+
+    /* Same scaling is taken from the cache, returning a copy that doesn't
+       alias the cached data */
+    Containers::Array<char> aCached = Implementation::renderCached(cache, 1.0f, 25, render('x'));
+    CORRADE_COMPARE(renders, 1);
+    CORRADE_COMPARE(aCached[9], 'a');
+    CORRADE_VERIFY(aCached.data() != cache.images[0].data.data());
+
+    /* Different scalings get rendered again. The third one no longer fits so
+       the least recently used one, i.e. not the 1.0f that was just used,
+       gets dropped. */
+    Implementation::renderCached(cache, 2.0f, 25, render('b'));
+    Implementation::renderCached(cache, 1.0f, 25, render('x'));
+    Containers::Array<char> c = Implementation::renderCached(cache, 3.0f, 25, render('c'));
+    CORRADE_COMPARE(renders, 3);
+    CORRADE_COMPARE(c[9], 'c');
+    CORRADE_COMPARE(cache.images.size(), 2);
+    Containers::Array<char> aCachedAgain = Implementation::renderCached(cache, 1.0f, 25, render('x'));
+    CORRADE_COMPARE(renders, 3);
+    CORRADE_COMPARE(aCachedAgain[9], 'a');
+
+    /* A result larger than the budget is returned but not cached */
+    Containers::Array<char> d = Implementation::renderCached(cache, 4.0f, 5, render('d'));
+    CORRADE_COMPARE(renders, 4);
+    CORRADE_COMPARE(d[9], 'd');
+
+    /* The smaller budget passed above dropped everything else as well */
+    CORRADE_COMPARE(cache.images.size(), 0);
+}
+
+}}}
+
+CORRADE_TEST_MAIN(Magnum::Test::ThreadsAndCacheTest)
@@ -31,9 +31,13 @@
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/Path.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/mapFile.h"
+
 namespace Magnum { namespace Trade {
 
 using namespace Containers::Literals;
@@ -73,9 +77,20 @@ struct AstcImporter::State {
        a 3D format. */
     bool is3D;
     ImageFlags3D flags;
+    /* Needed for calculating size of a block slice in partial imports */
+    Vector3i blockSize;
     /* Needed because the data might be longer */
     std::size_t dataSize;
+    /* Owned or externally owned file data if opened with openData() or
+       openMemory() */
     Containers::Array<char> data;
+    /* Used instead of the above if the file was opened with openFile(). Only
+       the pages that get imported are then loaded by the OS. */
+    #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+    Containers::Array<const char, Utility::Path::MapDeleter> mappedData;
+    #endif
+    /* Points to one of the above, including the header */
+    Containers::ArrayView<const char> in;
 };
 
 AstcImporter::AstcImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin) : AbstractImporter{manager, plugin} {}
@@ -88,7 +103,38 @@ bool AstcImporter::doIsOpened() const { return !!_state; }
 
 void AstcImporter::doClose() { _state = nullptr; }
 
+#if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+void AstcImporter::doOpenFile(const Containers::StringView filename) {
+    /* Instead of reading the whole file into memory, map it, so only the
+       parts that get imported are loaded by the OS */
+    Implementation::openMappedFile(filename, [&]() {
+        AbstractImporter::doOpenFile(filename);
+    }, [&](Containers::Array<const char, Utility::Path::MapDeleter>&& mapped) {
+        Containers::Pointer<State> state{InPlaceInit};
+        state->mappedData = Utility::move(mapped);
+        state->in = state->mappedData;
+        openInternal(Utility::move(state));
+    });
+}
+#endif
+
 void AstcImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dataFlags) {
+    /* Take over the existing array or copy the data if we can't. For
+       simplicity we copy it including the tiny header so we don't need to have
+       different handling based on whether the data was taken over or copied
+       later. */
+    Containers::Pointer<State> state{InPlaceInit};
+    if(dataFlags & (DataFlag::Owned|DataFlag::ExternallyOwned))
+        state->data = Utility::move(data);
+    else
+        state->data = Containers::Array<char>{InPlaceInit, data};
+    state->in = state->data;
+    openInternal(Utility::move(state));
+}
+
+void AstcImporter::openInternal(Containers::Pointer<State>&& state) {
+    const Containers::ArrayView<const char> data = state->in;
+
     /* Unlike with e.g. TgaImporter, where doOpenData() only takes over the
        data array, here we need to parse the format to decide whether it's a
        2D or a 3D image. And while at it, why not do also all other checks. */
@@ -183,11 +229,10 @@ void AstcImporter::doOpenData(Containers::Array<char>&& data, const DataFlags da
     }
 
     /* All good now, let's save everything */
-    _state.emplace();
-    _state->format = format;
-    _state->size = size;
+    state->format = format;
+    state->size = size;
     /* An image is 3D if ... */
-    _state->is3D =
+    state->is3D =
         /* it has a 3D block, */
         header.blockSize.z() != 1 ||
         /* it has Z size larger than 1, */
@@ -197,18 +242,11 @@ void AstcImporter::doOpenData(Containers::Array<char>&& data, const DataFlags da
            2D image. */
         (!size.z() && size.xy().product());
     /* Mark the image as 2D array if it's 3D but has a 2D format */
-    if(_state->is3D && header.blockSize.z() == 1)
-        _state->flags |= ImageFlag3D::Array;
-    _state->dataSize = dataSize;
-
-    /* Take over the existing array or copy the data if we can't. For
-       simplicity we copy it including the tiny header so we don't need to have
-       different handling based on whether the data was taken over or copied
-       later. */
-    if(dataFlags & (DataFlag::Owned|DataFlag::ExternallyOwned))
-        _state->data = Utility::move(data);
-    else
-        _state->data = Containers::Array<char>{InPlaceInit, data};
+    if(state->is3D && header.blockSize.z() == 1)
+        state->flags |= ImageFlag3D::Array;
+    state->blockSize = Vector3i{header.blockSize};
+    state->dataSize = dataSize;
+    _state = Utility::move(state);
 }
 
 UnsignedInt AstcImporter::doImage2DCount() const {
@@ -216,7 +254,14 @@ UnsignedInt AstcImporter::doImage2DCount() const {
 }
 
 Containers::Optional<ImageData2D> AstcImporter::doImage2D(UnsignedInt, UnsignedInt) {
-    Containers::Array<char> data{InPlaceInit, _state->data.sliceSize(sizeof(AstcHeader), _state->dataSize)};
+    const Containers::ArrayView<const char> in = _state->in.sliceSize(sizeof(AstcHeader), _state->dataSize);
+
+    /* Reference the file data directly if requested. The ASTC payload is
+       never processed in any way, so this is always possible. */
+    if(configuration().value<bool>("zeroCopy"))
+        return ImageData2D{_state->format, _state->size.xy(), DataFlags{}, in, ImageFlag2D(UnsignedShort(_state->flags))};
+
+    Containers::Array<char> data{InPlaceInit, in};
     return ImageData2D{_state->format, _state->size.xy(), Utility::move(data), ImageFlag2D(UnsignedShort(_state->flags))};
 }
 
@@ -225,8 +270,36 @@ UnsignedInt AstcImporter::doImage3DCount() const {
 }
 
 Containers::Optional<ImageData3D> AstcImporter::doImage3D(UnsignedInt, UnsignedInt) {
-    Containers::Array<char> data{InPlaceInit, _state->data.sliceSize(sizeof(AstcHeader), _state->dataSize)};
-    return ImageData3D{_state->format, _state->size, Utility::move(data), _state->flags};
+    /* Blocks are stored in X, then Y, then Z order, so a range of block
+       slices along Z is a contiguous range of the data */
+    const Int blockSliceCount = (_state->size.z() + _state->blockSize.z() - 1)/_state->blockSize.z();
+    const std::size_t blockSliceSize = AstcBlockDataSize*((_state->size.xy() + _state->blockSize.xy() - Vector2i{1})/_state->blockSize.xy()).product();
+    const Int sliceOffset = configuration().value<Int>("sliceOffset");
+    const Int sliceCount = configuration().value<Int>("sliceCount");
+    if(sliceOffset < 0 || (sliceOffset && sliceOffset >= blockSliceCount)) {
+        Error{} << "Trade::AstcImporter::image3D(): slice offset" << sliceOffset << "out of range for" << blockSliceCount << "block slices";
+        return {};
+    }
+    if(sliceCount < 0) {
+        Error{} << "Trade::AstcImporter::image3D(): expected non-negative slice count but got" << sliceCount;
+        return {};
+    }
+
+    /* If the count is zero or goes past the end, import everything till the
+       end. The last block slice may be incomplete, in which case the image
+       size is clamped accordingly. */
+    const Int importedSliceCount = sliceCount && sliceOffset + sliceCount < blockSliceCount ?
+        sliceCount : blockSliceCount - sliceOffset;
+    const Vector3i size{_state->size.xy(), Math::min(importedSliceCount*_state->blockSize.z(), _state->size.z() - sliceOffset*_state->blockSize.z())};
+    const Containers::ArrayView<const char> in = _state->in.sliceSize(sizeof(AstcHeader) + sliceOffset*blockSliceSize, importedSliceCount*blockSliceSize);
+
+    /* Reference the file data directly if requested. The ASTC payload is
+       never processed in any way, so this is always possible. */
+    if(configuration().value<bool>("zeroCopy"))
+        return ImageData3D{_state->format, size, DataFlags{}, in, _state->flags};
+
+    Containers::Array<char> data{InPlaceInit, in};
+    return ImageData3D{_state->format, size, Utility::move(data), _state->flags};
 }
 
 }}
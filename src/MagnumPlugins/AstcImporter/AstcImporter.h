@@ -137,6 +137,32 @@ option enforces use of a 3D ASTC format), but other tools might.
 The plugin recognizes @ref ImporterFlag::Quiet, which will cause all import
 warnings to be suppressed.
 
+@subsection Trade-AstcImporter-behavior-partial Partial import of 3D images
+
+When a file is opened with @ref openFile(), it's memory-mapped instead of being
+read into memory, so only the parts that actually get imported are loaded by
+the OS. Memory mapping isn't available on
+@ref CORRADE_TARGET_EMSCRIPTEN "Emscripten" and
+@ref CORRADE_TARGET_WINDOWS_RT "Windows RT", where the whole file is read
+into memory instead.
+
+Memory mapping is useful especially for large volumes, a subset of which can be
+imported by setting the @cb{.ini} sliceOffset @ce and @cb{.ini} sliceCount @ce
+@ref Trade-AstcImporter-configuration "configuration options". These are in
+units of block slices, i.e. rows of blocks along Z. For a 3D ASTC format with a
+block depth of @f$ d @f$ a single block slice is @f$ d @f$ pixels deep, for a
+2D array image it's a single layer. The imported image then has the Z size
+adjusted to the imported slice range, and if the last imported block slice is
+incomplete, it's clamped to the actual image size. The options affect only
+@ref image3D(), 2D images are always imported whole.
+
+Additionally, if the @cb{.ini} zeroCopy @ce option is enabled, the image data
+aren't copied at all and the returned @ref ImageData references the opened
+file directly, with empty @ref ImageData::dataFlags(). Such views are valid
+only until the importer is closed or another file is opened. For
+@ref openData() the input is copied to the importer first, for
+@ref openMemory() it's referenced as-is.
+
 @section Trade-AstcImporter-configuration Plugin-specific configuration
 
 It's possible to tune various import options through @ref configuration(). See
@@ -159,6 +185,11 @@ class MAGNUM_ASTCIMPORTER_EXPORT AstcImporter: public AbstractImporter {
         MAGNUM_ASTCIMPORTER_LOCAL bool doIsOpened() const override;
         MAGNUM_ASTCIMPORTER_LOCAL void doClose() override;
         MAGNUM_ASTCIMPORTER_LOCAL void doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) override;
+        /* Memory mapping isn't available on Emscripten and WinRT, the base
+           implementation that reads the file is used there instead */
+        #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+        MAGNUM_ASTCIMPORTER_LOCAL void doOpenFile(Containers::StringView filename) override;
+        #endif
 
         MAGNUM_ASTCIMPORTER_LOCAL UnsignedInt doImage2DCount() const override;
         MAGNUM_ASTCIMPORTER_LOCAL Containers::Optional<ImageData2D> doImage2D(UnsignedInt id, UnsignedInt level) override;
@@ -167,6 +198,7 @@ class MAGNUM_ASTCIMPORTER_EXPORT AstcImporter: public AbstractImporter {
         MAGNUM_ASTCIMPORTER_LOCAL Containers::Optional<ImageData3D> doImage3D(UnsignedInt id, UnsignedInt level) override;
 
         struct State;
+        MAGNUM_ASTCIMPORTER_LOCAL void openInternal(Containers::Pointer<State>&& state);
         Containers::Pointer<State> _state;
 };
 
@@ -63,6 +63,12 @@ struct AstcImporterTest: TestSuite::Tester {
     void fileTooLong2D();
     void fileTooLong3D();
 
+    void slices();
+    void slicesArray();
+    void slicesInvalid();
+    void zeroCopy();
+    void zeroCopyOpenMemory();
+
     void openMemory();
     void openTwice();
     void importTwice();
@@ -152,6 +158,51 @@ const struct {
     {"quiet", ImporterFlag::Quiet, true}
 };
 
+/* 3x3x3 blocks, 4x3x7 pixels, so 2x1x3 blocks with the last block slice being
+   incomplete. Each block slice is filled with a different letter. */
+constexpr Containers::StringView SliceFileData =
+    "\x13\xAB\xA1\x5C" "\x3\x3\x3" "\x4\0\0" "\x3\0\0" "\x7\0\0"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"
+    "cccccccccccccccccccccccccccccccc"_s;
+
+const struct {
+    const char* name;
+    Int sliceOffset, sliceCount;
+    Int expectedDepth;
+    Containers::StringView expectedData;
+} SliceData[]{
+    {"everything", 0, 0, 7,
+        "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+        "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"
+        "cccccccccccccccccccccccccccccccc"_s},
+    {"first slice", 0, 1, 3,
+        "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"_s},
+    {"middle slice", 1, 1, 3,
+        "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"_s},
+    {"last incomplete slice", 2, 1, 1,
+        "cccccccccccccccccccccccccccccccc"_s},
+    {"till the end", 1, 0, 4,
+        "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"
+        "cccccccccccccccccccccccccccccccc"_s},
+    {"count past the end", 1, 5, 4,
+        "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"
+        "cccccccccccccccccccccccccccccccc"_s},
+};
+
+const struct {
+    const char* name;
+    Int sliceOffset, sliceCount;
+    const char* message;
+} SliceInvalidData[]{
+    {"offset out of range", 3, 0,
+        "slice offset 3 out of range for 3 block slices"},
+    {"negative offset", -1, 1,
+        "slice offset -1 out of range for 3 block slices"},
+    {"negative count", 1, -2,
+        "expected non-negative slice count but got -2"},
+};
+
 /* Shared among all plugins that implement data copying optimizations */
 const struct {
     const char* name;
@@ -194,6 +245,17 @@ AstcImporterTest::AstcImporterTest() {
         &AstcImporterTest::fileTooLong3D},
         Containers::arraySize(QuietData));
 
+    addInstancedTests({&AstcImporterTest::slices},
+        Containers::arraySize(SliceData));
+
+    addTests({&AstcImporterTest::slicesArray});
+
+    addInstancedTests({&AstcImporterTest::slicesInvalid},
+        Containers::arraySize(SliceInvalidData));
+
+    addTests({&AstcImporterTest::zeroCopy,
+              &AstcImporterTest::zeroCopyOpenMemory});
+
     addInstancedTests({&AstcImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
@@ -539,6 +601,99 @@ void AstcImporterTest::fileTooLong3D() {
     }), TestSuite::Compare::Container);
 }
 
+void AstcImporterTest::slices() {
+    auto&& data = SliceData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("AstcImporter");
+    importer->addFlags(ImporterFlag::Quiet);
+    importer->configuration().setValue("sliceOffset", data.sliceOffset);
+    importer->configuration().setValue("sliceCount", data.sliceCount);
+    CORRADE_VERIFY(importer->openData(SliceFileData));
+    CORRADE_COMPARE(importer->image3DCount(), 1);
+
+    Containers::Optional<ImageData3D> image = importer->image3D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->flags(), ImageFlags3D{});
+    CORRADE_COMPARE(image->compressedFormat(), CompressedPixelFormat::Astc3x3x3RGBAUnorm);
+    CORRADE_COMPARE(image->size(), (Vector3i{4, 3, data.expectedDepth}));
+    CORRADE_COMPARE(image->dataFlags(), DataFlag::Owned|DataFlag::Mutable);
+    CORRADE_COMPARE(Containers::StringView{image->data()}, data.expectedData);
+}
+
+void AstcImporterTest::slicesArray() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("AstcImporter");
+    importer->addFlags(ImporterFlag::Quiet);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(ASTCIMPORTER_TEST_DIR, "12x12-array-incomplete-blocks.astc")));
+
+    Containers::Optional<ImageData3D> full = importer->image3D(0);
+    CORRADE_VERIFY(full);
+
+    /* For a 2D array image a block slice is a single layer */
+    importer->configuration().setValue("sliceOffset", 1);
+    Containers::Optional<ImageData3D> image = importer->image3D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->flags(), ImageFlag3D::Array);
+    CORRADE_COMPARE(image->compressedFormat(), CompressedPixelFormat::Astc12x12RGBAUnorm);
+    CORRADE_COMPARE(image->size(), (Vector3i{27, 27, 1}));
+    CORRADE_COMPARE_AS(image->data(),
+        full->data().exceptPrefix(3*3*128/8),
+        TestSuite::Compare::Container);
+}
+
+void AstcImporterTest::slicesInvalid() {
+    auto&& data = SliceInvalidData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("AstcImporter");
+    importer->addFlags(ImporterFlag::Quiet);
+    importer->configuration().setValue("sliceOffset", data.sliceOffset);
+    importer->configuration().setValue("sliceCount", data.sliceCount);
+    CORRADE_VERIFY(importer->openData(SliceFileData));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image3D(0));
+    CORRADE_COMPARE(out, Utility::format("Trade::AstcImporter::image3D(): {}\n", data.message));
+}
+
+void AstcImporterTest::zeroCopy() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("AstcImporter");
+    importer->addFlags(ImporterFlag::Quiet);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(ASTCIMPORTER_TEST_DIR, "3x3x3.astc")));
+
+    Containers::Optional<ImageData3D> copied = importer->image3D(0);
+    CORRADE_VERIFY(copied);
+
+    importer->configuration().setValue("zeroCopy", true);
+    Containers::Optional<ImageData3D> image = importer->image3D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->dataFlags(), DataFlags{});
+    CORRADE_COMPARE(image->compressedFormat(), CompressedPixelFormat::Astc3x3x3RGBAUnorm);
+    CORRADE_COMPARE(image->size(), (Vector3i{27, 27, 3}));
+    CORRADE_COMPARE_AS(image->data(),
+        copied->data(),
+        TestSuite::Compare::Container);
+}
+
+void AstcImporterTest::zeroCopyOpenMemory() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("AstcImporter");
+    importer->addFlags(ImporterFlag::Quiet);
+    importer->configuration().setValue("zeroCopy", true);
+
+    Containers::Optional<Containers::Array<char>> memory = Utility::Path::read(Utility::Path::join(ASTCIMPORTER_TEST_DIR, "8x8.astc"));
+    CORRADE_VERIFY(memory);
+    CORRADE_VERIFY(importer->openMemory(*memory));
+
+    /* The 2D image should point right after the 16-byte header */
+    Containers::Optional<ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->dataFlags(), DataFlags{});
+    CORRADE_COMPARE(image->size(), (Vector2i{64, 32}));
+    CORRADE_COMPARE(image->data().data(), memory->data() + 16);
+    CORRADE_COMPARE(image->data().size(), 8*4*128/8);
+}
+
 void AstcImporterTest::openMemory() {
     /* same as (a subset of) twoDimensions() except that it uses openData() &
        openMemory() instead of openFile() to test data copying on import */
@@ -28,11 +28,14 @@
 
 #include "BasisImageConverter.h"
 
-#include <thread>
+#include <condition_variable>
+#include <mutex>
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
@@ -43,6 +46,8 @@
 #include <Magnum/Math/Swizzle.h>
 #include <Magnum/PixelFormat.h>
 
+#include "Magnum/Implementation/threadsAndCache.h"
+
 #include <basisu_enc.h>
 #include <basisu_comp.h>
 #include <basisu_file_headers.h>
@@ -65,6 +70,115 @@ enum class BasisImageConverter::Format: Int {
 
 namespace {
 
+/* Job pools reused among all conversions with shared_job_pool enabled, and
+   the threads and estimated memory of all conversions currently running.
+   Created in initialize(), destroyed in finalize(). */
+struct SharedJobPools {
+    struct IdlePool {
+        UnsignedInt threadCount;
+        Containers::Pointer<basisu::job_pool> pool;
+    };
+
+    std::mutex mutex;
+    std::condition_variable released;
+    /* Pools not used by any conversion right now, kept to avoid the thread
+       creation overhead in subsequent conversions */
+    Containers::Array<IdlePool> idle;
+    UnsignedInt idleThreadCount{};
+    /* Number of conversions currently running and the threads and estimated
+       memory they use */
+    UnsignedInt users{};
+    UnsignedInt threadCount{};
+    std::size_t memory{};
+};
+
+SharedJobPools* sharedJobPools{};
+
+/* Acquires a job pool for the duration of a single conversion, waiting until
+   its threads and estimated memory use fit into the budget. Each running
+   conversion has a pool of its own, as the encoder waits for all jobs queued
+   in the pool at the end of each stage, which would make conversions sharing
+   a pool wait on each other. */
+class SharedJobPoolUse {
+    public:
+        explicit SharedJobPoolUse(const UnsignedInt threadCount, const UnsignedInt threadBudget, const std::size_t memory, const std::size_t memoryBudget): _threadCount{threadCount}, _memory{memory} {
+            {
+                /* Idle pools that have to go to make room for a new one,
+                   destroyed only after the lock is released */
+                Containers::Array<SharedJobPools::IdlePool> evicted;
+
+                std::unique_lock<std::mutex> lock{sharedJobPools->mutex};
+                /* A conversion that doesn't fit into the budget on its own
+                   runs only when no other conversion is running */
+                sharedJobPools->released.wait(lock, [&]() {
+                    return !sharedJobPools->users || (sharedJobPools->threadCount + threadCount <= threadBudget && (!memoryBudget || sharedJobPools->memory + memory <= memoryBudget));
+                });
+
+                _conversionsRunning = ++sharedJobPools->users;
+                _threadsInUse = sharedJobPools->threadCount += threadCount;
+                _memoryInUse = sharedJobPools->memory += memory;
+
+                /* Reuse an idle pool with the same thread count, if there's
+                   any. Order of the idle pools doesn't matter, so a taken one
+                   is replaced with the last. */
+                Containers::ArrayView<SharedJobPools::IdlePool> idle = sharedJobPools->idle;
+                for(std::size_t i = 0; i != idle.size(); ++i) {
+                    if(idle[i].threadCount != threadCount)
+                        continue;
+
+                    _pool = Utility::move(idle[i].pool);
+                    sharedJobPools->idleThreadCount -= threadCount;
+                    if(i != idle.size() - 1)
+                        idle[i] = Utility::move(idle.back());
+                    arrayRemoveSuffix(sharedJobPools->idle, 1);
+                    break;
+                }
+
+                /* Otherwise drop idle pools until a new one fits into the
+                   budget together with the remaining ones */
+                if(!_pool) while(!sharedJobPools->idle.isEmpty() && sharedJobPools->idleThreadCount + sharedJobPools->threadCount > threadBudget) {
+                    sharedJobPools->idleThreadCount -= sharedJobPools->idle.back().threadCount;
+                    arrayAppend(evicted, Utility::move(sharedJobPools->idle.back()));
+                    arrayRemoveSuffix(sharedJobPools->idle, 1);
+                }
+            }
+
+            if(!_pool)
+                _pool.emplace(threadCount);
+        }
+
+        SharedJobPoolUse(const SharedJobPoolUse&) = delete;
+        SharedJobPoolUse& operator=(const SharedJobPoolUse&) = delete;
+
+        ~SharedJobPoolUse() {
+            {
+                std::lock_guard<std::mutex> lock{sharedJobPools->mutex};
+                arrayAppend(sharedJobPools->idle, SharedJobPools::IdlePool{_threadCount, Utility::move(_pool)});
+                sharedJobPools->idleThreadCount += _threadCount;
+                --sharedJobPools->users;
+                sharedJobPools->threadCount -= _threadCount;
+                sharedJobPools->memory -= _memory;
+            }
+            sharedJobPools->released.notify_all();
+        }
+
+        basisu::job_pool& pool() { return *_pool; }
+
+        /* Totals of all running conversions including this one at the time
+           this one started, for verbose output */
+        UnsignedInt conversionsRunning() const { return _conversionsRunning; }
+        UnsignedInt threadsInUse() const { return _threadsInUse; }
+        std::size_t memoryInUse() const { return _memoryInUse; }
+
+    private:
+        Containers::Pointer<basisu::job_pool> _pool;
+        UnsignedInt _threadCount;
+        std::size_t _memory;
+        UnsignedInt _conversionsRunning;
+        UnsignedInt _threadsInUse;
+        std::size_t _memoryInUse;
+};
+
 template<typename T> void copySlice(const ImageView3D& image3D, UnsignedInt slice, Containers::StridedArrayView2D<Math::Color4<T>>& dst, bool yFlip, bool hasCustomSwizzle) {
     const UnsignedInt channelCount = pixelFormatChannelCount(image3D.format());
 
@@ -260,13 +374,15 @@ template<UnsignedInt dimensions> Containers::Optional<Containers::Array<char>> c
     PARAM_CONFIG(resample_height, int);
     PARAM_CONFIG(resample_factor, float);
 
-    UnsignedInt threadCount = configuration.value<Int>("threads");
-    if(threadCount == 0)
-        threadCount = std::thread::hardware_concurrency();
+    /* With shared job pools, a single conversion can't use more threads than
+       is the budget for all of them */
+    const bool sharedJobPool = configuration.value<bool>("shared_job_pool");
+    const UnsignedInt threadBudget = Implementation::threadCount(configuration.value<UnsignedInt>("shared_job_pool_thread_budget"));
+    UnsignedInt threadCount = Implementation::threadCount(configuration.value<UnsignedInt>("threads"));
+    if(sharedJobPool)
+        threadCount = Math::min(threadCount, threadBudget);
     const bool multithreading = threadCount > 1;
     params.m_multithreading = multithreading;
-    basisu::job_pool jpool{threadCount};
-    params.m_pJob_pool = &jpool;
 
     PARAM_CONFIG(disable_hierarchical_endpoint_codebooks, bool);
 
@@ -366,6 +482,40 @@ template<UnsignedInt dimensions> Containers::Optional<Containers::Array<char>> c
     /* One image per slice. The base mip is in m_source_images, mip 1 and
        higher go into m_source_mipmap_images. */
     const UnsignedInt numImages = Vector3i::pad(baseSize, 1).z();
+
+    /* Either take a job pool from the shared ones, or create a new one just
+       for this conversion. A shared pool is acquired before making a copy
+       of the input for Basis, as that's already a significant portion of the
+       memory used. */
+    Containers::Optional<basisu::job_pool> jobPool;
+    Containers::Optional<SharedJobPoolUse> sharedJobPoolUse;
+    if(sharedJobPool) {
+        /* The per-pixel estimate consists of the input copy made below, the
+           encoder-internal copy of each slice, the per-block source pixel
+           data of the same size as the slice copy, and roughly two bytes for
+           the encoded blocks and the output file. */
+        #if BASISU_LIB_VERSION >= 150
+        const std::size_t pixelSize = isHdr ?
+            3*sizeof(basisu::vec4F) + 2 :
+            3*sizeof(basisu::color_rgba) + 2;
+        #else
+        const std::size_t pixelSize = 3*sizeof(basisu::color_rgba) + 2;
+        #endif
+        std::size_t pixelCount = 0;
+        for(const BasicImageView<dimensions>& image: imageLevels)
+            pixelCount += std::size_t(image.size().product());
+        /* If the encoder generates the mip levels itself, they add up to
+           roughly an additional third of the base level */
+        if(imageLevels.size() == 1 && params.m_mip_gen)
+            pixelCount += pixelCount/3;
+        sharedJobPoolUse.emplace(threadCount, threadBudget, pixelCount*pixelSize, std::size_t(configuration.value<Double>("shared_job_pool_memory_budget")*1024.0*1024.0));
+        params.m_pJob_pool = &sharedJobPoolUse->pool();
+        if(flags & ImageConverterFlag::Verbose)
+            Debug{} << "Trade::BasisImageConverter::convertToData(): running with" << threadCount << "threads," << sharedJobPoolUse->threadsInUse() << "threads and" << sharedJobPoolUse->memoryInUse() << "bytes of estimated memory in use by" << sharedJobPoolUse->conversionsRunning() << "conversions";
+    } else {
+        jobPool.emplace(threadCount);
+        params.m_pJob_pool = &*jobPool;
+    }
     #if BASISU_LIB_VERSION >= 150
     if(isHdr) {
         params.m_source_images_hdr.resize(numImages);
@@ -513,9 +663,14 @@ void BasisImageConverter::initialize() {
     #else
     basisu::basisu_encoder_init();
     #endif
+
+    sharedJobPools = new SharedJobPools;
 }
 
 void BasisImageConverter::finalize() {
+    delete sharedJobPools;
+    sharedJobPools = nullptr;
+
     #if BASISU_LIB_VERSION >= 116
     basisu::basisu_encoder_deinit();
     #endif
@@ -239,6 +239,43 @@ load time is populating global safe in a non-thread-safe way. Thus you have to
 ensure that the plugin isn't loaded from multiple threads at the same time, or
 loaded while being already used from another thread.
 
+@subsection Trade-BasisImageConverter-behavior-shared-job-pool Shared job pools and concurrent conversions
+
+By default, each @ref convertToData() call creates a new job pool with the
+amount of threads specified in the @cb{.ini} threads @ce
+@ref Trade-BasisImageConverter-configuration "configuration option" and
+destroys it at the end. When converting many small images, the thread
+creation overhead can become significant, and the images additionally may not
+be large enough to keep all threads busy.
+
+Enabling the @cb{.ini} shared_job_pool @ce option makes all conversions in all
+plugin instances take their job pools from a shared set instead. Each running
+conversion gets a pool of its own, so concurrent conversions don't wait on
+each other, and once it finishes, the pool is kept for reuse by subsequent
+conversions with the same thread count until the plugin is unloaded. Then,
+it's possible to run multiple conversions at once, each from a different
+thread using a dedicated plugin instance.
+
+To bound the total thread count, the @cb{.ini} shared_job_pool_thread_budget @ce
+option specifies the maximum amount of threads used by all running
+conversions together, defaulting to the value returned by
+@ref std::thread::hardware_concurrency(). A conversion that would exceed it
+waits until other conversions finish. A conversion asking for more threads
+than the whole budget is limited to the budget. Idle pools are destroyed as
+needed to keep the total count of threads in both the running and idle pools
+within the budget.
+
+Similarly, to bound the total memory use, the
+@cb{.ini} shared_job_pool_memory_budget @ce option can be set to a limit in
+megabytes. A conversion that would make the estimated memory use of all
+running conversions exceed the limit then waits until other conversions
+finish. The estimate is summed across all levels, including levels generated
+with @cb{.ini} mip_gen @ce, and accounts for the input copy made for the
+encoder, the encoder-internal copy of each slice and its per-block source
+data, plus the encoded output. That's 14 bytes per pixel for LDR and 50 bytes
+per pixel for HDR images. Temporary allocations of particular encoding stages
+aren't included, so the limit should still be set with a margin.
+
 @section Trade-BasisImageConverter-configuration Plugin-specific configuration
 
 Basis compression can be configured to produce better quality or reduce
@@ -26,6 +26,8 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include <cstdio>
+#include <thread>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/StridedArrayView.h>
@@ -91,6 +93,7 @@ struct BasisImageConverterTest: TestSuite::Tester {
     void convertToFile3D();
 
     void threads();
+    void sharedJobPool();
     void ktx();
     void swizzle();
 
@@ -285,6 +288,26 @@ constexpr struct {
     {"all threads", "0"}
 };
 
+constexpr struct {
+    const char* name;
+    const char* threads;
+    const char* threadBudget;
+    Double memoryBudget;
+    UnsignedInt expectedThreadCount;
+    UnsignedInt maxConversions;
+} SharedJobPoolData[]{
+    {"single thread", "1", "4", 0.0, 1, 4},
+    {"2 threads, thread budget for two conversions", "2", "4", 0.0, 2, 2},
+    {"2 threads, thread budget for one conversion", "2", "2", 0.0, 2, 1},
+    {"3 threads, thread budget of 2", "3", "2", 0.0, 2, 1},
+    /* The 63x27 RGBA image is estimated at ~23 kB, so this allows two
+       conversions at a time */
+    {"memory budget for two conversions", "1", "4", 0.05, 1, 2},
+    /* This is less than what a single conversion needs, so each runs only
+       when no other is running */
+    {"memory budget for one conversion", "1", "4", 0.01, 1, 1},
+};
+
 constexpr struct {
     const char* name;
     const bool yFlip;
@@ -360,6 +383,9 @@ BasisImageConverterTest::BasisImageConverterTest() {
     addInstancedTests({&BasisImageConverterTest::threads},
         Containers::arraySize(ThreadsData));
 
+    addInstancedTests({&BasisImageConverterTest::sharedJobPool},
+        Containers::arraySize(SharedJobPoolData));
+
     addInstancedTests({&BasisImageConverterTest::ktx},
         Containers::arraySize(FlippedData));
 
@@ -1470,6 +1496,96 @@ void BasisImageConverterTest::threads() {
         (DebugTools::CompareImageToFile{_manager, 97.25f, 7.914f}));
 }
 
+void BasisImageConverterTest::sharedJobPool() {
+    auto&& data = SharedJobPoolData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    #ifndef CORRADE_BUILD_MULTITHREADED
+    CORRADE_SKIP("CORRADE_BUILD_MULTITHREADED is not enabled, can't capture verbose output from multiple threads");
+    #endif
+
+    if(_manager.loadState("PngImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("PngImporter plugin not found, cannot test contents");
+
+    Containers::Pointer<AbstractImporter> pngImporter = _manager.instantiate("PngImporter");
+    CORRADE_VERIFY(pngImporter->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-63x27.png")));
+    Containers::Optional<Trade::ImageData2D> originalImage = pngImporter->image2D(0);
+    CORRADE_VERIFY(originalImage);
+
+    /* Run several conversions at once, each from its own thread with its own
+       plugin instance. Plugin instantiation isn't thread-safe so do that
+       upfront. The verbose output reports the threads and memory used by
+       all conversions running at the time a particular one started. */
+    Containers::Pointer<AbstractImageConverter> converters[4];
+    Containers::Optional<Containers::Array<char>> outputs[Containers::arraySize(converters)];
+    Containers::String outs[Containers::arraySize(converters)];
+    for(Containers::Pointer<AbstractImageConverter>& converter: converters) {
+        converter = _converterManager.instantiate("BasisImageConverter");
+        converter->addFlags(ImageConverterFlag::Verbose);
+        converter->configuration().setValue("threads", data.threads);
+        converter->configuration().setValue("shared_job_pool", true);
+        converter->configuration().setValue("shared_job_pool_thread_budget", data.threadBudget);
+        converter->configuration().setValue("shared_job_pool_memory_budget", data.memoryBudget);
+    }
+
+    std::thread threads[Containers::arraySize(converters)];
+    for(std::size_t i = 0; i != Containers::arraySize(threads); ++i)
+        threads[i] = std::thread{[&](std::size_t i) {
+            /* Debug output redirection is thread-local with
+               CORRADE_BUILD_MULTITHREADED */
+            Debug redirectOutput{&outs[i]};
+            outputs[i] = converters[i]->convertToData(*originalImage);
+        }, i};
+    for(std::thread& thread: threads)
+        thread.join();
+
+    const std::size_t memoryBudget = std::size_t(data.memoryBudget*1024.0*1024.0);
+    for(std::size_t i = 0; i != Containers::arraySize(outputs); ++i) {
+        CORRADE_ITERATION(i);
+        CORRADE_VERIFY(outputs[i]);
+
+        UnsignedInt threadCount, threadsInUse, conversionsRunning;
+        std::size_t memoryInUse;
+        CORRADE_COMPARE(std::sscanf(outs[i].data(), "Trade::BasisImageConverter::convertToData(): running with %u threads, %u threads and %zu bytes of estimated memory in use by %u conversions", &threadCount, &threadsInUse, &memoryInUse, &conversionsRunning), 4);
+        CORRADE_COMPARE(threadCount, data.expectedThreadCount);
+        CORRADE_COMPARE_AS(conversionsRunning, data.maxConversions,
+            TestSuite::Compare::LessOrEqual);
+        CORRADE_COMPARE(threadsInUse, conversionsRunning*data.expectedThreadCount);
+        if(memoryBudget && conversionsRunning > 1)
+            CORRADE_COMPARE_AS(memoryInUse, memoryBudget,
+                TestSuite::Compare::LessOrEqual);
+    }
+
+    if(_manager.loadState("BasisImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("BasisImporter plugin not found, cannot test");
+
+    for(std::size_t i = 0; i != Containers::arraySize(outputs); ++i) {
+        CORRADE_ITERATION(i);
+
+        Containers::Pointer<AbstractImporter> importer = _manager.instantiate("BasisImporterRGBA8");
+        CORRADE_VERIFY(importer->openData(*outputs[i]));
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+        CORRADE_VERIFY(image);
+
+        CORRADE_COMPARE_WITH(image->pixels<Color4ub>(),
+            Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-63x27.png"),
+            /* Same as in threads() */
+            (DebugTools::CompareImageToFile{_manager, 97.25f, 7.914f}));
+    }
+
+    /* Converting again with a different thread count creates a new pool,
+       dropping idle pools that no longer fit into the budget */
+    converters[0]->configuration().setValue("threads", 1);
+    Containers::String out;
+    {
+        Debug redirectOutput{&out};
+        CORRADE_VERIFY(converters[0]->convertToData(*originalImage));
+    }
+    CORRADE_COMPARE_AS(out,
+        "Trade::BasisImageConverter::convertToData(): running with 1 threads, 1 threads and",
+        TestSuite::Compare::StringHasPrefix);
+}
+
 void BasisImageConverterTest::ktx() {
     auto&& data = FlippedData[testCaseInstanceId()];
     setTestCaseDescription(data.name);
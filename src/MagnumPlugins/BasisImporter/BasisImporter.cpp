@@ -28,6 +28,8 @@
 
 #include "BasisImporter.h"
 
+#include <atomic>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
@@ -35,8 +37,11 @@
 #include <Corrade/Utility/Debug.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Math/ColorBatch.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/threadsAndCache.h"
+
 #include <basisu_transcoder.h>
 
 #ifdef MAGNUM_BUILD_DEPRECATED
@@ -122,6 +127,79 @@ constexpr Int FormatHdrStart = Int(BasisImporter::TargetFormat::Bc6hRGB);
 /* Last element has to be on the same index as last enum value */
 static_assert(Containers::arraySize(FormatNames) - 1 == Int(BasisImporter::TargetFormat::RGBA16F), "bad string format mapping");
 
+/* Size and output data layout of a single image level */
+struct LevelLayout {
+    Vector2ui size;
+    UnsignedInt totalBlocks;
+    UnsignedInt rowStrideInBlocksOrPixels;
+    UnsignedInt outputRowsInPixels;
+    UnsignedInt outputSizeInBlocksOrPixels;
+    /* Size of a single layer or face in bytes */
+    UnsignedInt sliceSize;
+    bool isIFrame;
+};
+
+/* A transcoded level in the cache */
+struct CachedLevel {
+    UnsignedInt id;
+    UnsignedInt level;
+    BasisImporter::TargetFormat format;
+    /* Transcoded ahead of time and not requested yet. Such levels are moved
+       out of the cache when requested if they don't fit into the budget. */
+    bool prefetched;
+    UnsignedLong lastUsed;
+    /* Not Y-flipped, the flip is done on every retrieval */
+    Containers::Array<char> data;
+};
+
+std::size_t findCachedLevel(const Containers::ArrayView<const CachedLevel> cache, const UnsignedInt id, const UnsignedInt level, const BasisImporter::TargetFormat format) {
+    for(std::size_t i = 0; i != cache.size(); ++i)
+        if(cache[i].id == id && cache[i].level == level && cache[i].format == format)
+            return i;
+    return ~std::size_t{};
+}
+
+/* Order of the entries doesn't matter, so it's replaced with the last one */
+void removeCachedLevel(Containers::Array<CachedLevel>& cache, const std::size_t i) {
+    if(i != cache.size() - 1)
+        cache[i] = Utility::move(cache.back());
+    arrayRemoveSuffix(cache, 1);
+}
+
+/* Removes least recently used levels until their total size fits into the
+   budget. Levels prefetched by the most recent transcoding, i.e. with
+   lastUsed larger than batchBegin, that weren't requested yet are exempt,
+   so the levels and formats transcoded together are all available at least
+   until the next transcoding. Prefetched levels from earlier transcodings are
+   treated the same as the requested ones. */
+void shrinkCache(Containers::Array<CachedLevel>& cache, const std::size_t budget, const UnsignedLong batchBegin) {
+    for(;;) {
+        std::size_t size = 0;
+        std::size_t leastRecentlyUsed = ~std::size_t{};
+        for(std::size_t i = 0; i != cache.size(); ++i) {
+            if(cache[i].prefetched && cache[i].lastUsed > batchBegin)
+                continue;
+            size += cache[i].data.size();
+            if(leastRecentlyUsed == ~std::size_t{} || cache[i].lastUsed < cache[leastRecentlyUsed].lastUsed)
+                leastRecentlyUsed = i;
+        }
+
+        if(size <= budget)
+            return;
+        removeCachedLevel(cache, leastRecentlyUsed);
+    }
+}
+
+/* Transcoder state for transcoding from multiple threads at once. Each
+   thread needs its own, the transcoders themselves are then only read
+   from. */
+struct TranscoderState {
+    basist::basisu_transcoder_state basis;
+    #if BASISD_SUPPORT_KTX2
+    basist::ktx2_transcoder_state ktx2;
+    #endif
+};
+
 }
 
 }}
@@ -194,6 +272,14 @@ struct BasisImporter::State {
     bool noTranscodeFormatWarningPrinted = false;
     bool yFlipNotPossibleWarningPrinted = false;
 
+    /* Transcoded levels, either prefetched by the parallel transcoding if the
+       threads option isn't 1 or kept after being returned if they fit into
+       the cacheSize budget */
+    Containers::Array<CachedLevel> cachedLevels;
+    UnsignedLong cacheUseCounter = 0;
+    /* Value of cacheUseCounter before the most recent transcoding */
+    UnsignedLong cacheBatchBegin = 0;
+
     explicit State()
     #if BASISD_LIB_VERSION < 116
         : codebook(basist::g_global_selector_cb_size, basist::g_global_selector_cb)
@@ -255,6 +341,7 @@ void BasisImporter::doClose() {
     _state->ktx2Transcoder = Containers::NullOpt;
     #endif
     _state->in = nullptr;
+    _state->cachedLevels = nullptr;
 }
 
 void BasisImporter::doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) {
@@ -594,55 +681,127 @@ template<UnsignedInt dimensions> Containers::Optional<ImageData<dimensions>> Bas
         return Containers::NullOpt;
     }
 
-    UnsignedInt origWidth, origHeight, totalBlocks, numFaces;
-    bool isIFrame;
-    #if BASISD_SUPPORT_KTX2
-    if(_state->ktx2Transcoder) {
-        basist::ktx2_image_level_info levelInfo;
-        /* Header validation etc. is already done in doOpenData() and id is
-           bounds-checked against doImage2DCount() by AbstractImporter, so by
-           looking at the code there's nothing else that could fail and wasn't
-           already caught before. That means we also can't craft any file to
-           cover an error path, so turning this into an assert. When this blows
-           up for someome, we'd most probably need to harden doOpenData() to
-           catch that, not turning this into a graceful error.
-
-           For independent images and videos we use the correct layer. For
-           images as slices, they're all the same size, (checked in
-           doOpenData()) and isIFrame is not used, so any layer or face works. */
-        CORRADE_INTERNAL_ASSERT_OUTPUT(_state->ktx2Transcoder->get_image_level_info(levelInfo, level, id, 0));
-
-        origWidth = levelInfo.m_orig_width;
-        origHeight = levelInfo.m_orig_height;
-        totalBlocks = levelInfo.m_total_blocks;
-        /* m_iframe_flag is always false for UASTC video:
-           https://github.com/BinomialLLC/basis_universal/issues/259
-           However, it's safe to assume the first frame is always an I-frame. */
-        isIFrame = levelInfo.m_iframe_flag || id == 0;
-
-        numFaces = _state->ktx2Transcoder->get_faces();
-    } else
-    #endif
-    {
-        /* See comment right above */
-        basist::basisu_image_level_info levelInfo;
-        CORRADE_INTERNAL_ASSERT_OUTPUT(_state->basisTranscoder->get_image_level_info(_state->in.data(), _state->in.size(), levelInfo, id, level));
+    /* Additional formats to transcode into and put into the cache. The
+       requested format is always first. Formats that are HDR for LDR images
+       and vice versa are skipped, as are duplicates. Video frames are never
+       cached, as each P-frame needs the previous frame to be transcoded
+       right before. */
+    Containers::Array<TargetFormat> formats;
+    arrayAppend(formats, *targetFormat);
+    for(const Containers::StringView name: configuration().value<Containers::StringView>("cacheFormats").splitOnWhitespaceWithoutEmptyParts()) {
+        Int i = 0;
+        for(const char* formatName: FormatNames) {
+            if(formatName && name == formatName)
+                break;
+            ++i;
+        }
+        if(UnsignedInt(i) == Containers::arraySize(FormatNames)) {
+            Error{} << prefix << "invalid transcoding target format" << name << "in the cacheFormats option, expected one of" << expectedFormatsLdr << "for LDR images or" << expectedFormatsHdr << "for HDR images";
+            return Containers::NullOpt;
+        }
+        if(_state->isVideo || isHdr != (i >= FormatHdrStart))
+            continue;
 
-        origWidth = levelInfo.m_orig_width;
-        origHeight = levelInfo.m_orig_height;
-        totalBlocks = levelInfo.m_total_blocks;
-        isIFrame = levelInfo.m_iframe_flag;
+        bool duplicate = false;
+        for(const TargetFormat existing: formats) if(existing == TargetFormat(i)) {
+            duplicate = true;
+            break;
+        }
+        if(duplicate)
+            continue;
 
-        numFaces = _state->imageFlags & ImageFlag3D::CubeMap ? 6 : 1;
+        if(!basist::basis_is_format_supported(basist::transcoder_texture_format(i), _state->compressionType)) {
+            Error{} << prefix << "Basis Universal was compiled without support for" << name;
+            return Containers::NullOpt;
+        }
+
+        arrayAppend(formats, TargetFormat(i));
     }
 
-    const UnsignedInt numLayers = _state->numSlices/numFaces;
+    const bool isUncompressed = basist::basis_transcoder_format_is_uncompressed(format);
+    const UnsignedInt formatSize = basis_get_bytes_per_block_or_pixel(format);
+
+    /* KTX2 files have either 1 or 6 faces, and if 6 they're marked as a cube
+       map in doOpenData(), so this is the same for both file types */
+    const UnsignedInt numFaces = _state->imageFlags & ImageFlag3D::CubeMap ? 6 : 1;
+
+    /* Calculates size and output data layout of given level in given
+       format */
+    const auto levelLayout = [&](const UnsignedInt levelId, const basist::transcoder_texture_format levelFormat) {
+        LevelLayout out;
+        #if BASISD_SUPPORT_KTX2
+        if(_state->ktx2Transcoder) {
+            basist::ktx2_image_level_info levelInfo;
+            /* Header validation etc. is already done in doOpenData() and id
+               is bounds-checked against doImage2DCount() by
+               AbstractImporter, so by looking at the code there's nothing
+               else that could fail and wasn't already caught before. That
+               means we also can't craft any file to cover an error path, so
+               turning this into an assert. When this blows up for someome,
+               we'd most probably need to harden doOpenData() to catch that,
+               not turning this into a graceful error.
+
+               For independent images and videos we use the correct layer.
+               For images as slices, they're all the same size, (checked in
+               doOpenData()) and isIFrame is not used, so any layer or face
+               works. */
+            CORRADE_INTERNAL_ASSERT_OUTPUT(_state->ktx2Transcoder->get_image_level_info(levelInfo, levelId, id, 0));
+
+            out.size = {levelInfo.m_orig_width, levelInfo.m_orig_height};
+            out.totalBlocks = levelInfo.m_total_blocks;
+            /* m_iframe_flag is always false for UASTC video:
+               https://github.com/BinomialLLC/basis_universal/issues/259
+               However, it's safe to assume the first frame is always an
+               I-frame. */
+            out.isIFrame = levelInfo.m_iframe_flag || id == 0;
+        } else
+        #endif
+        {
+            /* See comment right above */
+            basist::basisu_image_level_info levelInfo;
+            CORRADE_INTERNAL_ASSERT_OUTPUT(_state->basisTranscoder->get_image_level_info(_state->in.data(), _state->in.size(), levelInfo, id, levelId));
+
+            out.size = {levelInfo.m_orig_width, levelInfo.m_orig_height};
+            out.totalBlocks = levelInfo.m_total_blocks;
+            out.isIFrame = levelInfo.m_iframe_flag;
+        }
+
+        if(basist::basis_transcoder_format_is_uncompressed(levelFormat)) {
+            out.rowStrideInBlocksOrPixels = out.size.x();
+            out.outputRowsInPixels = out.size.y();
+            out.outputSizeInBlocksOrPixels = out.size.x()*out.size.y();
+        } else {
+            out.rowStrideInBlocksOrPixels = 0; /* left up to Basis to calculate */
+            out.outputRowsInPixels = 0; /* not used for compressed data */
+            out.outputSizeInBlocksOrPixels = out.totalBlocks;
+        }
+
+        out.sliceSize = basis_get_bytes_per_block_or_pixel(levelFormat)*out.outputSizeInBlocksOrPixels;
+        return out;
+    };
+
+    /* Transcodes a single layer and face of given level. If the image id is
+       > 0, there can't be any layers or faces, this is already asserted in
+       doOpenData(). This allows us to calculate the layer (KTX2) or image id
+       to transcode with a simple addition.
+
+       If state is null, the transcoder-internal state is used, which means
+       the transcoding can't happen from multiple threads at once. */
+    const auto transcodeSlice = [&](const UnsignedInt levelId, const basist::transcoder_texture_format sliceFormat, const LevelLayout& sliceLayout, const UnsignedInt layer, const UnsignedInt face, char* const output, TranscoderState* const state) -> bool {
+        #if BASISD_SUPPORT_KTX2
+        if(_state->ktx2Transcoder)
+            return _state->ktx2Transcoder->transcode_image_level(levelId, id + layer, face, output, sliceLayout.outputSizeInBlocksOrPixels, sliceFormat, 0, sliceLayout.rowStrideInBlocksOrPixels, sliceLayout.outputRowsInPixels, -1, -1, state ? &state->ktx2 : nullptr);
+        #endif
+        return _state->basisTranscoder->transcode_image_level(_state->in.data(), _state->in.size(), id + (layer*numFaces + face), levelId, output, sliceLayout.outputSizeInBlocksOrPixels, sliceFormat, 0, sliceLayout.rowStrideInBlocksOrPixels, state ? &state->basis : nullptr, sliceLayout.outputRowsInPixels);
+    };
+
+    const LevelLayout layout = levelLayout(level, format);
 
     /* basisu doesn't allow seeking to arbitrary video frames. If this isn't an
        I-frame, only allow transcoding the frame following the last P-frame. */
     if(_state->isVideo) {
         const UnsignedInt expectedImageId = _state->lastTranscodedImageId + 1;
-        if(!isIFrame && id != expectedImageId) {
+        if(!layout.isIFrame && id != expectedImageId) {
             Error{} << prefix << "video frames must be transcoded sequentially, expected frame"
                 << expectedImageId << (expectedImageId == 0 ? "but got" : "or 0 but got") << id;
             return Containers::NullOpt;
@@ -650,55 +809,138 @@ template<UnsignedInt dimensions> Containers::Optional<ImageData<dimensions>> Bas
         _state->lastTranscodedImageId = id;
     }
 
-    const bool isUncompressed = basist::basis_transcoder_format_is_uncompressed(format);
-    const UnsignedInt formatSize = basis_get_bytes_per_block_or_pixel(format);
+    const Vector3ui size{layout.size, _state->numSlices};
+    const std::size_t cacheSize = configuration().value<std::size_t>("cacheSize");
+
+    /* If the level is in the cache already, take it from there. Video frames
+       are never put into the cache as each P-frame needs the previous frame
+       to be transcoded. */
+    Containers::Array<char> dest;
+    const std::size_t cached = findCachedLevel(_state->cachedLevels, id, level, *targetFormat);
+    if(cached != ~std::size_t{}) {
+        if(flags() & ImporterFlag::Verbose)
+            Debug{} << prefix << "level" << level << "of image" << id << "taken from the cache";
+
+        /* If it fits into the cache budget, keep it there, and return a copy.
+           Otherwise move it out, so it doesn't occupy memory anymore. */
+        CachedLevel& cachedLevel = _state->cachedLevels[cached];
+        if(cachedLevel.data.size() <= cacheSize) {
+            dest = Containers::Array<char>{NoInit, cachedLevel.data.size()};
+            Utility::copy(cachedLevel.data, dest);
+            cachedLevel.prefetched = false;
+            cachedLevel.lastUsed = ++_state->cacheUseCounter;
+        } else {
+            dest = Utility::move(cachedLevel.data);
+            removeCachedLevel(_state->cachedLevels, cached);
+        }
 
-    const Vector3ui size{origWidth, origHeight, _state->numSlices};
-    UnsignedInt rowStrideInBlocksOrPixels, outputRowsInPixels, outputSizeInBlocksOrPixels;
-    if(isUncompressed) {
-        rowStrideInBlocksOrPixels = size.x();
-        outputRowsInPixels = size.y();
-        outputSizeInBlocksOrPixels = size.x()*size.y();
+    /* Otherwise transcode it */
     } else {
-        rowStrideInBlocksOrPixels = 0; /* left up to Basis to calculate */
-        outputRowsInPixels = 0; /* not used for compressed data */
-        outputSizeInBlocksOrPixels = totalBlocks;
-    }
+        /* Value of 0 means all hardware threads, 1 means transcoding serially
+           just the requested level in the calling thread. Video frames depend
+           on the previous frame state, so those are always transcoded
+           serially. */
+        UnsignedInt threadCount = configuration().value<UnsignedInt>("threads");
+        if(_state->isVideo)
+            threadCount = 1;
+        if(!threadCount) {
+            threadCount = Implementation::threadCount(0);
+            if(flags() & ImporterFlag::Verbose)
+                Debug{} << prefix << "autodetected hardware concurrency to" << threadCount << "threads";
+        }
 
-    const UnsignedInt sliceSize = formatSize*outputSizeInBlocksOrPixels;
-    const UnsignedInt dataSize = sliceSize*size.z();
-    Containers::Array<char> dest{NoInit, dataSize};
-
-    /* There's no function for transcoding the entire level, so loop over all
-       layers and faces and transcode each one. This matches the image layout
-       imported by KtxImporter, ie. all faces +X through -Z for the first
-       layer, then all faces of the second layer, etc.
-
-       If the user is requesting id > 0, there can't be any layers or faces,
-       this is already asserted in doOpenData(). This allows us to calculate
-       the layer (KTX2) or image id to transcode with a simple addition. */
-    for(UnsignedInt l = 0; l != numLayers; ++l) {
-        for(UnsignedInt f = 0; f != numFaces; ++f) {
-            const UnsignedInt offset = (l*numFaces + f)*sliceSize;
-            #if BASISD_SUPPORT_KTX2
-            if(_state->ktx2Transcoder) {
-                const UnsignedInt currentLayer = id + l;
-                if(!_state->ktx2Transcoder->transcode_image_level(level, currentLayer, f, dest.data() + offset, outputSizeInBlocksOrPixels, format, 0, rowStrideInBlocksOrPixels, outputRowsInPixels)) {
-                    Error{} << prefix << "transcoding failed";
-                    return Containers::NullOpt;
-                }
-            } else
-            #endif
-            {
-                const UnsignedInt currentId = id + (l*numFaces + f);
-                if(!_state->basisTranscoder->transcode_image_level(_state->in.data(), _state->in.size(), currentId, level, dest.data() + offset, outputSizeInBlocksOrPixels, format, 0, rowStrideInBlocksOrPixels, nullptr, outputRowsInPixels)) {
-                    Error{} << prefix << "transcoding failed";
-                    return Containers::NullOpt;
+        /* Either just the requested level or, if multithreaded, all levels of
+           the image. Each in all formats. */
+        const UnsignedInt levelBegin = threadCount == 1 ? level : 0;
+        const UnsignedInt levelCount = threadCount == 1 ? 1 : _state->numLevels[id];
+        const std::size_t formatCount = formats.size();
+        Containers::Array<LevelLayout> layouts{NoInit, levelCount*formatCount};
+        Containers::Array<Containers::Array<char>> outputs{levelCount*formatCount};
+        for(UnsignedInt i = 0; i != levelCount; ++i) {
+            for(std::size_t f = 0; f != formatCount; ++f) {
+                LevelLayout& outputLayout = layouts[i*formatCount + f];
+                outputLayout = levelLayout(levelBegin + i, basist::transcoder_texture_format(Int(formats[f])));
+                outputs[i*formatCount + f] = Containers::Array<char>{NoInit, outputLayout.sliceSize*_state->numSlices};
+            }
+        }
+
+        /* There's no function for transcoding the entire level, so each job
+           is a single layer and face of a single level, producing data that
+           match the image layout imported by KtxImporter, ie. all faces +X
+           through -Z for the first layer, then all faces of the second layer,
+           etc.
+
+           Every thread picks the next unprocessed job until there's none
+           left. Each slice is transcoded to all formats right after each
+           other using the same transcoder state, which means for
+           supercompressed KTX2 files the level data get decompressed just
+           once for all target formats. */
+        const std::size_t jobCount = std::size_t(levelCount)*_state->numSlices*formatCount;
+        std::atomic<std::size_t> nextJob{0};
+        std::atomic<bool> failed{false};
+        const auto worker = [&](TranscoderState* const state) {
+            for(std::size_t job; !failed && (job = nextJob++) < jobCount; ) {
+                const std::size_t f = job%formatCount;
+                const UnsignedInt slice = (job/formatCount)%_state->numSlices;
+                const UnsignedInt i = job/(formatCount*_state->numSlices);
+                const std::size_t output = i*formatCount + f;
+                if(!transcodeSlice(levelBegin + i, basist::transcoder_texture_format(Int(formats[f])), layouts[output], slice/numFaces, slice%numFaces, outputs[output].data() + slice*layouts[output].sliceSize, state))
+                    failed = true;
+            }
+        };
+
+        /* If single-threaded, use the transcoder-internal state, which
+           preserves the previous frame for videos. Otherwise each thread
+           needs its own, and the calling thread does its share of the work as
+           well. */
+        if(threadCount == 1) worker(nullptr);
+        else {
+            const auto threadWorker = [&]() {
+                TranscoderState state;
+                worker(&state);
+            };
+            Implementation::runInThreads(Math::min(std::size_t(threadCount), jobCount), threadWorker);
+        }
+
+        if(failed) {
+            Error{} << prefix << "transcoding failed";
+            return Containers::NullOpt;
+        }
+
+        /* Levels transcoded ahead of time by previous calls that weren't
+           requested so far become subject to the cache budget from now on,
+           same as the already requested ones */
+        _state->cacheBatchBegin = _state->cacheUseCounter;
+
+        /* Return the requested level and put everything else into the cache.
+           If the requested level fits into the cache budget, put a copy of it
+           there as well. */
+        for(UnsignedInt i = 0; i != levelCount; ++i) {
+            for(std::size_t f = 0; f != formatCount; ++f) {
+                Containers::Array<char>& output = outputs[i*formatCount + f];
+                const bool requested = levelBegin + i == level && f == 0;
+                if(requested) {
+                    dest = Utility::move(output);
+                    if(_state->isVideo || dest.size() > cacheSize)
+                        continue;
+                    output = Containers::Array<char>{NoInit, dest.size()};
+                    Utility::copy(dest, output);
                 }
+
+                /* Replace a potential stale entry, such as a level previously
+                   moved out of the cache */
+                const std::size_t existing = findCachedLevel(_state->cachedLevels, id, levelBegin + i, formats[f]);
+                if(existing != ~std::size_t{})
+                    removeCachedLevel(_state->cachedLevels, existing);
+
+                arrayAppend(_state->cachedLevels, InPlaceInit, id, levelBegin + i, formats[f], !requested, ++_state->cacheUseCounter, Utility::move(output));
             }
         }
     }
 
+    /* Evict least recently used levels if over the budget */
+    shrinkCache(_state->cachedLevels, cacheSize, _state->cacheBatchBegin);
+
     if(isUncompressed) {
         /* Adjust pixel storage if row size is not four byte aligned */
         PixelStorage storage;
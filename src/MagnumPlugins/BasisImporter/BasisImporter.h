@@ -216,6 +216,65 @@ halve correctly in the z-dimension for 3D images. If a 3D image with mip levels
 is detected, it gets imported as a layered 2D image instead, along with a
 warning being printed.
 
+@subsection Trade-BasisImporter-behavior-multithreading Multithreaded transcoding
+
+By default, only the requested level is transcoded, serially in the calling
+thread. If the @cb{.ini} threads @ce
+@ref Trade-BasisImporter-configuration "configuration option" is set to a
+value other than @cpp 1 @ce, the first @ref image2D() / @ref image3D() call
+for a particular image transcodes all its levels, array layers and cube map
+faces at once, distributed across given number of threads. The requested
+level is returned and the remaining levels are kept in a cache, from which
+they're returned without any additional work on subsequent calls. Each level
+is removed from the cache once returned, unless it fits into the cache budget
+described @ref Trade-BasisImporter-behavior-cache "below". Levels that weren't
+requested yet are kept until the next transcoding happens, after which they
+count towards the cache budget like the already requested levels. All of them
+are discarded when the file is closed.
+
+Video frames depend on the previous frame and thus are always transcoded
+serially, regardless of the option value.
+
+On Linux, using more than one thread requires the application to be linked
+to `pthread`, see @ref cmake-plugins-threads for details.
+
+@subsection Trade-BasisImporter-behavior-cache Transcoding cache
+
+If the @cb{.ini} cacheSize @ce
+@ref Trade-BasisImporter-configuration "configuration option" is set to a
+non-zero value, transcoded levels are kept in a cache after being returned,
+until their total size in bytes exceeds given value, in which case the least
+recently used levels are discarded. The cache is keyed by the image ID, level
+and target format, so switching between the @cb{.ini} format @ce option values
+and requesting the same image again is free if the transcoded data for the
+other format are still in the cache. Data in the cache are always stored in
+the original orientation and Y-flipped on every retrieval if needed.
+
+Additionally, the @cb{.ini} cacheFormats @ce option can list additional target
+formats to transcode the requested level into together with the format that's
+currently set. Each layer and face is transcoded to all formats right after
+each other using the same transcoder state, which means that for example with
+Zstd-supercompressed UASTC KTX2 files the level data get decompressed just
+once for all target formats, and ETC1S codebooks are decoded just once when
+opening the file. The additional formats are put into the cache and returned
+once the @cb{.ini} format @ce or @cb{.ini} formatHdr @ce option is set to one
+of them:
+
+@snippet BasisImporter.cpp cache-formats
+
+Levels transcoded to the additional formats, as well as levels transcoded
+ahead of time with the @cb{.ini} threads @ce option, don't count towards the
+cache budget until either they're requested for the first time or the next
+transcoding happens. After that they're subject to the same least recently
+used eviction as the requested levels, so with a large enough budget it's
+possible to import all levels in one format and then all levels in the
+additional formats without transcoding again. Importing with the
+@ref ImporterFlag::Verbose flag enabled prints a message for every level
+that's taken from the cache.
+
+Video frames depend on the previous frame being transcoded right before, and
+so they're never put into the cache.
+
 @subsection Trade-BasisImporter-behavior-cube Cube maps
 
 Cube map faces are imported in the order +X, -X, +Y, -Y, +Z, -Z as seen from a
@@ -27,8 +27,10 @@
 */
 
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pair.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/DebugStl.h> /** @todo remove once Configuration is std::string-free */
@@ -96,6 +98,15 @@ struct BasisImporterTest: TestSuite::Tester {
     void videoSeeking();
     void videoVerbose();
 
+    void threaded();
+    void threadedMultipleImages();
+    void threadedVideo();
+
+    void cache();
+    void cacheFormats();
+    void cacheFormatsAllLevels();
+    void cacheFormatsInvalid();
+
     void flipUncompressed();
     void flipUncompressed3D();
     void flip();
@@ -506,6 +517,39 @@ const struct {
     {"KTX2 UASTC", "rgba-video-uastc.ktx2", true}
 };
 
+const struct {
+    const char* name;
+    const char* file;
+    const char* format;
+    UnsignedInt threads;
+    bool hasMissingOrientationMetadata;
+} ThreadedData[]{
+    {"array, Basis, RGBA8", "rgba-array-mips.basis", "RGBA8", 3, false},
+    {"array, KTX2, RGBA8", "rgba-array-mips.ktx2", "RGBA8", 3, true},
+    {"array, Basis, BC1, all threads", "rgba-array-mips.basis", "Bc1RGB", 0, false},
+    {"array, KTX2, BC1, all threads", "rgba-array-mips.ktx2", "Bc1RGB", 0, true},
+    {"cube map array, Basis, BC3", "rgba-cubemap-array.basis", "Bc3RGBA", 4, false},
+    {"cube map array, KTX2, ETC2", "rgba-cubemap-array.ktx2", "Etc2RGBA", 4, true},
+    /* More threads than there are slices in all levels */
+    {"3D, Basis, RGBA8, excessive threads", "rgba-3d-mips.basis", "RGBA8", 64, false},
+};
+
+const struct {
+    const char* name;
+    const char* extension;
+    UnsignedInt threads;
+    std::size_t cacheSize;
+    bool hasMissingOrientationMetadata;
+} CacheData[]{
+    {"Basis", ".basis", 1, 1024*1024, false},
+    {"KTX2", ".ktx2", 1, 1024*1024, true},
+    {"Basis, threaded", ".basis", 3, 1024*1024, false},
+    {"KTX2, threaded", ".ktx2", 3, 1024*1024, true},
+    /* Just the first level fits, the others get evicted every time */
+    {"Basis, small budget", ".basis", 1, 63*27*3*4, false},
+    {"KTX2, small budget, threaded", ".ktx2", 2, 63*27*3*4, true},
+};
+
 /* Shared among all plugins that implement data copying optimizations */
 const struct {
     const char* name;
@@ -583,6 +627,19 @@ BasisImporterTest::BasisImporterTest() {
 
     addTests({&BasisImporterTest::videoVerbose});
 
+    addInstancedTests({&BasisImporterTest::threaded},
+        Containers::arraySize(ThreadedData));
+
+    addTests({&BasisImporterTest::threadedMultipleImages,
+              &BasisImporterTest::threadedVideo});
+
+    addInstancedTests({&BasisImporterTest::cache,
+                       &BasisImporterTest::cacheFormats},
+        Containers::arraySize(CacheData));
+
+    addTests({&BasisImporterTest::cacheFormatsAllLevels,
+              &BasisImporterTest::cacheFormatsInvalid});
+
     addInstancedTests({&BasisImporterTest::flipUncompressed},
         Containers::arraySize(FlipUncompressedData));
 
@@ -1733,6 +1790,249 @@ void BasisImporterTest::videoVerbose() {
     CORRADE_COMPARE(out, "Trade::BasisImporter::openData(): file contains video frames, images must be transcoded sequentially\n");
 }
 
+void BasisImporterTest::threaded() {
+    auto&& data = ThreadedData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Ground truth transcoded serially */
+    Containers::Pointer<AbstractImporter> serialImporter = _manager.instantiate("BasisImporter");
+    serialImporter->addFlags(ImporterFlag::Quiet);
+    serialImporter->configuration().setValue("format", data.format);
+    if(data.hasMissingOrientationMetadata)
+        serialImporter->configuration().setValue("assumeYUp", true);
+    CORRADE_VERIFY(serialImporter->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, data.file)));
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("BasisImporter");
+    importer->addFlags(ImporterFlag::Quiet);
+    importer->configuration().setValue("format", data.format);
+    importer->configuration().setValue("threads", data.threads);
+    if(data.hasMissingOrientationMetadata)
+        importer->configuration().setValue("assumeYUp", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, data.file)));
+
+    CORRADE_COMPARE(importer->image3DCount(), 1);
+    const UnsignedInt levelCount = importer->image3DLevelCount(0);
+    CORRADE_COMPARE(levelCount, serialImporter->image3DLevelCount(0));
+
+    /* Going in reverse, so the first request isn't for the first level.
+       Everything after the first request is taken from the cache, the result
+       should be the same. */
+    for(UnsignedInt i = levelCount; i != 0; --i) {
+        CORRADE_ITERATION(i - 1);
+        Containers::Optional<Trade::ImageData3D> expected = serialImporter->image3D(0, i - 1);
+        Containers::Optional<Trade::ImageData3D> actual = importer->image3D(0, i - 1);
+        CORRADE_VERIFY(expected);
+        CORRADE_VERIFY(actual);
+        CORRADE_COMPARE(actual->isCompressed(), expected->isCompressed());
+        CORRADE_COMPARE(actual->flags(), expected->flags());
+        CORRADE_COMPARE(actual->size(), expected->size());
+        CORRADE_COMPARE_AS(actual->data(), expected->data(),
+            TestSuite::Compare::Container);
+    }
+
+    /* Requesting the same level again transcodes it again, as it's removed
+       from the cache once returned */
+    Containers::Optional<Trade::ImageData3D> expected = serialImporter->image3D(0);
+    Containers::Optional<Trade::ImageData3D> actual = importer->image3D(0);
+    CORRADE_VERIFY(expected);
+    CORRADE_VERIFY(actual);
+    CORRADE_COMPARE_AS(actual->data(), expected->data(),
+        TestSuite::Compare::Container);
+
+    /* Changing the target format means the remaining levels in the cache
+       are not used, as they're for a different format */
+    serialImporter->configuration().setValue("format", "RGBA8");
+    importer->configuration().setValue("format", "RGBA8");
+    for(UnsignedInt i = 0; i != levelCount; ++i) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData3D> expected = serialImporter->image3D(0, i);
+        Containers::Optional<Trade::ImageData3D> actual = importer->image3D(0, i);
+        CORRADE_VERIFY(expected);
+        CORRADE_VERIFY(actual);
+        CORRADE_VERIFY(!actual->isCompressed());
+        CORRADE_COMPARE(actual->format(), expected->format());
+        CORRADE_COMPARE_AS(actual->data(), expected->data(),
+            TestSuite::Compare::Container);
+    }
+}
+
+void BasisImporterTest::threadedMultipleImages() {
+    Containers::Pointer<AbstractImporter> serialImporter = _manager.instantiate("BasisImporterRGBA8");
+    CORRADE_VERIFY(serialImporter->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-2images-mips.basis")));
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("BasisImporterRGBA8");
+    importer->configuration().setValue("threads", 2);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-2images-mips.basis")));
+    CORRADE_COMPARE(importer->image2DCount(), 2);
+
+    /* Interleaving requests for different images, causing the cache to be
+       thrown away and filled again each time */
+    for(Containers::Pair<UnsignedInt, UnsignedInt> idLevel: {
+        Containers::pair(0u, 1u),
+        Containers::pair(1u, 0u),
+        Containers::pair(0u, 0u),
+        Containers::pair(0u, 2u),
+        Containers::pair(1u, 1u)
+    }) {
+        CORRADE_ITERATION(idLevel.first() << idLevel.second());
+        Containers::Optional<Trade::ImageData2D> expected = serialImporter->image2D(idLevel.first(), idLevel.second());
+        Containers::Optional<Trade::ImageData2D> actual = importer->image2D(idLevel.first(), idLevel.second());
+        CORRADE_VERIFY(expected);
+        CORRADE_VERIFY(actual);
+        CORRADE_COMPARE(actual->size(), expected->size());
+        CORRADE_COMPARE_AS(actual->data(), expected->data(),
+            TestSuite::Compare::Container);
+    }
+}
+
+void BasisImporterTest::threadedVideo() {
+    /* Videos are always transcoded serially, so the seeking restrictions
+       still apply */
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("BasisImporterRGBA8");
+    importer->configuration().setValue("threads", 4);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-video.basis")));
+    CORRADE_COMPARE(importer->image2DCount(), 3);
+
+    CORRADE_VERIFY(importer->image2D(0));
+
+    Containers::String out;
+    {
+        Error redirectError{&out};
+        CORRADE_VERIFY(!importer->image2D(2));
+    }
+    CORRADE_COMPARE(out, "Trade::BasisImporter::image2D(): video frames must be transcoded sequentially, expected frame 1 or 0 but got 2\n");
+
+    CORRADE_VERIFY(importer->image2D(1));
+    CORRADE_VERIFY(importer->image2D(2));
+}
+
+void BasisImporterTest::cache() {
+    auto&& data = CacheData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> serialImporter = _manager.instantiate("BasisImporter");
+    serialImporter->configuration().setValue("format", "Bc1RGB");
+    if(data.hasMissingOrientationMetadata)
+        serialImporter->configuration().setValue("assumeYUp", true);
+    CORRADE_VERIFY(serialImporter->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-array-mips"_s + data.extension)));
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("BasisImporter");
+    importer->configuration().setValue("format", "Bc1RGB");
+    importer->configuration().setValue("threads", data.threads);
+    importer->configuration().setValue("cacheSize", data.cacheSize);
+    if(data.hasMissingOrientationMetadata)
+        importer->configuration().setValue("assumeYUp", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-array-mips"_s + data.extension)));
+    CORRADE_COMPARE(importer->image3DLevelCount(0), 3);
+
+    /* Alternating between two formats and requesting each level several
+       times. The result should be always the same as without a cache,
+       whether it's taken from it or not. */
+    for(const char* format: {"Bc1RGB", "RGBA8", "Bc1RGB", "RGBA8"}) {
+        serialImporter->configuration().setValue("format", format);
+        importer->configuration().setValue("format", format);
+        for(UnsignedInt level: {0, 2, 1, 0, 2}) {
+            CORRADE_ITERATION(format << level);
+            Containers::Optional<Trade::ImageData3D> expected = serialImporter->image3D(0, level);
+            Containers::Optional<Trade::ImageData3D> actual = importer->image3D(0, level);
+            CORRADE_VERIFY(expected);
+            CORRADE_VERIFY(actual);
+            CORRADE_COMPARE(actual->isCompressed(), expected->isCompressed());
+            CORRADE_COMPARE(actual->size(), expected->size());
+            CORRADE_COMPARE_AS(actual->data(), expected->data(),
+                TestSuite::Compare::Container);
+        }
+    }
+}
+
+void BasisImporterTest::cacheFormats() {
+    auto&& data = CacheData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> serialImporter = _manager.instantiate("BasisImporter");
+    if(data.hasMissingOrientationMetadata)
+        serialImporter->configuration().setValue("assumeYUp", true);
+    CORRADE_VERIFY(serialImporter->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-array-mips"_s + data.extension)));
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("BasisImporter");
+    importer->configuration().setValue("format", "Bc3RGBA");
+    /* Duplicates and HDR formats are ignored */
+    importer->configuration().setValue("cacheFormats", "  Etc2RGBA RGBA8\tBc6hRGB RGBA8 Bc3RGBA ");
+    importer->configuration().setValue("threads", data.threads);
+    importer->configuration().setValue("cacheSize", data.cacheSize);
+    if(data.hasMissingOrientationMetadata)
+        importer->configuration().setValue("assumeYUp", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-array-mips"_s + data.extension)));
+
+    for(UnsignedInt level: {1, 0}) {
+        for(const char* format: {"Bc3RGBA", "Etc2RGBA", "RGBA8"}) {
+            CORRADE_ITERATION(level << format);
+            serialImporter->configuration().setValue("format", format);
+            importer->configuration().setValue("format", format);
+
+            Containers::Optional<Trade::ImageData3D> expected = serialImporter->image3D(0, level);
+            Containers::Optional<Trade::ImageData3D> actual = importer->image3D(0, level);
+            CORRADE_VERIFY(expected);
+            CORRADE_VERIFY(actual);
+            CORRADE_COMPARE(actual->isCompressed(), expected->isCompressed());
+            CORRADE_COMPARE(actual->size(), expected->size());
+            CORRADE_COMPARE_AS(actual->data(), expected->data(),
+                TestSuite::Compare::Container);
+        }
+    }
+}
+
+void BasisImporterTest::cacheFormatsAllLevels() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("BasisImporter");
+    importer->configuration().setValue("format", "Bc3RGBA");
+    importer->configuration().setValue("cacheFormats", "RGBA8");
+    importer->configuration().setValue("cacheSize", 1024*1024);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba-array-mips.basis")));
+    CORRADE_COMPARE(importer->image3DLevelCount(0), 3);
+    importer->addFlags(ImporterFlag::Verbose);
+
+    /* Importing the first two levels in the first format transcodes each of
+       them, the second format for the first level shouldn't get discarded
+       when transcoding the second level */
+    for(UnsignedInt level: {0, 1}) {
+        CORRADE_ITERATION(level);
+        Containers::String out;
+        {
+            Debug redirectOutput{&out};
+            CORRADE_VERIFY(importer->image3D(0, level));
+        }
+        CORRADE_COMPARE(out, "");
+    }
+
+    /* The second format is then taken from the cache for both levels */
+    importer->configuration().setValue("format", "RGBA8");
+    for(UnsignedInt level: {0, 1}) {
+        CORRADE_ITERATION(level);
+        Containers::Optional<Trade::ImageData3D> image;
+        Containers::String out;
+        {
+            Debug redirectOutput{&out};
+            image = importer->image3D(0, level);
+        }
+        CORRADE_VERIFY(image);
+        CORRADE_VERIFY(!image->isCompressed());
+        CORRADE_COMPARE(out, Utility::format("Trade::BasisImporter::image3D(): level {} of image 0 taken from the cache\n", level));
+    }
+}
+
+void BasisImporterTest::cacheFormatsInvalid() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("BasisImporterRGBA8");
+    importer->configuration().setValue("cacheFormats", "Bc1RGB Bc7RGB");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(BASISIMPORTER_TEST_DIR, "rgba.basis")));
+
+    Containers::String out;
+    {
+        Error redirectError{&out};
+        CORRADE_VERIFY(!importer->image2D(0));
+    }
+    CORRADE_COMPARE(out, "Trade::BasisImporter::image2D(): invalid transcoding target format Bc7RGB in the cacheFormats option, expected one of Etc1RGB, Etc2RGBA, EacR, EacRG, Bc1RGB, Bc3RGBA, Bc4R, Bc5RG, Bc7RGBA, Pvrtc1RGB4bpp, Pvrtc1RGBA4bpp, Astc4x4RGBA or RGBA8 for LDR images or Bc6hRGB, Astc4x4RGBAF, RGB16F or RGBA16F for HDR images\n");
+}
+
 void BasisImporterTest::flipUncompressed() {
     auto& data = FlipUncompressedData[testCaseInstanceId()];
     setTestCaseDescription(data.name);
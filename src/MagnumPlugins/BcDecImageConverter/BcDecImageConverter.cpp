@@ -33,6 +33,8 @@
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/threadsAndCache.h"
+
 #define BCDEC_IMPLEMENTATION
 #include "bcdec.h"
 
@@ -42,19 +44,27 @@ using namespace Containers::Literals;
 
 BcDecImageConverter::BcDecImageConverter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin): AbstractImageConverter{manager, plugin} {}
 
-ImageConverterFeatures BcDecImageConverter::doFeatures() const { return ImageConverterFeature::ConvertCompressed2D; }
+ImageConverterFeatures BcDecImageConverter::doFeatures() const { return ImageConverterFeature::ConvertCompressed2D|ImageConverterFeature::ConvertCompressed3D; }
 
 namespace {
 
-template<void(*decodeBlock)(const void*, void*, int)> void decodeBlocks(const Containers::StridedArrayView2D<const char>& src, const Containers::StridedArrayView2D<char>& dst) {
-    const std::size_t yBlocks = src.size()[0];
-    const std::size_t xBlocks = src.size()[1];
-    CORRADE_INTERNAL_ASSERT(dst.size()[0] == yBlocks*4 &&
-                            dst.size()[1] == xBlocks*4);
-    const std::size_t dstRowStride = dst.stride()[0];
-    for(std::size_t y = 0; y != yBlocks; ++y)
+template<void(*decodeBlock)(const void*, void*, int)> void decodeBlocks(const Containers::StridedArrayView3D<const char>& src, const Containers::StridedArrayView3D<char>& dst, const UnsignedInt threadCount) {
+    const std::size_t zBlocks = src.size()[0];
+    const std::size_t yBlocks = src.size()[1];
+    const std::size_t xBlocks = src.size()[2];
+    CORRADE_INTERNAL_ASSERT(dst.size()[0] == zBlocks &&
+                            dst.size()[1] == yBlocks*4 &&
+                            dst.size()[2] == xBlocks*4);
+    const std::size_t dstRowStride = dst.stride()[1];
+
+    /* Every thread, including the calling one, picks the next undecoded
+       block row from all rows of all slices until there's none left */
+    Implementation::parallelFor(threadCount, zBlocks*yBlocks, [&](const std::size_t blockRow) {
+        const std::size_t z = blockRow/yBlocks;
+        const std::size_t y = blockRow%yBlocks;
         for(std::size_t x = 0; x != xBlocks; ++x)
-            decodeBlock(&src[{y, x}], &dst[{y*4, x*4}], dstRowStride);
+            decodeBlock(&src[{z, y, x}], &dst[{z, y*4, x*4}], dstRowStride);
+    });
 }
 
 /* To make bcdec_bc6h_float() / bcdec_bc6h_half() the same signature as the
@@ -65,10 +75,12 @@ template<void(*decodeBlock)(const void*, void*, int, int), bool isSigned, int ty
     decodeBlock(src, dst, rowStride/typeSize, isSigned);
 }
 
-}
+Containers::Optional<ImageData3D> convertInternal(const CompressedImageView3D& image, const Utility::ConfigurationGroup& configuration) {
+    const bool bc6hToFloat = configuration.value<bool>("bc6hToFloat");
 
-Containers::Optional<ImageData2D> BcDecImageConverter::doConvert(const CompressedImageView2D& image) {
-    const bool bc6hToFloat = configuration().value<bool>("bc6hToFloat");
+    /* Value of 0 means all hardware threads, 1 means decoding serially in the
+       calling thread */
+    const UnsignedInt threadCount = Implementation::threadCount(configuration.value<UnsignedInt>("threads"));
 
     /* Decide on target pixel format */
     PixelFormat format;
@@ -116,20 +128,25 @@ Containers::Optional<ImageData2D> BcDecImageConverter::doConvert(const Compresse
     CORRADE_INTERNAL_ASSERT(compressedPixelFormatBlockSize(image.format()) == (Vector3i{blockSize, 1}));
 
     /* Allocate output data. For simplicity make them contain the full 4x4
-       blocks with an appropriate row length set. That way, if the actual used
-       size isn't whole blocks, the extra unused pixels at the end of each row
-       and at/or the end of the image are treated as padding without having
-       to do a lot of special casing in the decoding loop. */
-    const Vector2i blockCount = ((image.size() + blockSize - Vector2i{1})/blockSize);
+       blocks with an appropriate row length and image height set. That way, if
+       the actual used size isn't whole blocks, the extra unused pixels at the
+       end of each row and at/or the end of each slice are treated as padding
+       without having to do a lot of special casing in the decoding loop.
+       Slices of 3D images are decoded independently, as the block depth is
+       always 1. */
+    const Vector2i blockCount = ((image.size().xy() + blockSize - Vector2i{1})/blockSize);
     const Vector2i sizeInWholeBlocks = blockSize*blockCount;
+    const std::size_t sliceCount = image.size().z();
     const UnsignedInt pixelSize = pixelFormatSize(format);
-    Trade::ImageData2D out{
+    Trade::ImageData3D out{
         /* Since it's always 4-pixel-wide blocks, the alignment can stay at the
            default of 4 */
-        PixelStorage{}.setRowLength(sizeInWholeBlocks.x()),
+        PixelStorage{}
+            .setRowLength(sizeInWholeBlocks.x())
+            .setImageHeight(sizeInWholeBlocks.y()),
         format,
         image.size(),
-        Containers::Array<char>{NoInit, std::size_t(pixelSize*sizeInWholeBlocks.product())},
+        Containers::Array<char>{NoInit, std::size_t(pixelSize*sizeInWholeBlocks.product())*sliceCount},
         image.flags()};
 
     /* Build the source block view and destination pixel view */
@@ -139,58 +156,62 @@ Containers::Optional<ImageData2D> BcDecImageConverter::doConvert(const Compresse
         return {};
     }
     const UnsignedInt blockDataSize = compressedPixelFormatBlockDataSize(image.format());
-    const Containers::StridedArrayView2D<const char> src{
+    const Containers::StridedArrayView3D<const char> src{
         image.data(),
-        {std::size_t(blockCount.y()), std::size_t(blockCount.x())},
-        {std::ptrdiff_t(blockCount.x()*blockDataSize), std::ptrdiff_t(blockDataSize)}
+        {sliceCount, std::size_t(blockCount.y()), std::size_t(blockCount.x())},
+        {std::ptrdiff_t(blockCount.product()*blockDataSize),
+         std::ptrdiff_t(blockCount.x()*blockDataSize),
+         std::ptrdiff_t(blockDataSize)}
     };
     /* Can't use pixels() here because the pixel view may not be whole
        blocks */
-    const Containers::StridedArrayView2D<char> dst{
+    const Containers::StridedArrayView3D<char> dst{
         out.mutableData(),
-        {std::size_t(sizeInWholeBlocks.y()),
+        {sliceCount,
+         std::size_t(sizeInWholeBlocks.y()),
          std::size_t(sizeInWholeBlocks.x())},
-        {std::ptrdiff_t(sizeInWholeBlocks.x()*pixelSize),
+        {std::ptrdiff_t(sizeInWholeBlocks.product()*pixelSize),
+         std::ptrdiff_t(sizeInWholeBlocks.x()*pixelSize),
          std::ptrdiff_t(pixelSize)}
     };
 
-    /* Decode block-by-block */
+    /* Decode block-by-block, possibly in multiple threads */
     switch(image.format()) {
         case CompressedPixelFormat::Bc1RGBUnorm:
         case CompressedPixelFormat::Bc1RGBAUnorm:
         case CompressedPixelFormat::Bc1RGBSrgb:
         case CompressedPixelFormat::Bc1RGBASrgb:
-            decodeBlocks<bcdec_bc1>(src, dst);
+            decodeBlocks<bcdec_bc1>(src, dst, threadCount);
             break;
         case CompressedPixelFormat::Bc2RGBAUnorm:
         case CompressedPixelFormat::Bc2RGBASrgb:
-            decodeBlocks<bcdec_bc2>(src, dst);
+            decodeBlocks<bcdec_bc2>(src, dst, threadCount);
             break;
         case CompressedPixelFormat::Bc3RGBAUnorm:
         case CompressedPixelFormat::Bc3RGBASrgb:
-            decodeBlocks<bcdec_bc3>(src, dst);
+            decodeBlocks<bcdec_bc3>(src, dst, threadCount);
             break;
         case CompressedPixelFormat::Bc4RUnorm:
         case CompressedPixelFormat::Bc4RSnorm:
-            decodeBlocks<bcdec_bc4>(src, dst);
+            decodeBlocks<bcdec_bc4>(src, dst, threadCount);
             break;
         case CompressedPixelFormat::Bc5RGUnorm:
         case CompressedPixelFormat::Bc5RGSnorm:
-            decodeBlocks<bcdec_bc5>(src, dst);
+            decodeBlocks<bcdec_bc5>(src, dst, threadCount);
             break;
         case CompressedPixelFormat::Bc6hRGBUfloat:
             bc6hToFloat ?
-                decodeBlocks<decodeBc6hBlock<bcdec_bc6h_float, false, 4>>(src, dst) :
-                decodeBlocks<decodeBc6hBlock<bcdec_bc6h_half, false, 2>>(src, dst);
+                decodeBlocks<decodeBc6hBlock<bcdec_bc6h_float, false, 4>>(src, dst, threadCount) :
+                decodeBlocks<decodeBc6hBlock<bcdec_bc6h_half, false, 2>>(src, dst, threadCount);
             break;
         case CompressedPixelFormat::Bc6hRGBSfloat:
             bc6hToFloat ?
-                decodeBlocks<decodeBc6hBlock<bcdec_bc6h_float, true, 4>>(src, dst) :
-                decodeBlocks<decodeBc6hBlock<bcdec_bc6h_half, true, 2>>(src, dst);
+                decodeBlocks<decodeBc6hBlock<bcdec_bc6h_float, true, 4>>(src, dst, threadCount) :
+                decodeBlocks<decodeBc6hBlock<bcdec_bc6h_half, true, 2>>(src, dst, threadCount);
             break;
         case CompressedPixelFormat::Bc7RGBAUnorm:
         case CompressedPixelFormat::Bc7RGBASrgb:
-            decodeBlocks<bcdec_bc7>(src, dst);
+            decodeBlocks<bcdec_bc7>(src, dst, threadCount);
             break;
         /* Unsupported formats already handled above */
         default: CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
@@ -200,6 +221,26 @@ Containers::Optional<ImageData2D> BcDecImageConverter::doConvert(const Compresse
     return Containers::optional(Utility::move(out));
 }
 
+}
+
+Containers::Optional<ImageData2D> BcDecImageConverter::doConvert(const CompressedImageView2D& image) {
+    /* The flags are restored on the output, 2D flags have a different meaning
+       than 3D so don't pass them through */
+    Containers::Optional<ImageData3D> out = convertInternal(CompressedImageView3D{image.storage(), image.format(), {image.size(), 1}, image.data()}, configuration());
+    if(!out)
+        return {};
+
+    /* The image height is only relevant for 3D images, reset it back */
+    CORRADE_INTERNAL_ASSERT(out->size().z() == 1);
+    const PixelStorage storage = PixelStorage{out->storage()}.setImageHeight(0);
+    const PixelFormat format = out->format();
+    return ImageData2D{storage, format, image.size(), out->release(), image.flags()};
+}
+
+Containers::Optional<ImageData3D> BcDecImageConverter::doConvert(const CompressedImageView3D& image) {
+    return convertInternal(image, configuration());
+}
+
 }}
 
 CORRADE_PLUGIN_REGISTER(BcDecImageConverter, Magnum::Trade::BcDecImageConverter,
@@ -147,8 +147,22 @@ whole blocks, @ref PixelStorage::setRowLength() is set to treat the extra
 pixels at the end of each row as padding. Non-default @ref CompressedPixelStorage
 isn't supported in input images.
 
-Only 2D image conversion is supported at the moment. Image flags, if any, are
-passed through unchanged.
+Both 2D and 3D images are supported, including 2D array and cube map images.
+Slices of 3D images are decoded independently. For 3D output,
+@ref PixelStorage::setImageHeight() is always set to the height rounded up to
+whole blocks, so if the height isn't whole blocks, the extra rows at the end of
+each slice are treated as padding. 2D output has it left at the default.
+Image flags, if any, are passed through unchanged.
+
+@subsection Trade-BcDecImageConverter-behavior-multithreading Multithreaded decoding
+
+By default the blocks are decoded serially in the calling thread. Setting the
+@cb{.ini} threads @ce @ref Trade-BcDecImageConverter-configuration "configuration option"
+to a value other than @cpp 1 @ce distributes rows of blocks of all slices
+among given count of threads, with @cpp 0 @ce using all hardware threads.
+
+On Linux, using more than one thread requires the application to be linked
+to `pthread`, see @ref cmake-plugins-threads for details.
 
 @section Trade-BcDecImageConverter-configuration Plugin-specific configuration
 
@@ -169,6 +183,7 @@ class MAGNUM_BCDECIMAGECONVERTER_EXPORT BcDecImageConverter: public AbstractImag
         MAGNUM_BCDECIMAGECONVERTER_LOCAL ImageConverterFeatures doFeatures() const override;
 
         MAGNUM_BCDECIMAGECONVERTER_LOCAL Containers::Optional<ImageData2D> doConvert(const CompressedImageView2D& image) override;
+        MAGNUM_BCDECIMAGECONVERTER_LOCAL Containers::Optional<ImageData3D> doConvert(const CompressedImageView3D& image) override;
 };
 
 }}
@@ -35,6 +35,7 @@
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Endianness.h>
 #include <Corrade/Utility/Debug.h>
+#include <Corrade/Utility/Path.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Math/ColorBatch.h>
 #include <Magnum/Math/Functions.h>
@@ -47,6 +48,8 @@
 #include <Magnum/Trade/TextureData.h>
 #endif
 
+#include "Magnum/Implementation/mapFile.h"
+
 namespace Magnum { namespace Trade {
 
 using namespace Containers::Literals;
@@ -232,7 +235,15 @@ constexpr struct {
 }
 
 struct DdsImporter::File {
-    Containers::Array<char> in;
+    /* Owned or externally owned file data if opened with openData() or
+       openMemory() */
+    Containers::Array<char> data;
+    /* Used instead of the above if the file was opened with openFile() */
+    #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+    Containers::Array<const char, Utility::Path::MapDeleter> mappedData;
+    #endif
+    /* Points to one of the above */
+    Containers::ArrayView<const char> in;
 
     /* Size of one top-level slice. As it's used as an input for level size
        calculation, it doesn't take sliceCount into account. */
@@ -306,14 +317,37 @@ Containers::Triple<std::size_t, std::size_t, Vector3i> levelOffsetSize(Vector3i
 
 }
 
+#if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+void DdsImporter::doOpenFile(const Containers::StringView filename) {
+    /* Instead of reading the whole file into memory, map it. If no flipping
+       or swizzling is needed, only the parts of the file that get imported
+       are then loaded by the OS, and with the zeroCopy option not even
+       copied. */
+    Implementation::openMappedFile(filename, [&]() {
+        AbstractImporter::doOpenFile(filename);
+    }, [&](Containers::Array<const char, Utility::Path::MapDeleter>&& mapped) {
+        Containers::Pointer<File> f{new File};
+        f->mappedData = Utility::move(mapped);
+        f->in = f->mappedData;
+        openInternal(Utility::move(f));
+    });
+}
+#endif
+
 void DdsImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dataFlags) {
     Containers::Pointer<File> f{new File};
 
     /* Take over the existing array or copy the data if we can't */
     if(dataFlags & (DataFlag::Owned|DataFlag::ExternallyOwned))
-        f->in = Utility::move(data);
+        f->data = Utility::move(data);
     else
-        f->in = Containers::Array<char>{InPlaceInit, data};
+        f->data = Containers::Array<char>{InPlaceInit, data};
+    f->in = f->data;
+
+    openInternal(Utility::move(f));
+}
+
+void DdsImporter::openInternal(Containers::Pointer<File>&& f) {
 
     /* Read in DDS header */
     if(f->in.size() < sizeof(DdsHeader)) {
@@ -792,6 +826,24 @@ template<UnsignedInt dimensions> ImageData<dimensions> DdsImporter::doImage(cons
         imageSize[dimensions - 1] = _f->sliceCount;
     }
 
+    /* If the data don't need any processing and all slices of the level are
+       next to each other in the file, which is the case if there's just one
+       slice or just one level, return a view on the file data if enabled */
+    if(configuration().value<bool>("zeroCopy") && !_f->yzFlip.any() &&
+       (_f->compressed || !_f->properties.uncompressed.needsSwizzle) &&
+       (_f->sliceCount == 1 || _f->levelCount == 1))
+    {
+        const Containers::ArrayView<const char> data = _f->in.sliceSize(_f->dataOffset + offsetSize.first(), offsetSize.second()*_f->sliceCount);
+
+        if(_f->compressed)
+            return ImageData<dimensions>{_f->properties.compressed.format, Math::Vector<dimensions, Int>::pad(imageSize), DataFlags{}, data, ImageFlag<dimensions>(UnsignedShort(_f->imageFlags))};
+
+        PixelStorage storage;
+        if((imageSize.x()*_f->properties.uncompressed.pixelSize % 4 != 0))
+            storage.setAlignment(1);
+        return ImageData<dimensions>{storage, _f->properties.uncompressed.format, Math::Vector<dimensions, Int>::pad(imageSize), DataFlags{}, data, ImageFlag<dimensions>(UnsignedShort(_f->imageFlags))};
+    }
+
     /* Allocate image data */
     Containers::Array<char> data{NoInit, offsetSize.second()*_f->sliceCount};
 
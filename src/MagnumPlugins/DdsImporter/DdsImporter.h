@@ -240,6 +240,29 @@ Packed formats, (planar) YUV / YCbCr video formats,
 and @m_class{m-doc-external} [R10G10B10_XR_BIAS_A2_UNORM](https://docs.microsoft.com/en-us/windows/win32/api/dxgiformat/ne-dxgiformat-dxgi_format)
 are not supported.
 
+@subsection Trade-DdsImporter-behavior-zero-copy Memory-mapped opening and zero-copy import
+
+Files opened with @ref openFile() are memory-mapped instead of being read into
+memory. The mapping is kept for as long as the file is opened, the file thus
+shouldn't be modified in the meantime. On
+@ref CORRADE_TARGET_EMSCRIPTEN "Emscripten" and
+@ref CORRADE_TARGET_WINDOWS_RT "Windows RT", where memory mapping isn't
+available, or if @ref setFileCallback() "file callbacks" are used, the whole
+file is read into memory instead.
+
+By default, each imported image is a copy of the file data. Enabling the
+@cb{.ini} zeroCopy @ce @ref Trade-DdsImporter-configuration "configuration option"
+makes images that don't need any Y / Z flipping or BGR(A) swizzling returned
+as non-owning read-only views on the file data instead, with
+@ref ImageData::dataFlags() being empty. That's the case for example for
+compressed and RGBA files with @cb{.ini} assumeYUpZBackward @ce enabled. The
+views are valid only as long as the file stays opened. Additionally, array
+images and cube maps with multiple levels store each layer or face with its
+whole mip chain together, so the layers or faces of a single level aren't
+next to each other in the file. These are thus always copied. Together with
+memory-mapped files, this means only the parts of the file that get accessed
+are loaded by the operating system.
+
 @section Trade-DdsImporter-configuration Plugin-specific configuration
 
 It's possible to tune various import options through @ref configuration(). See
@@ -261,6 +284,11 @@ class MAGNUM_DDSIMPORTER_EXPORT DdsImporter: public AbstractImporter {
         MAGNUM_DDSIMPORTER_LOCAL ImporterFeatures doFeatures() const override;
         MAGNUM_DDSIMPORTER_LOCAL bool doIsOpened() const override;
         MAGNUM_DDSIMPORTER_LOCAL void doClose() override;
+        /* Memory mapping isn't available on Emscripten and WinRT, the base
+           implementation that reads the file is used there instead */
+        #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+        MAGNUM_DDSIMPORTER_LOCAL void doOpenFile(Containers::StringView filename) override;
+        #endif
         MAGNUM_DDSIMPORTER_LOCAL void doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) override;
 
         template<UnsignedInt dimensions> MAGNUM_DDSIMPORTER_LOCAL ImageData<dimensions> doImage(const char* messagePrefix, UnsignedInt id, UnsignedInt level);
@@ -283,6 +311,9 @@ class MAGNUM_DDSIMPORTER_EXPORT DdsImporter: public AbstractImporter {
         #endif
 
         struct File;
+
+        MAGNUM_DDSIMPORTER_LOCAL void openInternal(Containers::Pointer<File>&& f);
+
         Containers::Pointer<File> _f;
 };
 
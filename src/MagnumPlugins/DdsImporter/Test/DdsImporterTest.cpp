@@ -97,6 +97,9 @@ struct DdsImporterTest: TestSuite::Tester {
     void compressedFormatFlip();
     void compressedFormatFlip3D();
 
+    void zeroCopy();
+    void zeroCopyOpenMemory();
+
     void openMemory();
     void openTwice();
     void importTwice();
@@ -521,6 +524,25 @@ const struct {
         "dxt10-bc7-3d.dds", ImporterFlag::Verbose, true, false, false, nullptr},
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt dimensions;
+    bool assumeYUpZBackward;
+    bool expectZeroCopy;
+} ZeroCopyData[]{
+    {"compressed", "dxt3.dds", 2, true, true},
+    {"compressed, Y flip", "dxt3.dds", 2, false, false},
+    {"BGR swizzle", "bgr8unorm.dds", 2, true, false},
+    {"mips", "dxt10-r32i-mips.dds", 2, true, true},
+    {"cube map", "dxt10-r16f-cube.dds", 3, true, true},
+    {"cube map, mips", "dxt1-cube-mips.dds", 3, true, false},
+    {"array", "dxt10-rgba8unorm-array.dds", 3, true, true},
+    {"cube map array", "dxt10-r8snorm-cube-array.dds", 3, true, true},
+    /* Layers of a single level aren't next to each other in the file */
+    {"array, mips", "dxt10-rg16f-1d-array-mips.dds", 2, true, false},
+};
+
 /* Shared among all plugins that implement data copying optimizations */
 const struct {
     const char* name;
@@ -589,6 +611,11 @@ DdsImporterTest::DdsImporterTest() {
     addInstancedTests({&DdsImporterTest::compressedFormatFlip3D},
         Containers::arraySize(CompressedFormatFlip3DData));
 
+    addInstancedTests({&DdsImporterTest::zeroCopy},
+        Containers::arraySize(ZeroCopyData));
+
+    addTests({&DdsImporterTest::zeroCopyOpenMemory});
+
     addInstancedTests({&DdsImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
@@ -1681,6 +1708,73 @@ void DdsImporterTest::compressedFormatFlip3D() {
     }
 }
 
+void DdsImporterTest::zeroCopy() {
+    auto&& data = ZeroCopyData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Reference output with the data copied */
+    Containers::Pointer<AbstractImporter> reference = _manager.instantiate("DdsImporter");
+    reference->addFlags(ImporterFlag::Quiet);
+    reference->configuration().setValue("assumeYUpZBackward", data.assumeYUpZBackward);
+    CORRADE_VERIFY(reference->openFile(Utility::Path::join(DDSIMPORTER_TEST_DIR, data.filename)));
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DdsImporter");
+    importer->addFlags(ImporterFlag::Quiet);
+    importer->configuration().setValue("assumeYUpZBackward", data.assumeYUpZBackward);
+    importer->configuration().setValue("zeroCopy", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DDSIMPORTER_TEST_DIR, data.filename)));
+
+    const DataFlags expectedDataFlags = data.expectZeroCopy ? DataFlags{} : DataFlag::Owned|DataFlag::Mutable;
+
+    if(data.dimensions == 2) {
+        CORRADE_COMPARE(importer->image2DLevelCount(0), reference->image2DLevelCount(0));
+        for(UnsignedInt i = 0; i != importer->image2DLevelCount(0); ++i) {
+            CORRADE_ITERATION(i);
+            Containers::Optional<ImageData2D> image = importer->image2D(0, i);
+            Containers::Optional<ImageData2D> expected = reference->image2D(0, i);
+            CORRADE_VERIFY(image);
+            CORRADE_VERIFY(expected);
+            CORRADE_COMPARE(image->dataFlags(), expectedDataFlags);
+            CORRADE_COMPARE(image->flags(), expected->flags());
+            CORRADE_COMPARE(image->size(), expected->size());
+            CORRADE_COMPARE_AS(image->data(), expected->data(),
+                TestSuite::Compare::Container);
+        }
+    } else if(data.dimensions == 3) {
+        CORRADE_COMPARE(importer->image3DLevelCount(0), reference->image3DLevelCount(0));
+        for(UnsignedInt i = 0; i != importer->image3DLevelCount(0); ++i) {
+            CORRADE_ITERATION(i);
+            Containers::Optional<ImageData3D> image = importer->image3D(0, i);
+            Containers::Optional<ImageData3D> expected = reference->image3D(0, i);
+            CORRADE_VERIFY(image);
+            CORRADE_VERIFY(expected);
+            CORRADE_COMPARE(image->dataFlags(), expectedDataFlags);
+            CORRADE_COMPARE(image->flags(), expected->flags());
+            CORRADE_COMPARE(image->size(), expected->size());
+            CORRADE_COMPARE_AS(image->data(), expected->data(),
+                TestSuite::Compare::Container);
+        }
+    } else CORRADE_INTERNAL_ASSERT_UNREACHABLE();
+}
+
+void DdsImporterTest::zeroCopyOpenMemory() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DdsImporter");
+    importer->configuration().setValue("assumeYUpZBackward", true);
+    importer->configuration().setValue("zeroCopy", true);
+    Containers::Optional<Containers::Array<char>> memory = Utility::Path::read(Utility::Path::join(DDSIMPORTER_TEST_DIR, "dxt1.dds"));
+    CORRADE_VERIFY(memory);
+    CORRADE_VERIFY(importer->openMemory(*memory));
+
+    /* The image should point directly into the memory, right after the 128
+       byte header */
+    Containers::Optional<ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->dataFlags(), DataFlags{});
+    CORRADE_COMPARE(image->compressedFormat(), CompressedPixelFormat::Bc1RGBAUnorm);
+    CORRADE_COMPARE(image->data().data(), memory->data() + 128);
+    CORRADE_COMPARE(image->data().size(), 8);
+}
+
 void DdsImporterTest::openMemory() {
     /* compared to dxt3() uses openData() & openMemory() instead of openFile()
        to test data copying on import, and a deliberately small file */
@@ -27,6 +27,7 @@
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
@@ -44,7 +45,10 @@ struct EtcDecImageConverterTest: TestSuite::Tester {
     explicit EtcDecImageConverterTest();
 
     void test();
+    void threeDimensions();
+    void threads();
     void preserveFlags();
+    void preserveFlags3D();
 
     void unsupportedFormat();
     void unsupportedStorage();
@@ -118,11 +122,40 @@ const struct {
         true, {}, {}, {}, 17.0f, 1.62f},
 };
 
+const struct {
+    const char* name;
+    CompressedPixelFormat format;
+    Vector3i size;
+    UnsignedInt threads;
+} ThreadsData[]{
+    {"2D, 2 threads", CompressedPixelFormat::Etc2RGBA8Unorm, {63, 27, 1}, 2},
+    {"2D, all hardware threads", CompressedPixelFormat::Etc2RGBA8Unorm, {63, 27, 1}, 0},
+    {"3D, 3 threads", CompressedPixelFormat::Etc2RGBA8Unorm, {37, 21, 5}, 3},
+    {"3D, more threads than block rows", CompressedPixelFormat::EacRG11Snorm, {16, 7, 2}, 16},
+};
+
+/* Pseudo-random block data, just so the decoded output isn't uniform */
+Containers::Array<char> blockData(std::size_t size) {
+    Containers::Array<char> out{NoInit, size};
+    UnsignedInt state = 0x1234567u;
+    for(char& i: out) {
+        state = state*1103515245u + 12345u;
+        i = char(state >> 16);
+    }
+    return out;
+}
+
 EtcDecImageConverterTest::EtcDecImageConverterTest() {
     addInstancedTests({&EtcDecImageConverterTest::test},
         Containers::arraySize(TestData));
 
+    addTests({&EtcDecImageConverterTest::threeDimensions});
+
+    addInstancedTests({&EtcDecImageConverterTest::threads},
+        Containers::arraySize(ThreadsData));
+
     addTests({&EtcDecImageConverterTest::preserveFlags,
+              &EtcDecImageConverterTest::preserveFlags3D,
 
               &EtcDecImageConverterTest::unsupportedFormat,
               &EtcDecImageConverterTest::unsupportedStorage});
@@ -221,6 +254,71 @@ void EtcDecImageConverterTest::preserveFlags() {
     CORRADE_COMPARE(converted->flags(), ImageFlag2D::Array);
 }
 
+void EtcDecImageConverterTest::threeDimensions() {
+    Containers::Pointer<AbstractImageConverter> converter = _manager.instantiate("EtcDecImageConverter");
+
+    /* Three slices with 4x3 blocks each, the last row and column incomplete */
+    const Containers::Array<char> data = blockData(3*4*3*16);
+    Containers::Optional<ImageData3D> converted = converter->convert(CompressedImageView3D{CompressedPixelFormat::Etc2RGBA8Unorm, {15, 10, 3}, data, ImageFlag3D::Array});
+    CORRADE_VERIFY(converted);
+    CORRADE_VERIFY(!converted->isCompressed());
+    CORRADE_COMPARE(converted->format(), PixelFormat::RGBA8Unorm);
+    CORRADE_COMPARE(converted->size(), (Vector3i{15, 10, 3}));
+    CORRADE_COMPARE(converted->flags(), ImageFlag3D::Array);
+    /* The padding is whole blocks in both dimensions */
+    CORRADE_COMPARE(converted->storage().rowLength(), 16);
+    CORRADE_COMPARE(converted->storage().imageHeight(), 12);
+
+    /* Each slice should be the same as when decoding it as a 2D image */
+    const std::size_t sliceDataSize = 4*3*16;
+    const std::size_t slicePixelDataSize = 16*12*4;
+    CORRADE_COMPARE(converted->data().size(), 3*slicePixelDataSize);
+    for(std::size_t i = 0; i != 3; ++i) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<ImageData2D> slice = converter->convert(CompressedImageView2D{CompressedPixelFormat::Etc2RGBA8Unorm, {15, 10}, data.sliceSize(i*sliceDataSize, sliceDataSize)});
+        CORRADE_VERIFY(slice);
+        CORRADE_COMPARE(slice->storage().rowLength(), 16);
+        CORRADE_COMPARE(slice->storage().imageHeight(), 0);
+        CORRADE_COMPARE_AS(converted->data().sliceSize(i*slicePixelDataSize, slicePixelDataSize),
+            slice->data(),
+            TestSuite::Compare::Container);
+    }
+}
+
+void EtcDecImageConverterTest::threads() {
+    auto&& data = ThreadsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const Vector3i blockCount{(data.size.xy() + Vector2i{3})/4, data.size.z()};
+    const Containers::Array<char> input = blockData(blockCount.product()*compressedPixelFormatBlockDataSize(data.format));
+    const CompressedImageView3D image{data.format, data.size, input};
+
+    Containers::Pointer<AbstractImageConverter> converter = _manager.instantiate("EtcDecImageConverter");
+    Containers::Optional<ImageData3D> expected = converter->convert(image);
+    CORRADE_VERIFY(expected);
+
+    converter->configuration().setValue("threads", data.threads);
+    Containers::Optional<ImageData3D> converted = converter->convert(image);
+    CORRADE_VERIFY(converted);
+    CORRADE_COMPARE(converted->format(), expected->format());
+    CORRADE_COMPARE(converted->size(), data.size);
+
+    /* The output should be exactly the same as when decoding serially,
+       including the padding */
+    CORRADE_COMPARE_AS(converted->data(),
+        expected->data(),
+        TestSuite::Compare::Container);
+}
+
+void EtcDecImageConverterTest::preserveFlags3D() {
+    Containers::Pointer<AbstractImageConverter> converter = _manager.instantiate("EtcDecImageConverter");
+
+    /* Same as preserveFlags(), but for 3D */
+    Containers::Optional<ImageData3D> converted = converter->convert(CompressedImageView3D{CompressedPixelFormat::EacR11Snorm, {1, 1, 1}, "yeyhey!", ImageFlag3D::CubeMap});
+    CORRADE_VERIFY(converted);
+    CORRADE_COMPARE(converted->flags(), ImageFlag3D::CubeMap);
+}
+
 void EtcDecImageConverterTest::unsupportedFormat() {
     Containers::Pointer<AbstractImageConverter> converter = _manager.instantiate("EtcDecImageConverter");
 
@@ -27,10 +27,13 @@
 
 #include "IcoImporter.h"
 
+#include <cstring>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StringView.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/Endianness.h>
+#include <Magnum/Math/ConfigurationValue.h>
 #include <Magnum/Trade/ImageData.h>
 
 namespace Magnum { namespace Trade {
@@ -61,12 +64,18 @@ struct IconDirEntry {
     UnsignedInt imageDataOffset;
 };
 
+struct Level {
+    Containers::ArrayView<const char> data;
+    /* Taken from the embedded PNG header if present, as the directory can't
+       represent sizes over 256 */
+    Vector2i size;
+};
+
 }
 
 struct IcoImporter::State {
-    Containers::Pointer<Trade::AbstractImporter> pngImporter;
     Containers::Array<char> data;
-    Containers::Array<Containers::ArrayView<const char>> levels;
+    Containers::Array<Level> levels;
 };
 
 #ifdef MAGNUM_BUILD_DEPRECATED
@@ -87,6 +96,13 @@ namespace {
     constexpr const char PngHeader[] {
         '\x89', 'P', 'N', 'G', '\x0d', '\x0a', '\x1a', '\x0a'
     };
+
+    /* Signature, IHDR chunk length and type, width and height */
+    constexpr std::size_t PngSizeEnd = sizeof(PngHeader) + 8 + 8;
+
+    bool isPng(const Containers::ArrayView<const char> data) {
+        return data.size() >= sizeof(PngHeader) && std::memcmp(data.data(), PngHeader, sizeof(PngHeader)) == 0;
+    }
 }
 
 void IcoImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dataFlags) {
@@ -99,7 +115,7 @@ void IcoImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dat
     Utility::Endianness::littleEndianInPlace(header.imageType, header.imageCount);
 
     Containers::Pointer<State> state{InPlaceInit};
-    state->levels = Containers::Array<Containers::ArrayView<const char>>{header.imageCount};
+    state->levels = Containers::Array<Level>{header.imageCount};
 
     /* Take over the existing array or copy the data if we can't */
     if(dataFlags & (DataFlag::Owned|DataFlag::ExternallyOwned))
@@ -116,7 +132,7 @@ void IcoImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dat
 
         IconDirEntry iconDirEntry = *reinterpret_cast<const IconDirEntry*>(state->data.begin() + iconDirEntryOffset);
         /* The other fields need endian swapping as well, but we don't use them
-           so it's not necessary */
+           so it's not necessary. The width and height are single bytes. */
         Utility::Endianness::littleEndianInPlace(
             iconDirEntry.imageDataSize,
             iconDirEntry.imageDataOffset
@@ -127,7 +143,22 @@ void IcoImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dat
             return;
         }
 
-        state->levels[i] = state->data.slice(iconDirEntry.imageDataOffset, iconDirEntry.imageDataOffset + iconDirEntry.imageDataSize);
+        Level& level = state->levels[i];
+        level.data = state->data.slice(iconDirEntry.imageDataOffset, iconDirEntry.imageDataOffset + iconDirEntry.imageDataSize);
+
+        /* Remember the level size so the nearest size can be picked without
+           decoding anything. For embedded PNGs read it from the IHDR chunk,
+           which has to be first, otherwise use the directory entry, where 0
+           means 256. */
+        if(isPng(level.data) && level.data.size() >= PngSizeEnd && std::memcmp(level.data.data() + sizeof(PngHeader) + 4, "IHDR", 4) == 0) {
+            UnsignedInt size[2];
+            std::memcpy(size, level.data.data() + sizeof(PngHeader) + 8, sizeof(size));
+            level.size = {Int(Utility::Endianness::bigEndian(size[0])),
+                          Int(Utility::Endianness::bigEndian(size[1]))};
+        } else level.size = {
+            iconDirEntry.imageWidth ? iconDirEntry.imageWidth : 256,
+            iconDirEntry.imageHeight ? iconDirEntry.imageHeight : 256
+        };
     }
 
     /* All good, save the state */
@@ -136,28 +167,69 @@ void IcoImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dat
 
 UnsignedInt IcoImporter::doImage2DCount() const { return 1; }
 
-UnsignedInt IcoImporter::doImage2DLevelCount(UnsignedInt) { return _state->levels.size(); }
+std::size_t IcoImporter::nearestSizeLevel() const {
+    /* Not cached on opening, so it can be changed without having to open the
+       file again */
+    const Vector2i preferredSize = configuration().value<Vector2i>("nearestSize");
+    if(preferredSize.isZero())
+        return ~std::size_t{};
+
+    /* Pick the smallest icon that's at least as large as the preferred size
+       in both dimensions, so it only ever gets scaled down. If there's none,
+       pick the largest icon. If there are multiple icons of the same size,
+       the first one wins. */
+    std::size_t smallestLarger = ~std::size_t{};
+    std::size_t largest = ~std::size_t{};
+    for(std::size_t i = 0; i != _state->levels.size(); ++i) {
+        const Vector2i size = _state->levels[i].size;
+        if((size >= preferredSize).all() && (smallestLarger == ~std::size_t{} || size.product() < _state->levels[smallestLarger].size.product()))
+            smallestLarger = i;
+        if(largest == ~std::size_t{} || size.product() > _state->levels[largest].size.product())
+            largest = i;
+    }
+
+    return smallestLarger != ~std::size_t{} ? smallestLarger : largest;
+}
+
+UnsignedInt IcoImporter::doImage2DLevelCount(UnsignedInt) {
+    /* With a nearest size picked, only the picked level is exposed */
+    if(nearestSizeLevel() != ~std::size_t{})
+        return 1;
 
-Containers::Optional<ImageData2D> IcoImporter::doImage2D(UnsignedInt, UnsignedInt level) {
-    if(_state->levels[level].size() < sizeof(PngHeader) || std::memcmp(_state->levels[level].data(), PngHeader, sizeof(PngHeader)) != 0) {
+    return _state->levels.size();
+}
+
+Containers::Optional<ImageData2D> IcoImporter::doImage2D(UnsignedInt, const UnsignedInt level) {
+    const std::size_t nearestLevel = nearestSizeLevel();
+    const Containers::ArrayView<const char> data = _state->levels[nearestLevel != ~std::size_t{} ? nearestLevel : level].data;
+    if(!isPng(data)) {
         Error{} << "Trade::IcoImporter::image2D(): only files with embedded PNGs are supported";
         return Containers::NullOpt;
     }
 
-    /* just delegate actual image importing */
-    if(!_state->pngImporter && !(_state->pngImporter = manager()->loadAndInstantiate("PngImporter"))) {
+    /* Just delegate actual image importing. The delegate is kept across
+       files, so opening many files doesn't instantiate a new importer for
+       each. */
+    if(!_pngImporter && !(_pngImporter = manager()->loadAndInstantiate("PngImporter"))) {
         Error{} << "Trade::IcoImporter::image2D(): PngImporter is not available";
         return Containers::NullOpt;
     }
 
-    /* Note: this is uncovered by the tests because neither StbImageImporter
-       nor PngImporter / DevIlImageImporter do any checks apart that could be
-       triggered here. In the best case openData() checks PNG header, but that
-       we do above already, so it can't be hit again here. */
-    if(!_state->pngImporter->openData(_state->levels[level]))
+    /* The embedded PNG is opened as memory to avoid the delegate making a copy
+       of it, and closed right after so it doesn't reference our data after
+       the file gets closed.
+
+       Note: the failure is uncovered by the tests because neither
+       StbImageImporter nor PngImporter / DevIlImageImporter do any checks
+       apart that could be triggered here. In the best case openData() checks
+       PNG header, but that we do above already, so it can't be hit again
+       here. */
+    if(!_pngImporter->openMemory(data))
         return Containers::NullOpt;
 
-    return _state->pngImporter->image2D(0);
+    Containers::Optional<ImageData2D> image = _pngImporter->image2D(0);
+    _pngImporter->close();
+    return image;
 }
 
 }}
@@ -110,6 +110,31 @@ Currently, only embedded PNGs are supported --- for them it will delegate
 loading to any plugin that provides `PngImporter`; for images that are BMPs,
 @ref image2D() will fail. You can use @ref DevIlImageImporter in that case
 instead, but please @ref Trade-DevIlImageImporter-behavior-ico "be aware of its limitations".
+
+Opening a file only parses the icon directory, together with the image size
+from the header of each embedded PNG, and each image is decoded only when
+requested. The delegate importer is instantiated on first use and reused for
+all images and all files opened with the same importer instance.
+
+@subsection Trade-IcoImporter-behavior-nearest-size Picking the nearest size
+
+Setting the @cb{.ini} nearestSize @ce
+@ref Trade-IcoImporter-configuration "configuration option" makes the importer
+expose only the icon nearest to given size as a single level, without decoding
+any other icons. The smallest icon that's at least as large as given size in
+both dimensions is picked, or the largest icon if there's none. With multiple
+icons of the same size, the first one is picked. The option can be changed
+after the file is opened.
+
+@section Trade-IcoImporter-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration(). See
+below for all options and their default values:
+
+@snippet MagnumPlugins/IcoImporter/IcoImporter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_ICOIMPORTER_EXPORT IcoImporter: public AbstractImporter {
     public:
@@ -138,8 +163,11 @@ class MAGNUM_ICOIMPORTER_EXPORT IcoImporter: public AbstractImporter {
         MAGNUM_ICOIMPORTER_LOCAL UnsignedInt doImage2DLevelCount(UnsignedInt id) override;
         MAGNUM_ICOIMPORTER_LOCAL Containers::Optional<ImageData2D> doImage2D(UnsignedInt id, UnsignedInt level) override;
 
+        MAGNUM_ICOIMPORTER_LOCAL std::size_t nearestSizeLevel() const;
+
         struct State;
         Containers::Pointer<State> _state;
+        Containers::Pointer<AbstractImporter> _pngImporter;
 };
 
 }}
@@ -31,10 +31,12 @@
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Math/Color.h>
+#include <Magnum/Math/ConfigurationValue.h>
 #include <Magnum/Trade/AbstractImporter.h>
 #include <Magnum/Trade/ImageData.h>
 
@@ -51,6 +53,7 @@ struct IcoImporterTest: TestSuite::Tester {
 
     void bmp();
     void png();
+    void nearestSize();
 
     void openMemory();
     void openTwice();
@@ -73,6 +76,21 @@ const struct {
         "image too short, expected at least 974 bytes but got 973"}
 };
 
+using namespace Math::Literals;
+
+const struct {
+    const char* name;
+    Vector2i nearestSize;
+    Vector2i expectedSize;
+    Color3ub expectedColor;
+} NearestSizeData[]{
+    {"exact match", {16, 8}, {16, 8}, 0x00ff00_rgb},
+    {"smaller than all", {4, 4}, {16, 8}, 0x00ff00_rgb},
+    {"between", {20, 20}, {32, 64}, 0xff0000_rgb},
+    {"one dimension too large", {40, 40}, {256, 256}, 0x0000ff_rgb},
+    {"larger than all", {512, 512}, {256, 256}, 0x0000ff_rgb},
+};
+
 /* Shared among all plugins that implement data copying optimizations */
 const struct {
     const char* name;
@@ -98,6 +116,9 @@ IcoImporterTest::IcoImporterTest() {
               &IcoImporterTest::bmp,
               &IcoImporterTest::png});
 
+    addInstancedTests({&IcoImporterTest::nearestSize},
+        Containers::arraySize(NearestSizeData));
+
     addInstancedTests({&IcoImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
@@ -114,8 +135,6 @@ IcoImporterTest::IcoImporterTest() {
     #endif
 }
 
-using namespace Math::Literals;
-
 void IcoImporterTest::tooShort() {
     auto&& data = TooShortData[testCaseInstanceId()];
     setTestCaseDescription(data.name);
@@ -229,6 +248,29 @@ void IcoImporterTest::png() {
     }
 }
 
+void IcoImporterTest::nearestSize() {
+    auto&& data = NearestSizeData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("IcoImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(ICOIMPORTER_TEST_DIR, "pngs.ico")));
+    CORRADE_COMPARE(importer->image2DLevelCount(0), 3);
+
+    /* The option can be set after opening, only one level is exposed then */
+    importer->configuration().setValue("nearestSize", data.nearestSize);
+    CORRADE_COMPARE(importer->image2DLevelCount(0), 1);
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->format(), PixelFormat::RGB8Unorm);
+    CORRADE_COMPARE(image->size(), data.expectedSize);
+    CORRADE_COMPARE(image->pixels<Color3ub>()[0][0], data.expectedColor);
+
+    /* Resetting it exposes all levels again */
+    importer->configuration().setValue("nearestSize", "");
+    CORRADE_COMPARE(importer->image2DLevelCount(0), 3);
+}
+
 void IcoImporterTest::openMemory() {
     /* same as (a subset of) png() except that it uses openData() &
        openMemory() instead of openFile() to test data copying on import */
@@ -69,6 +69,10 @@ using namespace Containers::Literals;
 #ifdef MAGNUM_BUILD_DEPRECATED /* LCOV_EXCL_START */
 JpegImageConverter::JpegImageConverter() {
     configuration().setValue("jpegQuality", 0.8f);
+    configuration().setValue("chromaSubsampling", "420");
+    configuration().setValue("optimizeHuffman", false);
+    configuration().setValue("progressive", false);
+    configuration().setValue("dctMethod", "islow");
 }
 #endif /* LCOV_EXCL_STOP */
 
@@ -117,6 +121,35 @@ Containers::Optional<Containers::Array<char>> JpegImageConverter::doConvertToDat
             return {};
     }
 
+    /* Check configuration options before any libjpeg state is created. The
+       chroma subsampling is expressed through sampling factors of the luma
+       component, relative to the chroma components which stay at 1x1. */
+    const Containers::StringView chromaSubsampling = configuration().value<Containers::StringView>("chromaSubsampling");
+    Vector2i lumaSamplingFactor;
+    if(chromaSubsampling == "444"_s)
+        lumaSamplingFactor = {1, 1};
+    else if(chromaSubsampling == "422"_s)
+        lumaSamplingFactor = {2, 1};
+    else if(chromaSubsampling == "420"_s)
+        lumaSamplingFactor = {2, 2};
+    else {
+        Error{} << "Trade::JpegImageConverter::convertToData(): expected chromaSubsampling to be one of 444, 422 or 420 but got" << chromaSubsampling;
+        return {};
+    }
+
+    const Containers::StringView dctMethodString = configuration().value<Containers::StringView>("dctMethod");
+    J_DCT_METHOD dctMethod;
+    if(dctMethodString == "islow"_s)
+        dctMethod = JDCT_ISLOW;
+    else if(dctMethodString == "ifast"_s)
+        dctMethod = JDCT_IFAST;
+    else if(dctMethodString == "float"_s)
+        dctMethod = JDCT_FLOAT;
+    else {
+        Error{} << "Trade::JpegImageConverter::convertToData(): expected dctMethod to be one of islow, ifast or float but got" << dctMethodString;
+        return {};
+    }
+
     /* Initialize structures. Needs to be before the setjmp crap in order to
        avoid leaks on error. */
     jpeg_compress_struct info;
@@ -181,6 +214,17 @@ Containers::Optional<Containers::Array<char>> JpegImageConverter::doConvertToDat
 
     jpeg_set_defaults(&info);
     jpeg_set_quality(&info, Int(configuration().value<Float>("jpegQuality")*100.0f), boolean(true));
+
+    /* Grayscale images have just one component, nothing to subsample there */
+    if(info.jpeg_color_space == JCS_YCbCr) {
+        info.comp_info[0].h_samp_factor = lumaSamplingFactor.x();
+        info.comp_info[0].v_samp_factor = lumaSamplingFactor.y();
+    }
+    info.dct_method = dctMethod;
+    info.optimize_coding = boolean(configuration().value<bool>("optimizeHuffman"));
+    /* The progressive mode forces optimized Huffman tables on its own */
+    if(configuration().value<bool>("progressive"))
+        jpeg_simple_progression(&info);
     jpeg_start_compress(&info, boolean(true));
 
     /* Write rows in reverse order. While the rows may have some padding after,
@@ -142,6 +142,32 @@ implementations:
 -   [MozJPEG](https://github.com/mozilla/mozjpeg), optimized for quality/size
     ratio, though generally much slower than libjpeg-turbo
 
+@subsection Trade-JpegImageConverter-behavior-speed-size Encoding speed and output size
+
+Apart from @cb{.ini} jpegQuality @ce, the
+@ref Trade-JpegImageConverter-configuration "configuration options" allow
+trading encoding speed for output size:
+
+-   @cb{.ini} chromaSubsampling @ce controls resolution of the chroma
+    channels in RGB images. The default, @cpp 420 @ce, is the fastest and
+    produces the smallest files, @cpp 444 @ce preserves color detail such as
+    in text or sharp colored edges.
+-   @cb{.ini} optimizeHuffman @ce computes Huffman tables optimal for the
+    image, which usually makes the output a few percent smaller at the cost
+    of an extra pass over the data.
+-   @cb{.ini} progressive @ce writes a progressive file, which is usually
+    even smaller but significantly slower to both encode and decode.
+-   @cb{.ini} dctMethod @ce selects the DCT implementation. The @cpp ifast @ce
+    method is the fastest but slightly less accurate, especially at high
+    quality settings.
+
+For live streaming, the fastest combination is @cpp 420 @ce subsampling with
+the @cpp ifast @ce DCT method and neither Huffman optimization nor
+progressive output. For archival, progressive output with @cpp 444 @ce
+subsampling and the default @cpp islow @ce DCT gives the best quality/size
+ratio. The plugin test contains a benchmark comparing speed and output size
+of various combinations.
+
 @subsection Trade-JpegImageConverter-behavior-arithmetic-coding Arithmetic JPEG encoding
 
 Libjpeg has a switch to enable [arithmetic coding](https://en.wikipedia.org/wiki/Arithmetic_coding)
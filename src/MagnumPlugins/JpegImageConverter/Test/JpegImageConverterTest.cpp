@@ -25,8 +25,11 @@
 */
 
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringView.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Compare/StringToFile.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Format.h>
@@ -51,6 +54,8 @@
 
 namespace Magnum { namespace Trade { namespace Test { namespace {
 
+using namespace Containers::Literals;
+
 struct JpegImageConverterTest: TestSuite::Tester {
     explicit JpegImageConverterTest();
 
@@ -65,8 +70,18 @@ struct JpegImageConverterTest: TestSuite::Tester {
     void grayscale80Percent();
     void grayscale100Percent();
 
+    void options();
+    void optionsInvalid();
+
     void unsupportedMetadata();
 
+    void benchmarkEncode();
+    void benchmarkSize();
+    void benchmarkSizeBegin();
+    std::uint64_t benchmarkSizeEnd();
+
+    std::size_t _benchmarkOutputSize;
+
     /* Explicitly forbid system-wide plugin dependencies */
     PluginManager::Manager<AbstractImageConverter> _converterManager{"nonexistent"};
     PluginManager::Manager<AbstractImporter> _importerManager{"nonexistent"};
@@ -93,6 +108,81 @@ const struct {
         nullptr},
 };
 
+const struct {
+    const char* name;
+    const char* chromaSubsampling;
+    bool optimizeHuffman;
+    bool progressive;
+    const char* dctMethod;
+    char startOfFrame;
+    char lumaSamplingFactor;
+    bool smallerThanDefault;
+} OptionsData[]{
+    {"default", "420", false, false, "islow", '\xc0', '\x22', false},
+    {"4:2:2 subsampling", "422", false, false, "islow", '\xc0', '\x21', false},
+    {"4:4:4 subsampling", "444", false, false, "islow", '\xc0', '\x11', false},
+    {"optimized Huffman", "420", true, false, "islow", '\xc0', '\x22', true},
+    {"progressive", "420", false, true, "islow", '\xc2', '\x22', true},
+    {"progressive, 4:4:4 subsampling", "444", false, true, "islow", '\xc2', '\x11', true},
+    {"ifast DCT", "420", false, false, "ifast", '\xc0', '\x22', false},
+    {"float DCT", "420", false, false, "float", '\xc0', '\x22', false},
+};
+
+const struct {
+    const char* name;
+    const char* option;
+    const char* value;
+    const char* message;
+} OptionsInvalidData[]{
+    {"chroma subsampling", "chromaSubsampling", "411",
+        "expected chromaSubsampling to be one of 444, 422 or 420 but got 411"},
+    {"DCT method", "dctMethod", "fastest",
+        "expected dctMethod to be one of islow, ifast or float but got fastest"},
+};
+
+const struct {
+    const char* name;
+    Float quality;
+    const char* chromaSubsampling;
+    bool optimizeHuffman;
+    bool progressive;
+    const char* dctMethod;
+} BenchmarkData[]{
+    /* Input is 6 MB, divide by the reported time to get MB/s */
+    {"default", 0.8f, "420", false, false, "islow"},
+    {"ifast DCT", 0.8f, "420", false, false, "ifast"},
+    {"float DCT", 0.8f, "420", false, false, "float"},
+    {"optimized Huffman", 0.8f, "420", true, false, "islow"},
+    {"progressive", 0.8f, "420", false, true, "islow"},
+    {"4:2:2 subsampling", 0.8f, "422", false, false, "islow"},
+    {"4:4:4 subsampling", 0.8f, "444", false, false, "islow"},
+    {"4:4:4 subsampling, optimized Huffman", 0.8f, "444", true, false, "islow"},
+    {"4:4:4 subsampling, progressive", 0.8f, "444", false, true, "islow"},
+    {"95% quality, 4:4:4 subsampling, progressive", 0.95f, "444", false, true, "islow"},
+    {"95% quality, ifast DCT", 0.95f, "420", false, false, "ifast"},
+};
+
+/* Smooth gradients with a bit of noise and a few flat-colored rectangles,
+   roughly resembling a photo with some overlaid UI */
+Containers::Array<char> benchmarkImage(const Vector2i& size) {
+    Containers::Array<char> out{NoInit, std::size_t(size.product())*3};
+    UnsignedInt noise = 0x1234567u;
+    std::size_t i = 0;
+    for(Int y = 0; y != size.y(); ++y) {
+        for(Int x = 0; x != size.x(); ++x) {
+            noise = noise*1103515245u + 12345u;
+            const bool rectangle = (x/64 + y/48) % 7 == 0;
+            for(Int c = 0; c != 3; ++c) {
+                if(rectangle)
+                    out[i++] = char(0x20*(c + 2));
+                else
+                    out[i++] = char((x*(c + 1)*255/size.x() + y*(3 - c)*255/size.y())/3 + ((noise >> (16 + 4*c)) & 0x0f));
+            }
+        }
+    }
+    return out;
+}
+
 JpegImageConverterTest::JpegImageConverterTest() {
     addTests({&JpegImageConverterTest::wrongFormat,
               &JpegImageConverterTest::conversionError,
@@ -106,9 +196,24 @@ JpegImageConverterTest::JpegImageConverterTest() {
     addTests({&JpegImageConverterTest::grayscale80Percent,
               &JpegImageConverterTest::grayscale100Percent});
 
+    addInstancedTests({&JpegImageConverterTest::options},
+        Containers::arraySize(OptionsData));
+
+    addInstancedTests({&JpegImageConverterTest::optionsInvalid},
+        Containers::arraySize(OptionsInvalidData));
+
     addInstancedTests({&JpegImageConverterTest::unsupportedMetadata},
         Containers::arraySize(UnsupportedMetadataData));
 
+    addInstancedBenchmarks({&JpegImageConverterTest::benchmarkEncode}, 5,
+        Containers::arraySize(BenchmarkData), BenchmarkType::WallTime);
+
+    addCustomInstancedBenchmarks({&JpegImageConverterTest::benchmarkSize}, 1,
+        Containers::arraySize(BenchmarkData),
+        &JpegImageConverterTest::benchmarkSizeBegin,
+        &JpegImageConverterTest::benchmarkSizeEnd,
+        BenchmarkUnits::Bytes);
+
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
     #ifdef JPEGIMAGECONVERTER_PLUGIN_FILENAME
@@ -407,6 +512,68 @@ void JpegImageConverterTest::grayscale100Percent() {
         (DebugTools::CompareImage{1.0f, 0.085f}));
 }
 
+void JpegImageConverterTest::options() {
+    auto&& data = OptionsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("JpegImageConverter");
+    Containers::Optional<Containers::Array<char>> defaultData = converter->convertToData(OriginalRgb);
+    CORRADE_VERIFY(defaultData);
+
+    converter->configuration().setValue("chromaSubsampling", data.chromaSubsampling);
+    converter->configuration().setValue("optimizeHuffman", data.optimizeHuffman);
+    converter->configuration().setValue("progressive", data.progressive);
+    converter->configuration().setValue("dctMethod", data.dctMethod);
+    Containers::Optional<Containers::Array<char>> out = converter->convertToData(OriginalRgb);
+    CORRADE_VERIFY(out);
+
+    /* Baseline or progressive start of frame marker. It's before any
+       entropy-coded data and the tables before it don't contain such a byte
+       sequence for this image, so the first occurence is the marker. */
+    const Containers::StringView string = *out;
+    const Containers::StringView startOfFrame = string.find(data.progressive ? "\xff\xc2"_s : "\xff\xc0"_s);
+    CORRADE_VERIFY(startOfFrame);
+    CORRADE_COMPARE_AS(string.suffix(startOfFrame.begin()).size(), 18,
+        TestSuite::Compare::GreaterOrEqual);
+    CORRADE_COMPARE(startOfFrame.begin()[1], data.startOfFrame);
+
+    /* Component count, then ID, sampling factors and quantization table
+       index for each. Only luma has the sampling factors different from 1x1,
+       as that's how the subsampling is expressed. */
+    CORRADE_COMPARE(Int(startOfFrame.begin()[9]), 3);
+    CORRADE_COMPARE(startOfFrame.begin()[11], data.lumaSamplingFactor);
+    CORRADE_COMPARE(startOfFrame.begin()[14], '\x11');
+    CORRADE_COMPARE(startOfFrame.begin()[17], '\x11');
+
+    if(data.smallerThanDefault)
+        CORRADE_COMPARE_AS(out->size(), defaultData->size(),
+            TestSuite::Compare::Less);
+
+    if(_importerManager.loadState("JpegImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("JpegImporter plugin not found, cannot test");
+
+    /* All variants should decode to roughly the original image */
+    Containers::Pointer<AbstractImporter> importer = _importerManager.instantiate("JpegImporter");
+    CORRADE_VERIFY(importer->openData(*out));
+    Containers::Optional<Trade::ImageData2D> converted = importer->image2D(0);
+    CORRADE_VERIFY(converted);
+    CORRADE_COMPARE_WITH(*converted, OriginalRgb,
+        (DebugTools::CompareImage{25.0f, 7.0f}));
+}
+
+void JpegImageConverterTest::optionsInvalid() {
+    auto&& data = OptionsInvalidData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("JpegImageConverter");
+    converter->configuration().setValue(data.option, data.value);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!converter->convertToData(OriginalRgb));
+    CORRADE_COMPARE(out, Utility::format("Trade::JpegImageConverter::convertToData(): {}\n", data.message));
+}
+
 void JpegImageConverterTest::unsupportedMetadata() {
     auto&& data = UnsupportedMetadataData[testCaseInstanceId()];
     setTestCaseDescription(data.name);
@@ -426,6 +593,60 @@ void JpegImageConverterTest::unsupportedMetadata() {
         CORRADE_COMPARE(out, Utility::format("Trade::JpegImageConverter::convertToData(): {}\n", data.message));
 }
 
+void JpegImageConverterTest::benchmarkEncode() {
+    auto&& data = BenchmarkData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const Vector2i size{2048, 1024};
+    const Containers::Array<char> imageData = benchmarkImage(size);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("JpegImageConverter");
+    converter->configuration().setValue("jpegQuality", data.quality);
+    converter->configuration().setValue("chromaSubsampling", data.chromaSubsampling);
+    converter->configuration().setValue("optimizeHuffman", data.optimizeHuffman);
+    converter->configuration().setValue("progressive", data.progressive);
+    converter->configuration().setValue("dctMethod", data.dctMethod);
+
+    Containers::Optional<Containers::Array<char>> out;
+    CORRADE_BENCHMARK(1)
+        out = converter->convertToData(ImageView2D{PixelFormat::RGB8Unorm, size, imageData});
+
+    CORRADE_VERIFY(out);
+}
+
+void JpegImageConverterTest::benchmarkSize() {
+    auto&& data = BenchmarkData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const Vector2i size{2048, 1024};
+    const Containers::Array<char> imageData = benchmarkImage(size);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("JpegImageConverter");
+    converter->configuration().setValue("jpegQuality", data.quality);
+    converter->configuration().setValue("chromaSubsampling", data.chromaSubsampling);
+    converter->configuration().setValue("optimizeHuffman", data.optimizeHuffman);
+    converter->configuration().setValue("progressive", data.progressive);
+    converter->configuration().setValue("dctMethod", data.dctMethod);
+
+    /* Not measuring time but the output size, reported by
+       benchmarkSizeEnd() */
+    Containers::Optional<Containers::Array<char>> out;
+    CORRADE_BENCHMARK(1) {
+        out = converter->convertToData(ImageView2D{PixelFormat::RGB8Unorm, size, imageData});
+        _benchmarkOutputSize = out ? out->size() : 0;
+    }
+
+    CORRADE_VERIFY(out);
+}
+
+void JpegImageConverterTest::benchmarkSizeBegin() {
+    _benchmarkOutputSize = 0;
+}
+
+std::uint64_t JpegImageConverterTest::benchmarkSizeEnd() {
+    return _benchmarkOutputSize;
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::Trade::Test::JpegImageConverterTest)
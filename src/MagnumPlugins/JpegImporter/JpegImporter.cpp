@@ -27,9 +27,15 @@
 #include "JpegImporter.h"
 
 #include <csetjmp>
+#include <cstring> /* std::memcpy() */
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringView.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/Trade/ImageData.h>
 
 #ifdef CORRADE_TARGET_WINDOWS
@@ -98,9 +104,37 @@ void JpegImporter::doOpenData(Containers::Array<char>&& data, const DataFlags da
 UnsignedInt JpegImporter::doImage2DCount() const { return 1; }
 
 Containers::Optional<ImageData2D> JpegImporter::doImage2D(UnsignedInt, UnsignedInt) {
-    /* Initialize structures */
+    /* Check configuration options first so there's no libjpeg state to clean
+       up on error */
+    const UnsignedInt scaleDenominator = configuration().value<UnsignedInt>("scaleDenominator");
+    if(scaleDenominator != 1 && scaleDenominator != 2 && scaleDenominator != 4 && scaleDenominator != 8) {
+        Error{} << "Trade::JpegImporter::image2D(): expected scaleDenominator to be 1, 2, 4 or 8 but got" << configuration().value<Containers::StringView>("scaleDenominator");
+        return {};
+    }
+    const UnsignedInt targetSize = configuration().value<UnsignedInt>("targetSize");
+
+    /* The crop rectangle is checked against the image size only after the
+       header is read */
+    const bool cropEnabled = !configuration().value<Containers::StringView>("crop").isEmpty();
+    Range2Di crop;
+    if(cropEnabled) {
+        #ifdef LIBJPEG_TURBO_VERSION_NUMBER
+        crop = configuration().value<Range2Di>("crop");
+        if(crop.sizeX() <= 0 || crop.sizeY() <= 0) {
+            Error{} << "Trade::JpegImporter::image2D(): expected a non-empty crop rectangle but got" << Debug::packed << crop;
+            return {};
+        }
+        #else
+        Error{} << "Trade::JpegImporter::image2D(): cropping is supported only with libjpeg-turbo";
+        return {};
+        #endif
+    }
+
+    /* Initialize structures. The arrays are declared here so std::longjmp()
+       from the error handler doesn't skip their destructors. */
     jpeg_decompress_struct file;
     Containers::Array<char> data;
+    Containers::Array<char> scratch;
 
     /* Fugly error handling stuff */
     /** @todo Get rid of this crap */
@@ -131,10 +165,28 @@ Containers::Optional<ImageData2D> JpegImporter::doImage2D(UnsignedInt, UnsignedI
        'boolean' for 2nd argument" (boolean is an enum instead of a typedef to
        int there) so doing the conversion implicitly. */
     jpeg_read_header(&file, boolean(true));
+
+    /* Decode at a reduced size in the DCT domain, if requested. With a target
+       size set, pick the largest denominator that still keeps the larger
+       dimension at least as big. Only power-of-two denominators up to 8 are
+       used as those are supported by all libjpeg implementations. */
+    UnsignedInt denominator = scaleDenominator;
+    if(targetSize) {
+        const UnsignedInt imageSize = Math::max(file.image_width, file.image_height);
+        denominator = 8;
+        while(denominator != 1 && (imageSize + denominator - 1)/denominator < targetSize)
+            denominator /= 2;
+
+        if(flags() & ImporterFlag::Verbose)
+            Debug{} << "Trade::JpegImporter::image2D(): decoding a" << file.image_width << Debug::nospace << "x" << Debug::nospace << file.image_height << "image at 1/" << Debug::nospace << denominator << "scale for a target size of" << targetSize;
+    }
+    file.scale_num = 1;
+    file.scale_denom = denominator;
+
     jpeg_start_decompress(&file);
 
     /* Image size and type */
-    const Vector2i size(file.output_width, file.output_height);
+    Vector2i size(file.output_width, file.output_height);
     static_assert(BITS_IN_JSAMPLE == 8, "Only 8-bit JPEG is supported");
 
     /* Image format */
@@ -158,18 +210,62 @@ Containers::Optional<ImageData2D> JpegImporter::doImage2D(UnsignedInt, UnsignedI
             return Containers::NullOpt;
     }
 
+    /* Decode only the crop rectangle, if requested. The rectangle is in the
+       output coordinates, i.e. after downscaling, and Y-up, so it has to be
+       flipped to match the top-down order of rows in the file. */
+    std::size_t cropOffset = 0;
+    #ifdef LIBJPEG_TURBO_VERSION_NUMBER
+    if(cropEnabled) {
+        if(crop.min().x() < 0 || crop.min().y() < 0 || crop.max().x() > size.x() || crop.max().y() > size.y()) {
+            Error{} << "Trade::JpegImporter::image2D(): crop rectangle" << Debug::packed << crop << "out of range for a" << Debug::packed << size << "image";
+            jpeg_abort_decompress(&file);
+            jpeg_destroy_decompress(&file);
+            return Containers::NullOpt;
+        }
+
+        /* The X offset gets aligned down to an iMCU boundary and the width
+           expanded accordingly. Remember where the actual crop starts in the
+           decoded rows. Rows above the rectangle are skipped without decoding
+           and rows below it are never read.
+
+           Fancy chroma upsampling treats the edges of the decoded region as
+           image edges, so if the crop starts or ends at an iMCU boundary, the
+           edge pixels would differ from a full decode. Including one more
+           pixel on each side, if there is any, makes the output match. */
+        JDIMENSION xOffset = Math::max(crop.min().x() - 1, 0);
+        JDIMENSION width = Math::min(crop.max().x() + 1, size.x()) - xOffset;
+        jpeg_crop_scanline(&file, &xOffset, &width);
+        cropOffset = (crop.min().x() - xOffset)*file.out_color_components;
+        jpeg_skip_scanlines(&file, size.y() - crop.max().y());
+        size = crop.size();
+    }
+    #endif
+
     /* Initialize data array, align rows to four bytes */
-    const std::size_t stride = ((size.x()*file.out_color_components*BITS_IN_JSAMPLE/8 + 3)/4)*4;
+    const std::size_t rowSize = size.x()*file.out_color_components*BITS_IN_JSAMPLE/8;
+    const std::size_t stride = ((rowSize + 3)/4)*4;
     data = Containers::Array<char>{stride*std::size_t(size.y())};
 
+    /* If the decoded rows are wider than the output because of the iMCU
+       alignment when cropping, decode to a scratch row first */
+    if(file.output_width != JDIMENSION(size.x()))
+        scratch = Containers::Array<char>{NoInit, file.output_width*file.out_color_components*BITS_IN_JSAMPLE/8};
+
     /* Read image row by row */
-    while(file.output_scanline < file.output_height) {
-        JSAMPROW row = reinterpret_cast<JSAMPROW>(data.data() + (size.y() - file.output_scanline - 1)*stride);
+    for(Int i = 0; i != size.y(); ++i) {
+        char* const out = data.data() + (size.y() - i - 1)*stride;
+        JSAMPROW row = reinterpret_cast<JSAMPROW>(scratch ? scratch.data() : out);
         jpeg_read_scanlines(&file, &row, 1);
+        if(scratch)
+            std::memcpy(out, scratch.data() + cropOffset, rowSize);
     }
 
-    /* Cleanup */
-    jpeg_finish_decompress(&file);
+    /* Cleanup. If cropping, the rows below the crop rectangle weren't read,
+       which jpeg_finish_decompress() would fail on. */
+    if(file.output_scanline == file.output_height)
+        jpeg_finish_decompress(&file);
+    else
+        jpeg_abort_decompress(&file);
     jpeg_destroy_decompress(&file);
 
     /* Always using the default 4-byte alignment */
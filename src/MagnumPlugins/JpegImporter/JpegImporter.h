@@ -117,11 +117,51 @@ The images are imported with @ref PixelFormat::RGB8Unorm or
 @ref PixelFormat::R8Unorm. All imported images use default @ref PixelStorage
 parameters.
 
+The importer recognizes @ref ImporterFlag::Verbose, printing additional info
+when the flag is enabled.
+
+@subsection Trade-JpegImporter-behavior-scaling Downscaled decoding
+
+By setting the @cb{.ini} scaleDenominator @ce
+@ref Trade-JpegImporter-configuration "configuration option" to
+@cpp 2 @ce, @cpp 4 @ce or @cpp 8 @ce, the image is decoded at half, quarter
+or eighth of its size directly in the DCT domain, which is significantly
+faster than decoding the image at full size and then downscaling it for
+example with @ref StbResizeImageConverter. The resulting size is rounded up.
+Alternatively, setting @cb{.ini} targetSize @ce picks the smallest of these
+scales that still keeps the larger image dimension at least as big as given
+value, which is useful for generating thumbnails. With
+@ref ImporterFlag::Verbose enabled, the picked scale is printed.
+
+@subsection Trade-JpegImporter-behavior-crop Cropped decoding
+
+When built against [libjpeg-turbo](https://libjpeg-turbo.org/), setting the
+@cb{.ini} crop @ce @ref Trade-JpegImporter-configuration "configuration option"
+decodes only given rectangle of the image, returning an image of the
+rectangle size. Only the iMCU columns overlapping the rectangle are
+decompressed, rows above it are skipped without performing inverse DCT and
+color conversion, and rows below it aren't processed at all, which saves
+both time and memory compared to decoding the whole image and slicing it
+afterwards. The output matches the corresponding part of a full decode. The
+rectangle is Y-up, consistently with how the images are imported, and is
+applied after the downscaling described above. With other libJPEG
+implementations the import fails if @cb{.ini} crop @ce is set.
+
 @subsection Trade-JpegImporter-behavior-implementations libJPEG implementations
 
 While some systems (such as macOS) still ship only with the vanilla libJPEG,
 you can get a much better decoding performance by using
 [libjpeg-turbo](https://libjpeg-turbo.org/).
+
+@section Trade-JpegImporter-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration().
+See below for all options and their default values:
+
+@snippet MagnumPlugins/JpegImporter/JpegImporter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_JPEGIMPORTER_EXPORT JpegImporter: public AbstractImporter {
     public:
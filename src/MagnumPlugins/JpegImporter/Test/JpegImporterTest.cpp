@@ -25,16 +25,31 @@
 */
 
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
+#include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Math/Vector3.h>
 #include <Magnum/Trade/AbstractImporter.h>
 #include <Magnum/Trade/ImageData.h>
 
 #include "configure.h"
 
+/* jpeglib.h is needed to query if cropping is supported (libjpeg-turbo). See
+   JpegImporter.cpp for details why the define below, and the <cstdio>
+   include, are needed. */
+#ifdef CORRADE_TARGET_WINDOWS
+#define XMD_H
+#endif
+#include <cstdio>
+#include <jpeglib.h>
+
 namespace Magnum { namespace Trade { namespace Test { namespace {
 
 struct JpegImporterTest: TestSuite::Tester {
@@ -47,6 +62,15 @@ struct JpegImporterTest: TestSuite::Tester {
     void rgb();
     void cmyk();
 
+    void scaleDenominator();
+    void scaleDenominatorInvalid();
+    void targetSize();
+
+    void crop();
+    void cropRgb();
+    void cropInvalid();
+    void cropNotSupported();
+
     void openMemory();
     void openTwice();
     void importTwice();
@@ -55,6 +79,68 @@ struct JpegImporterTest: TestSuite::Tester {
     PluginManager::Manager<AbstractImporter> _manager{"nonexistent"};
 };
 
+/* gray-blocks.jpg is a 32x16 grayscale image made of 8x8 blocks with values
+   10, 40, 70, 100 in the top row and 130, 160, 190, 220 in the bottom row,
+   saved with libjpeg at quality 100. As each block is constant, the
+   downscaled output is exact. */
+const struct {
+    const char* name;
+    UnsignedInt scaleDenominator;
+    Vector2i size;
+} ScaleDenominatorData[]{
+    {"1", 1, {32, 16}},
+    {"2", 2, {16, 8}},
+    {"4", 4, {8, 4}},
+    {"8", 8, {4, 2}},
+};
+
+const struct {
+    const char* name;
+    UnsignedInt targetSize;
+    Vector2i size;
+    const char* message;
+} TargetSizeData[]{
+    {"exactly one eighth", 4, {4, 2},
+        "Trade::JpegImporter::image2D(): decoding a 32x16 image at 1/8 scale for a target size of 4\n"},
+    {"slightly more than one eighth", 5, {8, 4},
+        "Trade::JpegImporter::image2D(): decoding a 32x16 image at 1/4 scale for a target size of 5\n"},
+    {"exactly half", 16, {16, 8},
+        "Trade::JpegImporter::image2D(): decoding a 32x16 image at 1/2 scale for a target size of 16\n"},
+    {"larger than the image", 100, {32, 16},
+        "Trade::JpegImporter::image2D(): decoding a 32x16 image at 1/1 scale for a target size of 100\n"},
+};
+
+const struct {
+    const char* name;
+    UnsignedInt scaleDenominator;
+    Range2Di crop;
+} CropData[]{
+    {"", 1, {{3, 2}, {29, 11}}},
+    {"aligned to blocks", 1, {{8, 0}, {24, 16}}},
+    {"single pixel", 1, {{31, 15}, {32, 16}}},
+    {"whole image", 1, {{0, 0}, {32, 16}}},
+    {"whole rows", 1, {{0, 3}, {32, 9}}},
+    {"downscaled", 2, {{3, 1}, {13, 7}}},
+};
+
+const struct {
+    const char* name;
+    UnsignedInt scaleDenominator;
+    const char* crop;
+    const char* message;
+} CropInvalidData[]{
+    {"empty", 1, "2 2 2 5",
+        "expected a non-empty crop rectangle but got {{2, 2}, {2, 5}}"},
+    {"negative size", 1, "2 5 4 3",
+        "expected a non-empty crop rectangle but got {{2, 5}, {4, 3}}"},
+    {"out of range", 1, "0 0 33 16",
+        "crop rectangle {{0, 0}, {33, 16}} out of range for a {32, 16} image"},
+    {"negative offset", 1, "0 -1 2 2",
+        "crop rectangle {{0, -1}, {2, 2}} out of range for a {32, 16} image"},
+    {"out of range after downscaling", 4, "0 0 8 5",
+        "crop rectangle {{0, 0}, {8, 5}} out of range for a {8, 4} image"},
+};
+
 /* Shared among all plugins that implement data copying optimizations */
 const struct {
     const char* name;
@@ -78,6 +164,24 @@ JpegImporterTest::JpegImporterTest() {
               &JpegImporterTest::rgb,
               &JpegImporterTest::cmyk});
 
+    addInstancedTests({&JpegImporterTest::scaleDenominator},
+        Containers::arraySize(ScaleDenominatorData));
+
+    addTests({&JpegImporterTest::scaleDenominatorInvalid});
+
+    addInstancedTests({&JpegImporterTest::targetSize},
+        Containers::arraySize(TargetSizeData));
+
+    addInstancedTests({&JpegImporterTest::crop},
+        Containers::arraySize(CropData));
+
+    addTests({&JpegImporterTest::cropRgb});
+
+    addInstancedTests({&JpegImporterTest::cropInvalid},
+        Containers::arraySize(CropInvalidData));
+
+    addTests({&JpegImporterTest::cropNotSupported});
+
     addInstancedTests({&JpegImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
@@ -180,6 +284,154 @@ void JpegImporterTest::cmyk() {
     CORRADE_COMPARE(out, "Trade::JpegImporter::image2D(): unsupported color space 4\n");
 }
 
+void JpegImporterTest::scaleDenominator() {
+    auto&& data = ScaleDenominatorData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    CORRADE_VERIFY(importer->configuration().setValue("scaleDenominator", data.scaleDenominator));
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "gray-blocks.jpg")));
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->size(), data.size);
+    CORRADE_COMPARE(image->format(), PixelFormat::R8Unorm);
+
+    /* Each pixel should have the value of the block it's in. The image is
+       Y-flipped, so the bottom row of blocks is first. */
+    Containers::StridedArrayView2D<const UnsignedByte> pixels = image->pixels<UnsignedByte>();
+    for(Int y = 0; y != data.size.y(); ++y) {
+        for(Int x = 0; x != data.size.x(); ++x) {
+            CORRADE_ITERATION(Vector2i{x, y});
+            const Int blockSize = 8/data.scaleDenominator;
+            const Int block = (1 - y/blockSize)*4 + x/blockSize;
+            CORRADE_COMPARE(Int(pixels[y][x]), 10 + 30*block);
+        }
+    }
+}
+
+void JpegImporterTest::scaleDenominatorInvalid() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    CORRADE_VERIFY(importer->configuration().setValue("scaleDenominator", 3));
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "gray-blocks.jpg")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, "Trade::JpegImporter::image2D(): expected scaleDenominator to be 1, 2, 4 or 8 but got 3\n");
+}
+
+void JpegImporterTest::targetSize() {
+    auto&& data = TargetSizeData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->addFlags(ImporterFlag::Verbose);
+    /* Should get ignored */
+    CORRADE_VERIFY(importer->configuration().setValue("scaleDenominator", 2));
+    CORRADE_VERIFY(importer->configuration().setValue("targetSize", data.targetSize));
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "gray-blocks.jpg")));
+
+    Containers::Optional<Trade::ImageData2D> image;
+    Containers::String out;
+    {
+        Debug redirectOutput{&out};
+        image = importer->image2D(0);
+    }
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->size(), data.size);
+    CORRADE_COMPARE(out, data.message);
+}
+
+void JpegImporterTest::crop() {
+    auto&& data = CropData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    #ifndef LIBJPEG_TURBO_VERSION_NUMBER
+    CORRADE_SKIP("Cropping is supported only with libjpeg-turbo.");
+    #endif
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    CORRADE_VERIFY(importer->configuration().setValue("scaleDenominator", data.scaleDenominator));
+    CORRADE_VERIFY(importer->configuration().setValue("crop", data.crop));
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "gray-blocks.jpg")));
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->size(), data.crop.size());
+    CORRADE_COMPARE(image->format(), PixelFormat::R8Unorm);
+
+    /* Each pixel should have the value of the block it's in, same as in
+       scaleDenominator() except that the coordinates are offset */
+    Containers::StridedArrayView2D<const UnsignedByte> pixels = image->pixels<UnsignedByte>();
+    for(Int y = 0; y != data.crop.sizeY(); ++y) {
+        for(Int x = 0; x != data.crop.sizeX(); ++x) {
+            CORRADE_ITERATION(Vector2i{x, y});
+            const Int blockSize = 8/data.scaleDenominator;
+            const Vector2i position = data.crop.min() + Vector2i{x, y};
+            const Int block = (1 - position.y()/blockSize)*4 + position.x()/blockSize;
+            CORRADE_COMPARE(Int(pixels[y][x]), 10 + 30*block);
+        }
+    }
+}
+
+void JpegImporterTest::cropRgb() {
+    #ifndef LIBJPEG_TURBO_VERSION_NUMBER
+    CORRADE_SKIP("Cropping is supported only with libjpeg-turbo.");
+    #endif
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "rgb.jpg")));
+
+    Containers::Optional<Trade::ImageData2D> full = importer->image2D(0);
+    CORRADE_VERIFY(full);
+
+    /* The cropped output should match the full decode exactly, including
+       chroma upsampling at the crop edges */
+    CORRADE_VERIFY(importer->configuration().setValue("crop", Range2Di{{1, 1}, {3, 2}}));
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->size(), (Vector2i{2, 1}));
+    CORRADE_COMPARE(image->format(), PixelFormat::RGB8Unorm);
+    CORRADE_COMPARE_AS(image->pixels<Vector3ub>()[0],
+        full->pixels<Vector3ub>()[1].exceptPrefix(1),
+        TestSuite::Compare::Container);
+}
+
+void JpegImporterTest::cropInvalid() {
+    auto&& data = CropInvalidData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    #ifndef LIBJPEG_TURBO_VERSION_NUMBER
+    CORRADE_SKIP("Cropping is supported only with libjpeg-turbo.");
+    #endif
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    CORRADE_VERIFY(importer->configuration().setValue("scaleDenominator", data.scaleDenominator));
+    importer->configuration().setValue("crop", data.crop);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "gray-blocks.jpg")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, Utility::format("Trade::JpegImporter::image2D(): {}\n", data.message));
+}
+
+void JpegImporterTest::cropNotSupported() {
+    #ifdef LIBJPEG_TURBO_VERSION_NUMBER
+    CORRADE_SKIP("Cropping is supported with libjpeg-turbo, can't test.");
+    #endif
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("crop", "0 0 1 1");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "gray-blocks.jpg")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, "Trade::JpegImporter::image2D(): cropping is supported only with libjpeg-turbo\n");
+}
+
 void JpegImporterTest::openMemory() {
     /* same as gray() except that it uses openData() & openMemory() instead of
        openFile() to test data copying on import */
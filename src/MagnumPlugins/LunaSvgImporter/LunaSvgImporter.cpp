@@ -26,8 +26,10 @@
 
 #include "LunaSvgImporter.h"
 
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StringView.h>
+#include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/PixelFormat.h>
@@ -36,6 +38,8 @@
 #include <Magnum/Math/Swizzle.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/threadsAndCache.h"
+
 #include <lunasvg.h>
 
 namespace Magnum { namespace Trade {
@@ -45,6 +49,11 @@ using namespace Containers::Literals;
 struct LunaSvgImporter::State {
     /* Ah yes I forgot how nasty STL is, ew */
     std::unique_ptr<lunasvg::Document> document;
+
+    /* Rasterized images kept for repeated imports, limited by the cacheSize
+       budget. The data are premultiplied BGRA, exactly as produced by
+       lunasvg::Document::render(). */
+    Implementation::ImageCache cache;
 };
 
 LunaSvgImporter::LunaSvgImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin) : AbstractImporter{manager, plugin} {}
@@ -79,7 +88,11 @@ UnsignedInt LunaSvgImporter::doImage2DCount() const {
     return 1;
 }
 
-Containers::Optional<ImageData2D> LunaSvgImporter::doImage2D(UnsignedInt, UnsignedInt) {
+UnsignedInt LunaSvgImporter::doImage2DLevelCount(UnsignedInt) {
+    return 1 + UnsignedInt(configuration().values<Float>("levelDpi").size());
+}
+
+Containers::Optional<ImageData2D> LunaSvgImporter::doImage2D(UnsignedInt, const UnsignedInt level) {
     /* The alpha mode can be changed for every image import, so do the checking
        here and not in doOpenData(). Also doing that before anything else so
        people don't just wait ages for doomed-to-fail import with large
@@ -92,8 +105,10 @@ Containers::Optional<ImageData2D> LunaSvgImporter::doImage2D(UnsignedInt, Unsign
 
     /* Use the configuration-provided DPI value to scale the image. Similarly
        to ResvgImporter, one has to manually scale the document and then supply
-       scaling via a matrix. I wonder which library got inspired from which. */
-    const Float scaling = configuration().value<Float>("dpi")/96.0f;
+       scaling via a matrix. I wonder which library got inspired from which.
+       Additional levels are the same parsed document just rendered with a
+       different scaling. */
+    const Float scaling = (level ? configuration().values<Float>("levelDpi")[level - 1] : configuration().value<Float>("dpi"))/96.0f;
     /* The rounding (and DPI being queried as a float) is verified in the
        load() test as well. */
     const Vector2i size{Int(Math::round(_state->document->width()*scaling)),
@@ -117,21 +132,27 @@ Containers::Optional<ImageData2D> LunaSvgImporter::doImage2D(UnsignedInt, Unsign
 
     /** @todo expose rendering of subnodes? is it useful for anything? */
 
-    /* Like resvg, this is *rendering into* a bitmap, so the memory needs to be
-       zero-initialized first. */
-    Containers::Array<char> data{ValueInit, std::size_t(size.product()*4)};
-    lunasvg::Bitmap bitmap{reinterpret_cast<std::uint8_t*>(data.data()), size.x(), size.y(), size.x()*4};
-    _state->document->render(bitmap, matrix);
+    /* If the image was rendered at the same scaling before and is still in
+       the cache, return a copy of it, otherwise render it */
+    Containers::Array<char> data = Implementation::renderCached(_state->cache, scaling, configuration().value<std::size_t>("cacheSize"), [&]() {
+        /* Like resvg, this is *rendering into* a bitmap, so the memory needs
+           to be zero-initialized first. */
+        Containers::Array<char> out{ValueInit, std::size_t(size.product()*4)};
+        lunasvg::Bitmap bitmap{reinterpret_cast<std::uint8_t*>(out.data()), size.x(), size.y(), size.x()*4};
+        _state->document->render(bitmap, matrix);
+        return out;
+    });
 
     /* LunaSVG produces a premultiplied BGRA output, unfortunately (and same as
        with ResvgImporter or PlutoSvgImporter) it doesn't correctly premultiply
        in sRGB. It provides an option to convert that to the usual
        unpremultiplied RGBA at least, which is nice. */
-    if(alphaMode == ""_s)
+    if(alphaMode == ""_s) {
         /** @todo maybe our own batch algorithm in Math/ColorBatch.h would be
             faster once it exists */
+        lunasvg::Bitmap bitmap{reinterpret_cast<std::uint8_t*>(data.data()), size.x(), size.y(), size.x()*4};
         bitmap.convertToRGBA();
-    else if(alphaMode == "premultipliedLinear"_s)
+    } else if(alphaMode == "premultipliedLinear"_s)
         /** @todo use a batch algorithm in Math/ColorBatch.h once it exists */
         for(Color4ub& i: Containers::arrayCast<Color4ub>(data))
             i = Math::gather<'b', 'g', 'r', 'a'>(i);
@@ -133,6 +133,22 @@ are supported only if the image file is embedded. External references are
 silently ignored without any error or warning. SVGZ files are not supported,
 use the @ref ResvgImporter plugin instead.
 
+@subsection Trade-LunaSvgImporter-behavior-levels Rasterizing at multiple sizes
+
+The file is parsed just once on opening and the @cb{.ini} dpi @ce option is
+used only at import time, so it can be changed to rasterize the already parsed
+file at a different size without having to open it again. Alternatively, add
+one or more @cb{.ini} levelDpi @ce
+@ref Trade-LunaSvgImporter-configuration "configuration options". Each of them
+is then exposed as an additional image level, with @ref image2DLevelCount()
+reflecting the count.
+
+Setting the @cb{.ini} cacheSize @ce option to a non-zero value keeps rasterized
+images in a cache up to given total size in bytes, with least recently used
+images being discarded first. Repeated imports at the same DPI then only make a
+copy of the cached data instead of rasterizing again. The cache is discarded
+when the file is closed.
+
 @section Trade-LunaSvgImporter-configuration Plugin-specific configuration
 
 It's possible to tune various import options through @ref configuration(). See
@@ -157,6 +173,7 @@ class MAGNUM_LUNASVGIMPORTER_EXPORT LunaSvgImporter: public AbstractImporter {
         MAGNUM_LUNASVGIMPORTER_LOCAL void doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) override;
 
         MAGNUM_LUNASVGIMPORTER_LOCAL UnsignedInt doImage2DCount() const override;
+        MAGNUM_LUNASVGIMPORTER_LOCAL UnsignedInt doImage2DLevelCount(UnsignedInt id) override;
         MAGNUM_LUNASVGIMPORTER_LOCAL Containers::Optional<ImageData2D> doImage2D(UnsignedInt id, UnsignedInt level) override;
 
         struct State;
@@ -26,7 +26,6 @@
 
 #include "OpenExrImporter.h"
 
-#include <thread> /* std::thread::hardware_concurrency(), sigh */
 #include <Corrade/Containers/BitArray.h>
 #include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
@@ -34,8 +33,14 @@
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/DebugStl.h> /** @todo remove once Configuration is <string>-free */
+#include <Corrade/Utility/Path.h>
 #include <Magnum/Trade/ImageData.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+
+#include "Magnum/Implementation/threadsAndCache.h"
 
 /* OpenEXR as a CMake subproject adds the OpenEXR/ directory to include path
    but not the parent directory, so we can't #include <OpenEXR/blah>. This
@@ -141,8 +146,16 @@ class MemoryIStream: public Imf::IStream {
 
 struct OpenExrImporter::State {
     explicit State(Containers::Array<char>&& data): data{Utility::move(data)}, stream{this->data} {}
+    #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+    explicit State(Containers::Array<const char, Utility::Path::MapDeleter>&& mappedData): mappedData{Utility::move(mappedData)}, stream{this->mappedData} {}
+    #endif
 
     Containers::Array<char> data;
+    /* Used instead of the above if the file was opened with openFile(). Only
+       the pages that OpenEXR actually reads from get loaded by the OS. */
+    #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+    Containers::Array<const char, Utility::Path::MapDeleter> mappedData;
+    #endif
     MemoryIStream stream;
     /* There's always just one or the other so ideally this should be in some
        sort of a union, but those are rather small (16 bytes) so it doesn't
@@ -163,6 +176,45 @@ bool OpenExrImporter::doIsOpened() const { return !!_state; }
 
 void OpenExrImporter::doClose() { _state = nullptr; }
 
+#if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+void OpenExrImporter::doOpenFile(const Containers::StringView filename) {
+    /* Files that don't exist can't be mapped, delegate to the base
+       implementation for those so there's just the usual error message and
+       not two of them */
+    if(!Utility::Path::exists(filename))
+        return AbstractImporter::doOpenFile(filename);
+
+    /* If the size can't be queried, the function already printed a message */
+    const Containers::Optional<std::size_t> size = Utility::Path::size(filename);
+    if(!size)
+        return;
+
+    /* Empty files can't be mapped on some platforms, read those the usual way
+       as well to get a consistent error message from OpenEXR. */
+    if(!*size)
+        return AbstractImporter::doOpenFile(filename);
+
+    #if OPENEXR_VERSION_MAJOR*10000 + OPENEXR_VERSION_MINOR*100 + OPENEXR_VERSION_PATCH >= 30300 && OPENEXR_VERSION_MAJOR*10000 + OPENEXR_VERSION_MINOR*100 + OPENEXR_VERSION_PATCH < 30303
+    /* Small files need the 4096-byte workaround described in doOpenData(),
+       which means a copy, so read those the usual way. Mapping them wouldn't
+       bring any advantage anyway. */
+    if(*size < 16384)
+        return AbstractImporter::doOpenFile(filename);
+    #endif
+
+    /* Instead of reading the whole file into memory, map it and let OpenEXR
+       read the header and the chunk offset table through it, which then
+       touches only the parts of the file containing data that actually get
+       imported. If mapping fails, the function already printed a message and
+       there's no point in trying to read the file again. */
+    Containers::Optional<Containers::Array<const char, Utility::Path::MapDeleter>> mapped = Utility::Path::mapRead(filename);
+    if(!mapped)
+        return;
+
+    openInternal(Containers::Pointer<State>{InPlaceInit, *Utility::move(mapped)});
+}
+#endif
+
 void OpenExrImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dataFlags) {
     /* Take over the existing array or copy the data if we can't */
     Containers::Array<char> dataCopy;
@@ -200,16 +252,16 @@ void OpenExrImporter::doOpenData(Containers::Array<char>&& data, const DataFlags
         dataCopy = Containers::Array<char>{InPlaceInit, data};
 
     /* Set up the input stream using the MemoryIStream class above */
-    Containers::Pointer<State> state{InPlaceInit, Utility::move(dataCopy)};
+    openInternal(Containers::Pointer<State>{InPlaceInit, Utility::move(dataCopy)});
+}
 
+void OpenExrImporter::openInternal(Containers::Pointer<State>&& state) {
     /* Increase global thread count if it's not enough. Value of 0 means single
        thread, while we use 1 for the same (consistent with BasisImageConverter and potential other plugins). */
-    Int threadCount = configuration().value<Int>("threads");
-    if(!threadCount) {
-        threadCount = std::thread::hardware_concurrency();
-        if(flags() & ImporterFlag::Verbose)
-            Debug{} << "Trade::OpenExrImporter::openData(): autodetected hardware concurrency to" << threadCount << "threads";
-    }
+    const UnsignedInt threads = configuration().value<UnsignedInt>("threads");
+    const Int threadCount = Implementation::threadCount(threads);
+    if(!threads && flags() & ImporterFlag::Verbose)
+        Debug{} << "Trade::OpenExrImporter::openData(): autodetected hardware concurrency to" << threadCount << "threads";
     if(Imf::globalThreadCount() < threadCount - 1) {
         if(flags() & ImporterFlag::Verbose)
             Debug{} << "Trade::OpenExrImporter::openData(): increasing global OpenEXR thread pool from" << Imf::globalThreadCount() << "to" << threadCount - 1 << "extra worker threads";
@@ -402,6 +454,25 @@ Containers::Optional<ImageData2D> imageInternal(const Utility::ConfigurationGrou
     const Vector2i size{dataWindow.max.x - dataWindow.min.x + 1,
                         dataWindow.max.y - dataWindow.min.y + 1};
 
+    /* Rectangle to import. The option is Y-up, consistently with how the
+       image is imported, convert it to the Y-down coordinates of the file,
+       relative to the data window origin. */
+    Range2Di crop{{}, size};
+    if(!configuration.value<Containers::StringView>("crop").isEmpty()) {
+        const Range2Di cropYUp = configuration.value<Range2Di>("crop");
+        if(cropYUp.sizeX() <= 0 || cropYUp.sizeY() <= 0) {
+            Error{} << messagePrefix << "expected a non-empty crop rectangle but got" << Debug::packed << cropYUp;
+            return {};
+        }
+        if((cropYUp.min() < Vector2i{}).any() || (cropYUp.max() > size).any()) {
+            Error{} << messagePrefix << "crop rectangle" << Debug::packed << cropYUp << "out of range for a" << Debug::packed << size << "image";
+            return {};
+        }
+
+        crop = {{cropYUp.min().x(), size.y() - cropYUp.max().y()},
+                {cropYUp.max().x(), size.y() - cropYUp.min().y()}};
+    }
+
     /* Figure out channel mapping */
     const Imf::ChannelList& channels = header->channels();
     std::string mapping[]{
@@ -550,7 +621,25 @@ Containers::Optional<ImageData2D> imageInternal(const Utility::ConfigurationGrou
     const PixelFormat format = isDepth ?
         PixelFormat::Depth32F : RgbaFormats[*type][channelCount - 1];
 
-    /* Calculate output size, align rows to four bytes */
+    /* Region that actually gets decompressed. Scanline files are read in
+       whole rows and tiled files in whole tiles, so it can be larger than the
+       crop rectangle, but only the scanline blocks or tiles overlapping the
+       rectangle are touched. Tiles are counted from the data window origin of
+       given level. */
+    Range2Di readRegion;
+    Vector2i firstTile, lastTile;
+    if(level == -1) {
+        readRegion = {{0, crop.min().y()}, {size.x(), crop.max().y()}};
+    } else {
+        auto& actual = *static_cast<Imf::TiledInputFile*>(file);
+        const Vector2i tileSize{Int(actual.tileXSize()), Int(actual.tileYSize())};
+        firstTile = crop.min()/tileSize;
+        lastTile = (crop.max() - Vector2i{1})/tileSize;
+        readRegion = {firstTile*tileSize,
+                      Math::min((lastTile + Vector2i{1})*tileSize, size)};
+    }
+
+    /* Calculate size of the decompressed region, align rows to four bytes */
     constexpr std::size_t ChannelSizes[] {
         4, /* UINT */
         2, /* HALF */
@@ -558,7 +647,7 @@ Containers::Optional<ImageData2D> imageInternal(const Utility::ConfigurationGrou
     };
     const std::size_t channelSize = ChannelSizes[*type];
     const std::size_t pixelSize = channelCount*channelSize;
-    const std::size_t rowStride = 4*((size.x()*pixelSize + 3)/4);
+    const std::size_t rowStride = 4*((readRegion.sizeX()*pixelSize + 3)/4);
 
     /* Output array. If we have unassigned RGBA channels, zero-init them (the
        depth channel is always assigned). OTOH we don't care about the padding,
@@ -569,9 +658,9 @@ Containers::Optional<ImageData2D> imageInternal(const Utility::ConfigurationGrou
         mapping[2].empty() ||
         mapping[3].empty()) && !isDepth)
     {
-        out = Containers::Array<char>{ValueInit, std::size_t{rowStride*size.y()}};
+        out = Containers::Array<char>{ValueInit, std::size_t{rowStride*readRegion.sizeY()}};
     } else {
-        out = Containers::Array<char>{NoInit, std::size_t{rowStride*size.y()}};
+        out = Containers::Array<char>{NoInit, std::size_t{rowStride*readRegion.sizeY()}};
     }
 
     Imf::FrameBuffer framebuffer;
@@ -598,8 +687,8 @@ Containers::Optional<ImageData2D> imageInternal(const Utility::ConfigurationGrou
                 /* For some strange reason I have to supply a pointer to the
                    first pixel ever, not the first pixel inside the data
                    window */
-                - dataWindow.min.y*rowStride
-                - dataWindow.min.x*pixelSize
+                - (dataWindow.min.y + readRegion.min().y())*rowStride
+                - (dataWindow.min.x + readRegion.min().x())*pixelSize
                 /* And an offset to this channel, as they're interleaved */
                 + i*channelSize,
             pixelSize,
@@ -615,14 +704,32 @@ Containers::Optional<ImageData2D> imageInternal(const Utility::ConfigurationGrou
     if(level == -1) {
         auto& actual = *static_cast<Imf::InputFile*>(file);
         actual.setFrameBuffer(framebuffer);
-        actual.readPixels(dataWindow.min.y, dataWindow.max.y);
+        actual.readPixels(dataWindow.min.y + readRegion.min().y(), dataWindow.min.y + readRegion.max().y() - 1);
     } else {
         auto& actual = *static_cast<Imf::TiledInputFile*>(file);
         actual.setFrameBuffer(framebuffer);
-        actual.readTiles(0, actual.numXTiles(level) - 1, 0, actual.numYTiles(level) - 1, level);
+        actual.readTiles(firstTile.x(), lastTile.x(), firstTile.y(), lastTile.y(), level);
+    }
+
+    /* If the decompressed region is larger than the crop rectangle, copy just
+       the rectangle out */
+    if(readRegion != crop) {
+        const std::size_t croppedRowStride = 4*((crop.sizeX()*pixelSize + 3)/4);
+        Containers::Array<char> cropped{NoInit, croppedRowStride*crop.sizeY()};
+        const Containers::StridedArrayView3D<const char> src{out,
+            {std::size_t(readRegion.sizeY()), std::size_t(readRegion.sizeX()), pixelSize},
+            {std::ptrdiff_t(rowStride), std::ptrdiff_t(pixelSize), 1}};
+        Utility::copy(src.sliceSize(
+            {std::size_t(crop.min().y() - readRegion.min().y()),
+             std::size_t(crop.min().x() - readRegion.min().x()), 0},
+            {std::size_t(crop.sizeY()), std::size_t(crop.sizeX()), pixelSize}),
+            Containers::StridedArrayView3D<char>{cropped,
+                {std::size_t(crop.sizeY()), std::size_t(crop.sizeX()), pixelSize},
+                {std::ptrdiff_t(croppedRowStride), std::ptrdiff_t(pixelSize), 1}});
+        out = Utility::move(cropped);
     }
 
-    return Trade::ImageData2D{format, size, Utility::move(out)};
+    return Trade::ImageData2D{format, crop.size(), Utility::move(out)};
 
 /* Good thing there are function try blocks, otherwise I would have to indent
    the whole thing. That would be awful. */
@@ -705,6 +812,12 @@ UnsignedInt OpenExrImporter::doImage3DLevelCount(UnsignedInt) {
 }
 
 Containers::Optional<ImageData3D> OpenExrImporter::doImage3D(UnsignedInt, const UnsignedInt level) {
+    /* The crop rectangle would span across the faces, which makes no sense */
+    if(!configuration().value<Containers::StringView>("crop").isEmpty()) {
+        Error{} << "Trade::OpenExrImporter::image3D(): cropping is not supported for cube maps";
+        return {};
+    }
+
     Containers::Optional<ImageData2D> image2D;
     if(_state->file) {
         image2D = imageInternal(configuration(), &*_state->file, -1, "Trade::OpenExrImporter::image3D():", flags());
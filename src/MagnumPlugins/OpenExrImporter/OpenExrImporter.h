@@ -179,6 +179,18 @@ optional mip levels and half-float, float and unsigned integer channels.
 The plugin recognizes @ref ImporterFlag::Quiet, which will cause all import
 warnings to be suppressed.
 
+@subsection Trade-OpenExrImporter-behavior-memory-mapping Memory-mapped file opening
+
+Files opened with @ref openFile() are memory-mapped instead of being read into
+memory. Together with the chunk offset table stored in the file, this means
+only the parts of the file that are needed for the imported image, layer or
+level get loaded by the operating system. The mapping is kept for as long as
+the file is opened, the file thus shouldn't be modified in the meantime. On
+@ref CORRADE_TARGET_EMSCRIPTEN "Emscripten" and
+@ref CORRADE_TARGET_WINDOWS_RT "Windows RT", where memory mapping isn't
+available, for empty files or if @ref setFileCallback() "file callbacks" are
+used, the whole file is read into memory instead.
+
 @subsection Trade-OpenExrImporter-behavior-channel-mapping Channel mapping
 
 Images containing `R`, `G`, `B` or `A` channels are imported as
@@ -231,6 +243,19 @@ enabled.
 [Ripmap](https://en.wikipedia.org/wiki/Anisotropic_filtering#An_improvement_on_isotropic_MIP_mapping)
 files are imported as a single-level image right now.
 
+@subsection Trade-OpenExrImporter-behavior-crop Importing a part of the image
+
+Setting the @cb{.ini} crop @ce
+@ref Trade-OpenExrImporter-configuration "configuration option" imports only
+given rectangle of the image, returning an image of the rectangle size. For
+scanline files only the scanline blocks overlapping the rectangle are
+decompressed, for tiled files only the overlapping tiles of the level that's
+being imported, which makes it possible to efficiently access small regions of
+huge files. The decompression uses the same amount of threads as set by the
+@cb{.ini} threads @ce option. The rectangle is Y-up, consistently with how the
+images are imported, and is relative to the data window of the imported level.
+Cropping isn't supported for cube maps.
+
 @subsection Trade-OpenExrImporter-behavior-cubemap Cube and lat/lon environment maps
 
 A lat/long environment map is imported as a 2D image without any indication of
@@ -280,6 +305,11 @@ class MAGNUM_OPENEXRIMPORTER_EXPORT OpenExrImporter: public AbstractImporter {
         MAGNUM_OPENEXRIMPORTER_LOCAL ImporterFeatures doFeatures() const override;
         MAGNUM_OPENEXRIMPORTER_LOCAL bool doIsOpened() const override;
         MAGNUM_OPENEXRIMPORTER_LOCAL void doClose() override;
+        /* Memory mapping isn't available on Emscripten and WinRT, the base
+           implementation that reads the file is used there instead */
+        #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+        MAGNUM_OPENEXRIMPORTER_LOCAL void doOpenFile(Containers::StringView filename) override;
+        #endif
         MAGNUM_OPENEXRIMPORTER_LOCAL void doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) override;
 
         MAGNUM_OPENEXRIMPORTER_LOCAL UnsignedInt doImage2DCount() const override;
@@ -290,6 +320,9 @@ class MAGNUM_OPENEXRIMPORTER_EXPORT OpenExrImporter: public AbstractImporter {
         MAGNUM_OPENEXRIMPORTER_LOCAL Containers::Optional<ImageData3D> doImage3D(UnsignedInt id, UnsignedInt level) override;
 
         struct State;
+
+        MAGNUM_OPENEXRIMPORTER_LOCAL void openInternal(Containers::Pointer<State>&& state);
+
         Containers::Pointer<State> _state;
 };
 
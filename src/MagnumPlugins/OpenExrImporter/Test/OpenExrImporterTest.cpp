@@ -30,6 +30,7 @@
 #include <Corrade/PluginManager/Manager.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/String.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Format.h>
@@ -53,6 +54,8 @@ struct OpenExrImporterTest: TestSuite::Tester {
     explicit OpenExrImporterTest();
 
     void emptyFile();
+    void emptyFileOpenFile();
+    void nonexistentFile();
     void shortFile();
     void inconsistentFormat();
     void inconsistentDepthFormat();
@@ -88,6 +91,11 @@ struct OpenExrImporterTest: TestSuite::Tester {
     void levelsCubeMap();
     void levelsCubeMapIncomplete();
 
+    void crop();
+    void cropLevels();
+    void cropInvalid();
+    void cropCubeMap();
+
     void threads();
 
     void openMemory();
@@ -199,6 +207,30 @@ const struct {
         ""}
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+} CropData[]{
+    {"scanline", "rgb16f.exr"},
+    {"custom data/display window", "rgb16f-custom-windows.exr"},
+    {"tiled", "rgb16f-tiled.exr"},
+};
+
+const struct {
+    const char* name;
+    const char* crop;
+    const char* message;
+} CropInvalidData[]{
+    {"empty", "0 1 1 1",
+        "expected a non-empty crop rectangle but got {{0, 1}, {1, 1}}"},
+    {"negative size", "0 2 1 1",
+        "expected a non-empty crop rectangle but got {{0, 2}, {1, 1}}"},
+    {"out of range", "0 0 2 3",
+        "crop rectangle {{0, 0}, {2, 3}} out of range for a {1, 3} image"},
+    {"negative offset", "0 -1 1 2",
+        "crop rectangle {{0, -1}, {1, 2}} out of range for a {1, 3} image"},
+};
+
 /* Shared among all plugins that implement data copying optimizations */
 const struct {
     const char* name;
@@ -226,6 +258,8 @@ const struct {
 
 OpenExrImporterTest::OpenExrImporterTest() {
     addTests({&OpenExrImporterTest::emptyFile,
+              &OpenExrImporterTest::emptyFileOpenFile,
+              &OpenExrImporterTest::nonexistentFile,
               &OpenExrImporterTest::shortFile,
               &OpenExrImporterTest::inconsistentFormat,
               &OpenExrImporterTest::inconsistentDepthFormat});
@@ -274,6 +308,17 @@ OpenExrImporterTest::OpenExrImporterTest() {
     addInstancedTests({&OpenExrImporterTest::levelsCubeMapIncomplete},
         Containers::arraySize(IncompletelCubeMapData));
 
+    addInstancedTests({&OpenExrImporterTest::crop},
+        Containers::arraySize(CropData));
+
+    addInstancedTests({&OpenExrImporterTest::cropLevels},
+        Containers::arraySize(Levels2DData));
+
+    addInstancedTests({&OpenExrImporterTest::cropInvalid},
+        Containers::arraySize(CropInvalidData));
+
+    addTests({&OpenExrImporterTest::cropCubeMap});
+
     /* Could be addInstancedBenchmarks() to verify there's a difference but
        this would mean the test case gets skipped when CORRADE_NO_BENCHMARKS is
        enabled for a faster build. OTOH the improvement on a 5x3 image would be
@@ -316,6 +361,44 @@ void OpenExrImporterTest::emptyFile() {
     #endif
 }
 
+void OpenExrImporterTest::emptyFileOpenFile() {
+    /* Empty files can't be memory-mapped on some platforms, verify it fails
+       gracefully in that case as well */
+    Containers::String filename = Utility::Path::join(OPENEXRIMPORTER_TEST_OUTPUT_DIR, "empty.exr");
+    CORRADE_VERIFY(Utility::Path::make(OPENEXRIMPORTER_TEST_OUTPUT_DIR));
+    CORRADE_VERIFY(Utility::Path::write(filename, Containers::ArrayView<const void>{}));
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenExrImporter");
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(filename));
+    /* The exact message is tested in emptyFile() above */
+    CORRADE_COMPARE_AS(out,
+        "Trade::OpenExrImporter::openData(): import error:",
+        TestSuite::Compare::StringHasPrefix);
+}
+
+void OpenExrImporterTest::nonexistentFile() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenExrImporter");
+
+    Containers::String filename = Utility::Path::join(OPENEXRIMPORTER_TEST_DIR, "nonexistent.exr");
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(filename));
+    /* There's an error message from Path::read() before, but the file
+       shouldn't be attempted to be opened more than once, i.e. there should
+       be no message from Path::mapRead() */
+    CORRADE_COMPARE_AS(out,
+        "Utility::Path::read(): ",
+        TestSuite::Compare::StringHasPrefix);
+    CORRADE_COMPARE_AS(out,
+        Utility::format("\nTrade::AbstractImporter::openFile(): cannot open file {}\n", filename),
+        TestSuite::Compare::StringHasSuffix);
+    CORRADE_VERIFY(!out.contains("Utility::Path::mapRead()"));
+}
+
 void OpenExrImporterTest::shortFile() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenExrImporter");
 
@@ -1103,6 +1186,102 @@ void OpenExrImporterTest::levelsCubeMapIncomplete() {
     }
 }
 
+void OpenExrImporterTest::crop() {
+    auto&& data = CropData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenExrImporter");
+    /* Y-up, so the two top rows of the image */
+    importer->configuration().setValue("crop", "0 1 1 3");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(OPENEXRIMPORTER_TEST_DIR, data.filename)));
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->size(), Vector2i(1, 2));
+    CORRADE_COMPARE(image->format(), PixelFormat::RGB16F);
+
+    /* Data should be aligned to 4 bytes, clear padding to a zero value for
+       predictable output. */
+    CORRADE_COMPARE(image->data().size(), 2*8);
+    Containers::ArrayView<char> imageData = image->mutableData();
+    imageData[0*8 + 6] = imageData[0*8 + 7] =
+        imageData[1*8 + 6] = imageData[1*8 + 7] = 0;
+
+    CORRADE_COMPARE_AS(Containers::arrayCast<const Half>(image->data()), Containers::arrayView<Half>({
+        3.0_h, 4.0_h, 5.0_h, {},
+        6.0_h, 7.0_h, 8.0_h, {}
+    }), TestSuite::Compare::Container);
+}
+
+void OpenExrImporterTest::cropLevels() {
+    auto&& data = Levels2DData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenExrImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(OPENEXRIMPORTER_TEST_DIR, data.filename)));
+
+    /* The rectangle is relative to the imported level, only the tiles
+       overlapping it should be read */
+    {
+        importer->configuration().setValue("crop", "1 1 4 3");
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0, 0);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE(image->size(), (Vector2i{3, 2}));
+        CORRADE_COMPARE(image->format(), PixelFormat::R16F);
+
+        /* Data should be aligned to 4 bytes, clear padding to a zero value for
+           predictable output. */
+        CORRADE_COMPARE(image->data().size(), 2*8);
+        Containers::ArrayView<char> imageData = image->mutableData();
+        imageData[0*8 + 6] = imageData[0*8 + 7] =
+            imageData[1*8 + 6] = imageData[1*8 + 7] = 0;
+
+        CORRADE_COMPARE_AS(Containers::arrayCast<const Half>(image->data()), Containers::arrayView<Half>({
+             6.0_h,  7.0_h,  8.0_h, {},
+            11.0_h, 12.0_h, 13.0_h, {}
+        }), TestSuite::Compare::Container);
+    } {
+        importer->configuration().setValue("crop", "1 0 2 1");
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0, 1);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE(image->size(), (Vector2i{1, 1}));
+        CORRADE_COMPARE(image->format(), PixelFormat::R16F);
+
+        CORRADE_COMPARE(image->data().size(), 4);
+        Containers::ArrayView<char> imageData = image->mutableData();
+        imageData[2] = imageData[3] = 0;
+
+        CORRADE_COMPARE_AS(Containers::arrayCast<const Half>(image->data()), Containers::arrayView<Half>({
+             2.5_h, {}
+        }), TestSuite::Compare::Container);
+    }
+}
+
+void OpenExrImporterTest::cropInvalid() {
+    auto&& data = CropInvalidData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenExrImporter");
+    importer->configuration().setValue("crop", data.crop);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(OPENEXRIMPORTER_TEST_DIR, "rgb16f.exr")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, Utility::format("Trade::OpenExrImporter::image2D(): {}\n", data.message));
+}
+
+void OpenExrImporterTest::cropCubeMap() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenExrImporter");
+    importer->configuration().setValue("crop", "0 0 1 1");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(OPENEXRIMPORTER_TEST_DIR, "envmap-cube.exr")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image3D(0));
+    CORRADE_COMPARE(out, "Trade::OpenExrImporter::image3D(): cropping is not supported for cube maps\n");
+}
+
 void OpenExrImporterTest::threads() {
     auto&& data = ThreadsData[testCaseInstanceId()];
     setTestCaseDescription(data.name);
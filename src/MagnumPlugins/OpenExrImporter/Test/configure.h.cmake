@@ -26,3 +26,4 @@
 
 #cmakedefine OPENEXRIMPORTER_PLUGIN_FILENAME "${OPENEXRIMPORTER_PLUGIN_FILENAME}"
 #define OPENEXRIMPORTER_TEST_DIR "${OPENEXRIMPORTER_TEST_DIR}"
+#define OPENEXRIMPORTER_TEST_OUTPUT_DIR "${OPENEXRIMPORTER_TEST_OUTPUT_DIR}"
@@ -26,9 +26,11 @@
 
 #include "PlutoSvgImporter.h"
 
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/ScopeGuard.h>
 #include <Corrade/Containers/StringView.h>
+#include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/PixelFormat.h>
@@ -37,6 +39,8 @@
 #include <Magnum/Math/Swizzle.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/threadsAndCache.h"
+
 #include <plutosvg.h>
 
 namespace Magnum { namespace Trade {
@@ -54,6 +58,11 @@ struct PlutoSvgImporter::State {
 
     Containers::Array<char> data;
     plutosvg_document* document;
+
+    /* Rasterized images kept for repeated imports, limited by the cacheSize
+       budget. The data are premultiplied BGRA, exactly as produced by
+       plutosvg_document_render(). */
+    Implementation::ImageCache cache;
 };
 
 PlutoSvgImporter::PlutoSvgImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin) : AbstractImporter{manager, plugin} {}
@@ -96,7 +105,11 @@ UnsignedInt PlutoSvgImporter::doImage2DCount() const {
     return 1;
 }
 
-Containers::Optional<ImageData2D> PlutoSvgImporter::doImage2D(UnsignedInt, UnsignedInt) {
+UnsignedInt PlutoSvgImporter::doImage2DLevelCount(UnsignedInt) {
+    return 1 + UnsignedInt(configuration().values<Float>("levelDpi").size());
+}
+
+Containers::Optional<ImageData2D> PlutoSvgImporter::doImage2D(UnsignedInt, const UnsignedInt level) {
     /* The alpha mode can be changed for every image import, so do the checking
        here and not in doOpenData(). Also doing that before anything else so
        people don't just wait ages for doomed-to-fail import with large
@@ -109,8 +122,10 @@ Containers::Optional<ImageData2D> PlutoSvgImporter::doImage2D(UnsignedInt, Unsig
 
     /* Use the configuration-provided DPI value to scale the image. Similarly
        to ResvgImporter, one has to manually scale the document and then supply
-       scaling via a matrix. I wonder which library got inspired from which. */
-    const Float scaling = configuration().value<Float>("dpi")/96.0f;
+       scaling via a matrix. I wonder which library got inspired from which.
+       Additional levels are the same parsed document just rendered with a
+       different scaling. */
+    const Float scaling = (level ? configuration().values<Float>("levelDpi")[level - 1] : configuration().value<Float>("dpi"))/96.0f;
     /* The rounding (and DPI being queried as a float) is verified in the
        load() test as well. */
     const Vector2i size{Int(Math::round(plutosvg_document_get_width(_state->document)*scaling)),
@@ -132,18 +147,24 @@ Containers::Optional<ImageData2D> PlutoSvgImporter::doImage2D(UnsignedInt, Unsig
 
     /** @todo expose rendering of subnodes? is it useful for anything? */
 
-    /* Similar to LunaSVG, this is *rendering into* a bitmap, so the memory
-       needs to be zero-initialized first, additionally therehas to be a canvas
-       object created from a surface. */
-    Containers::Array<char> data{ValueInit, std::size_t(size.product()*4)};
-    plutovg_surface_t* surface = plutovg_surface_create_for_data(reinterpret_cast<std::uint8_t*>(data.data()), size.x(), size.y(), size.x()*4);
-    Containers::ScopeGuard surfaceDestroy{surface, plutovg_surface_destroy};
-    plutovg_canvas_t* canvas  = plutovg_canvas_create(surface);
-    Containers::ScopeGuard canvasDestroy{canvas, plutovg_canvas_destroy};
-    plutovg_canvas_transform(canvas, &matrix);
-    /* The function returns false only if it cannot find the requested element
-       ID, if passed. Since we pass nullptr, the function always succeeds. */
-    CORRADE_INTERNAL_ASSERT_OUTPUT(plutosvg_document_render(_state->document, nullptr, canvas, nullptr, nullptr, nullptr));
+    /* If the image was rendered at the same scaling before and is still in
+       the cache, return a copy of it, otherwise render it */
+    Containers::Array<char> data = Implementation::renderCached(_state->cache, scaling, configuration().value<std::size_t>("cacheSize"), [&]() {
+        /* Similar to LunaSVG, this is *rendering into* a bitmap, so the
+           memory needs to be zero-initialized first, additionally there has
+           to be a canvas object created from a surface. */
+        Containers::Array<char> out{ValueInit, std::size_t(size.product()*4)};
+        plutovg_surface_t* surface = plutovg_surface_create_for_data(reinterpret_cast<std::uint8_t*>(out.data()), size.x(), size.y(), size.x()*4);
+        Containers::ScopeGuard surfaceDestroy{surface, plutovg_surface_destroy};
+        plutovg_canvas_t* canvas  = plutovg_canvas_create(surface);
+        Containers::ScopeGuard canvasDestroy{canvas, plutovg_canvas_destroy};
+        plutovg_canvas_transform(canvas, &matrix);
+        /* The function returns false only if it cannot find the requested
+           element ID, if passed. Since we pass nullptr, the function always
+           succeeds. */
+        CORRADE_INTERNAL_ASSERT_OUTPUT(plutosvg_document_render(_state->document, nullptr, canvas, nullptr, nullptr, nullptr));
+        return out;
+    });
 
     /* PlutoSVG produces a premultiplied BGRA output, unfortunately (and same
        as with ResvgImporter and LunaSvgImporter) it doesn't correctly
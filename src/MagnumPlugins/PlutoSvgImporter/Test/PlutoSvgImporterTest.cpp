@@ -58,6 +58,9 @@ struct PlutoSvgImporterTest: TestSuite::Tester {
     void externalImage();
 
     void openMemory();
+    void levels();
+    void cache();
+
     void openTwice();
     void importTwice();
 
@@ -107,7 +110,10 @@ PlutoSvgImporterTest::PlutoSvgImporterTest() {
     addInstancedTests({&PlutoSvgImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
-    addTests({&PlutoSvgImporterTest::openTwice,
+    addTests({&PlutoSvgImporterTest::levels,
+              &PlutoSvgImporterTest::cache,
+
+              &PlutoSvgImporterTest::openTwice,
               &PlutoSvgImporterTest::importTwice});
 
     /* Pull in the AnyImageImporter dependency for image comparison */
@@ -317,6 +323,100 @@ void PlutoSvgImporterTest::openMemory() {
         (DebugTools::CompareImageToFile{_manager, 8.75f, 0.138f}));
 }
 
+void PlutoSvgImporterTest::levels() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PlutoSvgImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+
+    /* By default there's just one level */
+    CORRADE_COMPARE(importer->image2DLevelCount(0), 1);
+
+    /* The levels can be added after the file is opened, without opening it
+       again */
+    importer->configuration().addValue("levelDpi", 133.6f);
+    importer->configuration().addValue("levelDpi", 48.0f);
+    CORRADE_COMPARE(importer->image2DLevelCount(0), 3);
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    Containers::Optional<Trade::ImageData2D> image133dpi = importer->image2D(0, 1);
+    Containers::Optional<Trade::ImageData2D> image48dpi = importer->image2D(0, 2);
+    CORRADE_VERIFY(image);
+    CORRADE_VERIFY(image133dpi);
+    CORRADE_VERIFY(image48dpi);
+    CORRADE_COMPARE(image->size(), (Vector2i{32, 24}));
+    CORRADE_COMPARE(image133dpi->size(), (Vector2i{45, 33}));
+    CORRADE_COMPARE(image48dpi->size(), (Vector2i{16, 12}));
+
+    if(_manager.loadState("AnyImageImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("AnyImageImporter plugin not found, cannot test contents");
+    if(_manager.loadState("PngImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("PngImporter plugin not found, cannot test contents");
+
+    /* Same thresholds as in load() */
+    CORRADE_COMPARE_WITH(*image133dpi,
+        Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file-133dpi.png"),
+        (DebugTools::CompareImageToFile{_manager, 128.25f, 1.4999f}));
+    CORRADE_COMPARE_WITH(*image48dpi,
+        Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file-48dpi.png"),
+        (DebugTools::CompareImageToFile{_manager, 3.75f, 0.127f}));
+}
+
+void PlutoSvgImporterTest::cache() {
+    /* Reference output without a cache */
+    Containers::Pointer<AbstractImporter> reference = _manager.instantiate("PlutoSvgImporter");
+    reference->configuration().addValue("levelDpi", 48.0f);
+    CORRADE_VERIFY(reference->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+    Containers::Optional<Trade::ImageData2D> expected = reference->image2D(0);
+    Containers::Optional<Trade::ImageData2D> expected48dpi = reference->image2D(0, 1);
+    CORRADE_VERIFY(expected);
+    CORRADE_VERIFY(expected48dpi);
+
+    /* The budget is enough for both levels */
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PlutoSvgImporter");
+    importer->configuration().setValue("cacheSize", 32*24*4 + 16*12*4);
+    importer->configuration().addValue("levelDpi", 48.0f);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+
+    /* Modifying the returned data shouldn't affect what's in the cache */
+    {
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE_AS(*image, *expected, DebugTools::CompareImage);
+        for(char& i: image->mutableData())
+            i = '\x7f';
+    }
+
+    /* Both levels should be the same when imported again from the cache */
+    for(std::size_t i = 0; i != 2; ++i) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+        Containers::Optional<Trade::ImageData2D> image48dpi = importer->image2D(0, 1);
+        CORRADE_VERIFY(image);
+        CORRADE_VERIFY(image48dpi);
+        CORRADE_COMPARE_AS(*image, *expected, DebugTools::CompareImage);
+        CORRADE_COMPARE_AS(*image48dpi, *expected48dpi, DebugTools::CompareImage);
+    }
+
+    /* The cached data are the raw rasterizer output, so changing the alpha
+       mode should have the same effect as without a cache */
+    importer->configuration().setValue("alphaMode", "premultipliedLinear");
+    reference->configuration().setValue("alphaMode", "premultipliedLinear");
+    Containers::Optional<Trade::ImageData2D> premultiplied = importer->image2D(0);
+    Containers::Optional<Trade::ImageData2D> expectedPremultiplied = reference->image2D(0);
+    CORRADE_VERIFY(premultiplied);
+    CORRADE_VERIFY(expectedPremultiplied);
+    CORRADE_COMPARE_AS(*premultiplied, *expectedPremultiplied, DebugTools::CompareImage);
+
+    /* Making the budget smaller or disabling the cache should still give back
+       the same output */
+    for(std::size_t cacheSize: {16*12*4, 0}) {
+        CORRADE_ITERATION(cacheSize);
+        importer->configuration().setValue("cacheSize", cacheSize);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE_AS(*image, *expectedPremultiplied, DebugTools::CompareImage);
+    }
+}
+
 void PlutoSvgImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PlutoSvgImporter");
 
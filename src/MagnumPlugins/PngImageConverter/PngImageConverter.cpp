@@ -36,13 +36,22 @@
 
     New versions don't have that anymore: https://github.com/glennrp/libpng/commit/6c2e919c7eb736d230581a4c925fa67bd901fcf8
 */
+#include <atomic>
 #include <csetjmp>
+#include <cstring>
+#include <zlib.h>
 #include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringView.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
+#include <Corrade/Utility/Move.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/Functions.h>
+
+#include "Magnum/Implementation/threadsAndCache.h"
 
 namespace Magnum { namespace Trade {
 
@@ -62,6 +71,227 @@ Containers::String PngImageConverter::doMimeType() const {
     return "image/png"_s;
 }
 
+namespace {
+
+/* Paeth predictor as defined in the PNG specification */
+inline UnsignedByte paethPredictor(const Int a, const Int b, const Int c) {
+    const Int p = a + b - c;
+    const Int pa = Math::abs(p - a);
+    const Int pb = Math::abs(p - b);
+    const Int pc = Math::abs(p - c);
+    if(pa <= pb && pa <= pc) return a;
+    if(pb <= pc) return b;
+    return c;
+}
+
+/* Filters a single row with given PNG filter type. The output has the
+   filter type byte followed by rowSize filtered bytes, previous is the
+   previous unfiltered row or zeros for the first row. */
+void filterRow(const UnsignedByte type, const UnsignedByte* const row, const UnsignedByte* const previous, const std::size_t rowSize, const std::size_t pixelSize, UnsignedByte* const out) {
+    out[0] = type;
+    UnsignedByte* const filtered = out + 1;
+    switch(type) {
+        case 0:
+            std::memcpy(filtered, row, rowSize);
+            break;
+        case 1:
+            for(std::size_t i = 0; i != rowSize; ++i)
+                filtered[i] = row[i] - (i >= pixelSize ? row[i - pixelSize] : 0);
+            break;
+        case 2:
+            for(std::size_t i = 0; i != rowSize; ++i)
+                filtered[i] = row[i] - previous[i];
+            break;
+        case 3:
+            for(std::size_t i = 0; i != rowSize; ++i)
+                filtered[i] = row[i] - ((i >= pixelSize ? row[i - pixelSize] : 0) + previous[i])/2;
+            break;
+        case 4:
+            for(std::size_t i = 0; i != rowSize; ++i)
+                filtered[i] = row[i] - (i >= pixelSize ?
+                    paethPredictor(row[i - pixelSize], previous[i], previous[i - pixelSize]) :
+                    paethPredictor(0, previous[i], 0));
+            break;
+        default: CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+    }
+}
+
+/* Sum of absolute values of the filtered bytes interpreted as signed, the
+   same heuristic libpng uses to pick a filter when more than one is
+   allowed */
+std::size_t filteredRowCost(const UnsignedByte* const filtered, const std::size_t rowSize) {
+    std::size_t cost = 0;
+    for(std::size_t i = 0; i != rowSize; ++i)
+        cost += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    return cost;
+}
+
+/* Compresses a stripe of filtered rows into a raw deflate stream, primed with
+   the preceding data as a dictionary. All stripes except the last end with a
+   sync flush so they're byte-aligned and can be concatenated. */
+bool deflateStripe(const Containers::ArrayView<const UnsignedByte> dictionary, const Containers::ArrayView<const UnsignedByte> data, const bool last, const Int level, const Int strategy, Containers::Array<char>& out) {
+    z_stream stream{};
+    if(deflateInit2(&stream, level, Z_DEFLATED, -15, 8, strategy) != Z_OK)
+        return false;
+    if(!dictionary.isEmpty() && deflateSetDictionary(&stream, dictionary.data(), dictionary.size()) != Z_OK) {
+        deflateEnd(&stream);
+        return false;
+    }
+
+    out = Containers::Array<char>{NoInit, deflateBound(&stream, data.size()) + 16};
+    stream.next_in = const_cast<Bytef*>(data.data());
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = out.size();
+    for(;;) {
+        const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+        if(result == Z_STREAM_END || (!last && result == Z_OK && !stream.avail_in && stream.avail_out))
+            break;
+        if(result != Z_OK && result != Z_BUF_ERROR) {
+            deflateEnd(&stream);
+            return false;
+        }
+
+        /* Ran out of space, which shouldn't really happen given the bound
+           above, but better be safe */
+        const std::size_t written = out.size() - stream.avail_out;
+        arrayResize(out, NoInit, 2*out.size());
+        stream.next_out = reinterpret_cast<Bytef*>(out.data() + written);
+        stream.avail_out = out.size() - written;
+    }
+
+    arrayResize(out, out.size() - stream.avail_out);
+    deflateEnd(&stream);
+    return true;
+}
+
+/* Filters and compresses the image into a zlib stream for the IDAT chunks,
+   splitting it into stripes that are filtered and deflated in parallel and
+   stitched together, same as pigz does */
+Containers::Optional<Containers::Array<char>> compressParallel(const ImageView2D& image, const UnsignedInt threadCount, const Int bitDepth, Int filters, const Int level, Int strategy) {
+    const Containers::StridedArrayView3D<const char> pixelsFlipped = image.pixels().flipped<0>();
+    CORRADE_INTERNAL_ASSERT(pixelsFlipped.isContiguous<1>());
+    const std::size_t height = image.size().y();
+    const std::size_t pixelSize = image.pixelSize();
+    const std::size_t rowSize = image.size().x()*pixelSize;
+    const std::size_t filteredRowSize = rowSize + 1;
+
+    /* Same defaults as libpng uses for non-palette images */
+    if(filters == -1)
+        filters = PNG_ALL_FILTERS;
+    if(strategy == -1)
+        strategy = filters == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+
+    /* Stripes of at least 128 kB of filtered data, same as the default block
+       size in pigz */
+    const std::size_t stripeRows = Math::max(std::size_t{1}, std::size_t{128*1024}/filteredRowSize);
+    const std::size_t stripeCount = (height + stripeRows - 1)/stripeRows;
+
+    /* Filter all rows. Since filters depend only on the previous unfiltered
+       row, each stripe can be filtered independently. */
+    Containers::Array<UnsignedByte> filtered{NoInit, height*filteredRowSize};
+    Implementation::parallelFor(threadCount, stripeCount, [&](const std::size_t stripe) {
+        /* Scratch space for the current and previous row, byte-swapped to
+           big endian for 16-bit formats, and for all five filter candidates */
+        Containers::Array<UnsignedByte> scratch{ValueInit, 2*rowSize + 5*filteredRowSize};
+        UnsignedByte* current = scratch.data();
+        UnsignedByte* previous = scratch.data() + rowSize;
+        UnsignedByte* const candidates = scratch.data() + 2*rowSize;
+        const auto row = [&](const std::size_t y, UnsignedByte* const swapped) -> const UnsignedByte* {
+            const UnsignedByte* const data = static_cast<const UnsignedByte*>(pixelsFlipped[y].data());
+            #ifndef CORRADE_TARGET_BIG_ENDIAN
+            if(bitDepth == 16) {
+                for(std::size_t i = 0; i != rowSize; i += 2) {
+                    swapped[i] = data[i + 1];
+                    swapped[i + 1] = data[i];
+                }
+                return swapped;
+            }
+            #else
+            static_cast<void>(swapped);
+            #endif
+            return data;
+        };
+
+        const std::size_t yBegin = stripe*stripeRows;
+        const std::size_t yEnd = Math::min(yBegin + stripeRows, height);
+        /* Previous row of the first row in the whole image is all zeros,
+           which is what the scratch memory is initialized to */
+        const UnsignedByte* previousRow = yBegin ? row(yBegin - 1, previous) : previous;
+        for(std::size_t y = yBegin; y != yEnd; ++y) {
+            const UnsignedByte* const currentRow = row(y, current);
+            UnsignedByte* const out = filtered.data() + y*filteredRowSize;
+
+            /* Filter with all allowed types and pick the one with the lowest
+               cost, or directly into the output if there's just one */
+            std::size_t bestCost = ~std::size_t{};
+            for(UnsignedByte type = 0; type != 5; ++type) {
+                if(!(filters & (PNG_FILTER_NONE << type)))
+                    continue;
+                if(filters == (PNG_FILTER_NONE << type)) {
+                    filterRow(type, currentRow, previousRow, rowSize, pixelSize, out);
+                    break;
+                }
+
+                UnsignedByte* const candidate = candidates + type*filteredRowSize;
+                filterRow(type, currentRow, previousRow, rowSize, pixelSize, candidate);
+                const std::size_t cost = filteredRowCost(candidate + 1, rowSize);
+                if(cost < bestCost) {
+                    bestCost = cost;
+                    std::memcpy(out, candidate, filteredRowSize);
+                }
+            }
+
+            /* The current row is the previous for the next one. If it was
+               byte-swapped, swap the buffers so it doesn't get overwritten. */
+            previousRow = currentRow;
+            if(currentRow == current)
+                Utility::swap(current, previous);
+        }
+    });
+
+    /* Deflate each stripe, with the last 32 kB of filtered data preceding it
+       as a dictionary to not lose compression efficiency at stripe
+       boundaries */
+    Containers::Array<Containers::Array<char>> compressed{stripeCount};
+    Containers::Array<uLong> adlers{NoInit, stripeCount};
+    std::atomic<bool> failed{false};
+    Implementation::parallelFor(threadCount, stripeCount, [&](const std::size_t stripe) {
+        const std::size_t begin = stripe*stripeRows*filteredRowSize;
+        const std::size_t end = Math::min((stripe + 1)*stripeRows, height)*filteredRowSize;
+        const std::size_t dictionaryBegin = begin > 32768 ? begin - 32768 : 0;
+        if(!deflateStripe(filtered.slice(dictionaryBegin, begin), filtered.slice(begin, end), stripe + 1 == stripeCount, level, strategy, compressed[stripe]))
+            failed = true;
+        adlers[stripe] = adler32(adler32(0, nullptr, 0), filtered.data() + begin, end - begin);
+    });
+    if(failed) {
+        Error{} << "Trade::PngImageConverter::convertToData(): cannot compress the image with zlib";
+        return {};
+    }
+
+    /* Concatenate the stripes, with a zlib header in front and the Adler-32
+       of the whole stream combined from the per-stripe checksums at the end.
+       The header specifies a deflate stream with a 32 kB window and the
+       compression level hint. */
+    Containers::Array<char> out;
+    const Int levelHint = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+    UnsignedInt header = 0x7800|((levelHint < 2 ? 0 : levelHint < 6 ? 1 : levelHint == 6 ? 2 : 3) << 6);
+    header += 31 - header % 31;
+    arrayAppend(out, {char(header >> 8), char(header & 0xff)});
+    uLong adler = adler32(0, nullptr, 0);
+    for(std::size_t i = 0; i != stripeCount; ++i) {
+        arrayAppend(out, compressed[i]);
+        const std::size_t end = Math::min((i + 1)*stripeRows, height)*filteredRowSize;
+        adler = adler32_combine(adler, adlers[i], end - i*stripeRows*filteredRowSize);
+    }
+    arrayAppend(out, {char(adler >> 24), char((adler >> 16) & 0xff), char((adler >> 8) & 0xff), char(adler & 0xff)});
+
+    /* GCC 4.8 needs extra help here */
+    return Containers::optional(Utility::move(out));
+}
+
+}
+
 Containers::Optional<Containers::Array<char>> PngImageConverter::doConvertToData(const ImageView2D& image) {
     /* Warn about lost metadata */
     if((image.flags() & ImageFlag2D::Array) && !(flags() & ImageConverterFlag::Quiet)) {
@@ -110,6 +340,115 @@ Containers::Optional<Containers::Array<char>> PngImageConverter::doConvertToData
             return {};
     }
 
+    /* Compression options from the preset. Value of -1 means the library
+       default is used, same for 0 in case of the IDAT size. */
+    const Containers::StringView preset = configuration().value<Containers::StringView>("preset");
+    Int compressionLevel;
+    Int filters;
+    Int compressionStrategy;
+    UnsignedInt idatSize;
+    if(preset == "default"_s) {
+        compressionLevel = -1;
+        filters = -1;
+        compressionStrategy = -1;
+        idatSize = 0;
+    } else if(preset == "fast"_s) {
+        compressionLevel = 1;
+        filters = PNG_FILTER_SUB;
+        compressionStrategy = -1;
+        idatSize = 1024*1024;
+    } else if(preset == "small"_s) {
+        compressionLevel = 9;
+        filters = PNG_ALL_FILTERS;
+        compressionStrategy = -1;
+        idatSize = 0;
+    } else {
+        Error{} << "Trade::PngImageConverter::convertToData(): expected preset to be one of default, fast or small but got" << preset;
+        return {};
+    }
+
+    /* Overrides of individual preset values, if set */
+    /* Parsed manually, as value<Int>() would silently turn a non-numeric
+       value into 0 */
+    if(const Containers::StringView level = configuration().value<Containers::StringView>("compressionLevel")) {
+        if(level.size() != 1 || level[0] < '0' || level[0] > '9') {
+            Error{} << "Trade::PngImageConverter::convertToData(): expected compression level to be between 0 and 9 but got" << level;
+            return {};
+        }
+        compressionLevel = level[0] - '0';
+    }
+    if(const Containers::StringView filter = configuration().value<Containers::StringView>("filter")) {
+        filters = 0;
+        for(const Containers::StringView i: filter.splitOnWhitespaceWithoutEmptyParts()) {
+            if(i == "none"_s)
+                filters |= PNG_FILTER_NONE;
+            else if(i == "sub"_s)
+                filters |= PNG_FILTER_SUB;
+            else if(i == "up"_s)
+                filters |= PNG_FILTER_UP;
+            else if(i == "average"_s)
+                filters |= PNG_FILTER_AVG;
+            else if(i == "paeth"_s)
+                filters |= PNG_FILTER_PAETH;
+            else if(i == "all"_s)
+                filters |= PNG_ALL_FILTERS;
+            else {
+                Error{} << "Trade::PngImageConverter::convertToData(): expected filter to be a list of none, sub, up, average, paeth or all but got" << i;
+                return {};
+            }
+        }
+        /* A whitespace-only value is treated as empty */
+        if(!filters)
+            filters = -1;
+    }
+    if(const Containers::StringView strategy = configuration().value<Containers::StringView>("compressionStrategy")) {
+        if(strategy == "default"_s)
+            compressionStrategy = Z_DEFAULT_STRATEGY;
+        else if(strategy == "filtered"_s)
+            compressionStrategy = Z_FILTERED;
+        else if(strategy == "huffmanOnly"_s)
+            compressionStrategy = Z_HUFFMAN_ONLY;
+        else if(strategy == "rle"_s)
+            compressionStrategy = Z_RLE;
+        else if(strategy == "fixed"_s)
+            compressionStrategy = Z_FIXED;
+        else {
+            Error{} << "Trade::PngImageConverter::convertToData(): expected compression strategy to be one of default, filtered, huffmanOnly, rle or fixed but got" << strategy;
+            return {};
+        }
+    }
+    /* Again parsed manually, value<UnsignedInt>() would silently turn
+       anything non-numeric into 0 and ignore trailing garbage */
+    if(const Containers::StringView size = configuration().value<Containers::StringView>("idatSize")) {
+        UnsignedLong value = 0;
+        for(const char c: size) {
+            if(c < '0' || c > '9' || (value = value*10 + (c - '0')) > 0xffffffffull) {
+                value = 0;
+                break;
+            }
+        }
+        if(!value) {
+            Error{} << "Trade::PngImageConverter::convertToData(): expected IDAT size to be a positive integer but got" << size;
+            return {};
+        }
+        idatSize = value;
+    }
+
+    /* Value of 0 means all hardware threads, 1 means the whole image is
+       filtered and compressed by libpng in the calling thread */
+    const UnsignedInt threadCount = Implementation::threadCount(configuration().value<UnsignedInt>("threads"));
+
+    /* If multithreaded, filter and compress the image data upfront, libpng is
+       then used just to write the header and the chunks. Doing it before
+       the png_create_write_struct() call also means no threads or related
+       state can get affected by the longjmp() in libpng error handling. */
+    Containers::Optional<Containers::Array<char>> parallelCompressed;
+    if(threadCount != 1) {
+        parallelCompressed = compressParallel(image, threadCount, bitDepth, filters, compressionLevel, compressionStrategy);
+        if(!parallelCompressed)
+            return {};
+    }
+
     png_structp file = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     /** @todo this will assert if the PNG major/minor version doesn't match,
         with "libpng warning: Application built with libpng-1.7.0 but running
@@ -148,12 +487,39 @@ Containers::Optional<Containers::Array<char>> PngImageConverter::doConvertToData
         arrayAppend(output, {reinterpret_cast<const char*>(data), length});
     }, [](png_structp){});
 
+    /* Apply compression options that differ from library defaults. The
+       compression buffer size has to be set before any data are written. */
+    if(compressionLevel != -1)
+        png_set_compression_level(file, compressionLevel);
+    if(compressionStrategy != -1)
+        png_set_compression_strategy(file, compressionStrategy);
+    if(filters != -1)
+        png_set_filter(file, PNG_FILTER_TYPE_BASE, filters);
+    if(idatSize)
+        png_set_compression_buffer_size(file, idatSize);
+
     /* Write header */
     png_set_IHDR(file, info, image.size().x(), image.size().y(),
         bitDepth, colorType, PNG_INTERLACE_NONE,
         PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
     png_write_info(file, info);
 
+    /* If the data were compressed upfront, write them as IDAT chunks of given
+       size and finish with an IEND chunk */
+    if(parallelCompressed) {
+        /* Same as the libpng default IDAT size */
+        const std::size_t chunkSize = idatSize ? idatSize : 8192;
+        for(std::size_t i = 0; i < parallelCompressed->size(); i += chunkSize)
+            png_write_chunk(file, reinterpret_cast<png_const_bytep>("IDAT"), reinterpret_cast<png_const_bytep>(parallelCompressed->data() + i), Math::min(chunkSize, parallelCompressed->size() - i));
+        png_write_chunk(file, reinterpret_cast<png_const_bytep>("IEND"), nullptr, 0);
+        png_destroy_write_struct(&file, &info);
+
+        arrayShrink(output);
+
+        /* GCC 4.8 needs extra help here */
+        return Containers::optional(Utility::move(output));
+    }
+
     /* For 16 bit depth we need to swap to big endian */
     if(bitDepth == 16) {
         #ifndef CORRADE_TARGET_BIG_ENDIAN
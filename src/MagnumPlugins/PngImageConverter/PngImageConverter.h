@@ -76,16 +76,16 @@ Creates Portable Network Graphics (`*.png`) files using the
     via the base @ref AbstractImageConverter interface. See its documentation
     for introduction and usage examples.
 
-This plugin depends on the @ref Trade and [libPNG](https://www.libpng.org/pub/png/libpng.html)
-libraries and is built if `MAGNUM_WITH_PNGIMAGECONVERTER` is enabled when
+This plugin depends on the @ref Trade, [libPNG](https://www.libpng.org/pub/png/libpng.html)
+and [zlib](https://zlib.net) libraries and is built if `MAGNUM_WITH_PNGIMAGECONVERTER` is enabled when
 building Magnum Plugins. To use as a dynamic plugin, load @cpp "PngImageConverter" @ce
 via @ref Corrade::PluginManager::Manager.
 
 Additionally, if you're using Magnum as a CMake subproject, bundle the
 [magnum-plugins repository](https://github.com/mosra/magnum-plugins) and do the
-following. Using libPNG itself as a CMake subproject isn't tested at the
-moment, so you need to provide it as a system dependency and point
-`CMAKE_PREFIX_PATH` to its installation dir if necessary.
+following. Using libPNG and zlib as CMake subprojects isn't tested at the
+moment, so you need to provide them as system dependencies and point
+`CMAKE_PREFIX_PATH` to their installation dir if necessary.
 
 @code{.cmake}
 set(MAGNUM_WITH_PNGIMAGECONVERTER ON CACHE BOOL "" FORCE)
@@ -125,6 +125,48 @@ the file is saved as a regular 2D image.
 The plugin recognizes @ref ImageConverterFlag::Quiet, which will cause all
 conversion warnings, coming either from the plugin or libpng itself, to be
 suppressed.
+
+@subsection Trade-PngImageConverter-behavior-compression Compression options
+
+By default the image is compressed with libpng and zlib defaults. The
+@cb{.ini} preset @ce @ref Trade-PngImageConverter-configuration "configuration option"
+can be set to @cb{.ini} fast @ce to trade output size for encoding speed,
+which uses zlib level 1, only the Sub filter and 1 MB IDAT chunks, or to
+@cb{.ini} small @ce, which uses zlib level 9 and adaptive filter selection.
+Individual values of the preset can be further overriden with the
+@cb{.ini} compressionLevel @ce, @cb{.ini} filter @ce,
+@cb{.ini} compressionStrategy @ce and @cb{.ini} idatSize @ce options. The
+output is a standard PNG file in all cases, the options affect only the
+encoding speed and the output size.
+
+@subsection Trade-PngImageConverter-behavior-multithreading Multithreaded encoding
+
+By default the whole image is filtered and compressed by libpng in the
+calling thread. If the @cb{.ini} threads @ce
+@ref Trade-PngImageConverter-configuration "configuration option" is set to
+a value other than @cpp 1 @ce, with @cpp 0 @ce meaning all hardware threads,
+the image is instead split into stripes of rows with at least 128 kB of data
+each. The rows are filtered by the plugin itself, choosing the filter with the
+same heuristic as libpng if more than one is allowed, and each stripe is
+then deflated on its own thread with the preceding 32 kB as a dictionary and
+ended with a sync flush. The stripes are concatenated into a single zlib
+stream with an Adler-32 checksum combined from the per-stripe checksums,
+similarly to what [pigz](https://zlib.net/pigz/) does. The output is a
+standard PNG file, which is however not byte-for-byte the same as when
+encoded in a single thread and is usually a bit larger.
+
+On Linux, using more than one thread requires the application to be linked
+to `pthread`, see @ref cmake-plugins-threads for details.
+
+@section Trade-PngImageConverter-configuration Plugin-specific configuration
+
+It's possible to tune various options mainly for compression through
+@ref configuration(). See below for all options and their default values:
+
+@snippet MagnumPlugins/PngImageConverter/PngImageConverter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_PNGIMAGECONVERTER_EXPORT PngImageConverter: public AbstractImageConverter {
     public:
@@ -24,12 +24,18 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include <cstdlib> /* std::strtoul() */
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pair.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
+#include <Corrade/TestSuite/Compare/String.h>
 #include <Corrade/TestSuite/Compare/StringToFile.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/ImageView.h>
@@ -43,6 +49,7 @@
 #include "configure.h"
 
 #include <png.h> /* PNG_WARNINGS_SUPPORTED */
+#include <zlib.h>
 
 namespace Magnum { namespace Trade { namespace Test { namespace {
 
@@ -64,11 +71,24 @@ struct PngImageConverterTest: TestSuite::Tester {
 
     void unsupportedMetadata();
 
+    void compression();
+    void compressionPresetSize();
+    void compressionInvalidOption();
+    void threads();
+
+    void benchmarkEncode();
+    void benchmarkSize();
+    void benchmarkSizeBegin();
+    std::uint64_t benchmarkSizeEnd();
+
+    std::size_t _benchmarkOutputSize;
+
     /* Explicitly forbid system-wide plugin dependencies */
     PluginManager::Manager<AbstractImageConverter> _converterManager{"nonexistent"};
     PluginManager::Manager<AbstractImporter> _importerManager{"nonexistent"};
 };
 
+using namespace Containers::Literals;
 using namespace Math::Literals;
 
 const struct {
@@ -92,6 +112,160 @@ const struct {
         nullptr},
 };
 
+const struct {
+    const char* name;
+    const char* preset;
+    const char* compressionLevel;
+    const char* filter;
+    const char* compressionStrategy;
+    const char* idatSize;
+    /* The FLEVEL field of the zlib header. It's 0 for levels 0 and 1 and
+       for the huffmanOnly, rle and fixed strategies, 2 for the default level
+       6 and 3 for levels 7 to 9 */
+    UnsignedByte expectedFlevel;
+    /* Bitmask of filter types allowed for each row, 1 << 0 being none */
+    UnsignedByte expectedFilters;
+} CompressionData[]{
+    {"default preset", "default", nullptr, nullptr, nullptr, nullptr,
+        2, 0x1f},
+    {"fast preset", "fast", nullptr, nullptr, nullptr, nullptr,
+        0, 1 << 1},
+    {"small preset", "small", nullptr, nullptr, nullptr, nullptr,
+        3, 0x1f},
+    {"no compression", "default", "0", nullptr, nullptr, nullptr,
+        0, 0x1f},
+    {"fast preset, paeth filter", "fast", nullptr, "paeth", nullptr, nullptr,
+        0, 1 << 4},
+    {"filter list", "default", nullptr, " none\tup  average ", nullptr, nullptr,
+        2, 1 << 0|1 << 2|1 << 3},
+    {"small preset, RLE strategy", "small", nullptr, nullptr, "rle", nullptr,
+        0, 0x1f},
+    {"huffman only", "default", "6", "all", "huffmanOnly", nullptr,
+        0, 0x1f},
+    {"fixed strategy, tiny IDAT chunks", "default", nullptr, nullptr, "fixed", "64",
+        0, 0x1f},
+};
+
+const struct {
+    const char* name;
+    const char* option;
+    const char* value;
+    const char* message;
+} CompressionInvalidOptionData[]{
+    {"preset", "preset", "tiny",
+        "expected preset to be one of default, fast or small but got tiny"},
+    {"compression level", "compressionLevel", "10",
+        "expected compression level to be between 0 and 9 but got 10"},
+    {"compression level not a number", "compressionLevel", "best",
+        "expected compression level to be between 0 and 9 but got best"},
+    {"filter", "filter", "sub mean up",
+        "expected filter to be a list of none, sub, up, average, paeth or all but got mean"},
+    {"compression strategy", "compressionStrategy", "huffman",
+        "expected compression strategy to be one of default, filtered, huffmanOnly, rle or fixed but got huffman"},
+    {"IDAT size zero", "idatSize", "0",
+        "expected IDAT size to be a positive integer but got 0"},
+    {"IDAT size negative", "idatSize", "-64",
+        "expected IDAT size to be a positive integer but got -64"},
+    {"IDAT size with a suffix", "idatSize", "64k",
+        "expected IDAT size to be a positive integer but got 64k"},
+    {"IDAT size too large", "idatSize", "4294967296",
+        "expected IDAT size to be a positive integer but got 4294967296"},
+};
+
+const struct {
+    const char* name;
+    PixelFormat format;
+    Vector2i size;
+    UnsignedInt threads;
+    const char* preset;
+    const char* filter;
+    const char* idatSize;
+} ThreadsData[]{
+    {"RGBA8, 2 threads", PixelFormat::RGBA8Unorm, {67, 43}, 2,
+        "default", nullptr, nullptr},
+    {"RGBA8, many stripes, 4 threads", PixelFormat::RGBA8Unorm, {301, 517}, 4,
+        "default", nullptr, nullptr},
+    {"RGBA8, many stripes, all hardware threads, fast preset", PixelFormat::RGBA8Unorm, {301, 517}, 0,
+        "fast", nullptr, nullptr},
+    {"RGB16, many stripes, 3 threads, small preset", PixelFormat::RGB16Unorm, {251, 389}, 3,
+        "small", nullptr, nullptr},
+    {"R8, single row, 5 threads", PixelFormat::R8Unorm, {33, 1}, 5,
+        "default", nullptr, nullptr},
+    {"RG16, rows larger than a stripe, 3 threads, paeth filter", PixelFormat::RG16Unorm, {40000, 7}, 3,
+        "default", "paeth", nullptr},
+    {"RGB8, 3 threads, no filter, tiny IDAT chunks", PixelFormat::RGB8Unorm, {123, 77}, 3,
+        "default", "none", "100"},
+};
+
+const struct {
+    const char* name;
+    PixelFormat format;
+    const char* preset;
+    UnsignedInt threads;
+} BenchmarkData[]{
+    /* Input is 8 MB for RGBA8 and 12 MB for RGB16, divide by the reported
+       time to get MB/s */
+    {"RGBA8 1024x2048, default preset", PixelFormat::RGBA8Unorm, "default", 1},
+    {"RGBA8 1024x2048, fast preset", PixelFormat::RGBA8Unorm, "fast", 1},
+    {"RGBA8 1024x2048, small preset", PixelFormat::RGBA8Unorm, "small", 1},
+    {"RGBA8 1024x2048, default preset, all hardware threads", PixelFormat::RGBA8Unorm, "default", 0},
+    {"RGBA8 1024x2048, fast preset, all hardware threads", PixelFormat::RGBA8Unorm, "fast", 0},
+    {"RGB16 1024x2048, default preset", PixelFormat::RGB16Unorm, "default", 1},
+    {"RGB16 1024x2048, fast preset", PixelFormat::RGB16Unorm, "fast", 1},
+    {"RGB16 1024x2048, small preset", PixelFormat::RGB16Unorm, "small", 1},
+    {"RGB16 1024x2048, default preset, all hardware threads", PixelFormat::RGB16Unorm, "default", 0},
+};
+
+/* Returns sizes of all IDAT chunks in a PNG file together with their
+   concatenated contents, i.e. the zlib stream */
+Containers::Pair<Containers::Array<std::size_t>, Containers::Array<char>> idatChunks(Containers::ArrayView<const char> png) {
+    Containers::Array<std::size_t> sizes;
+    Containers::Array<char> data;
+    png = png.exceptPrefix(8);
+    while(png.size() >= 12) {
+        const auto* const length = reinterpret_cast<const UnsignedByte*>(png.data());
+        const std::size_t size = std::size_t(length[0]) << 24 | length[1] << 16 | length[2] << 8 | length[3];
+        if(Containers::StringView{png.data() + 4, 4} == "IDAT"_s) {
+            arrayAppend(sizes, size);
+            arrayAppend(data, png.sliceSize(8, size));
+        }
+        png = png.exceptPrefix(12 + size);
+    }
+    return {Utility::move(sizes), Utility::move(data)};
+}
+
+/* Smooth gradients with a bit of noise and a few flat-colored rectangles,
+   roughly resembling a screenshot of a rendered scene with some UI on top */
+Containers::Array<char> benchmarkImage(const PixelFormat format, const Vector2i& size) {
+    const std::size_t channelCount = pixelFormatChannelCount(format);
+    const std::size_t channelSize = pixelFormatSize(format)/channelCount;
+    Containers::Array<char> out{NoInit, std::size_t(size.product())*pixelFormatSize(format)};
+    UnsignedInt noise = 0x1234567u;
+    std::size_t i = 0;
+    for(Int y = 0; y != size.y(); ++y) {
+        for(Int x = 0; x != size.x(); ++x) {
+            noise = noise*1103515245u + 12345u;
+            const bool rectangle = (x/64 + y/48) % 7 == 0;
+            for(std::size_t c = 0; c != channelCount; ++c) {
+                UnsignedShort value;
+                if(c == 3)
+                    value = rectangle ? 0xc000 : 0xffff;
+                else if(rectangle)
+                    value = 0x2000*(c + 2);
+                else
+                    value = UnsignedShort((x*(c + 1)*65535/size.x() + y*(3 - c)*65535/size.y())/3 + ((noise >> (16 + 4*c)) & 0x3ff));
+                if(channelSize == 1)
+                    out[i++] = char(value >> 8);
+                else {
+                    *reinterpret_cast<UnsignedShort*>(out + i) = value;
+                    i += 2;
+                }
+            }
+        }
+    }
+    return out;
+}
+
 PngImageConverterTest::PngImageConverterTest() {
     addTests({&PngImageConverterTest::wrongFormat});
 
@@ -111,6 +285,26 @@ PngImageConverterTest::PngImageConverterTest() {
     addInstancedTests({&PngImageConverterTest::unsupportedMetadata},
         Containers::arraySize(UnsupportedMetadataData));
 
+    addInstancedTests({&PngImageConverterTest::compression},
+        Containers::arraySize(CompressionData));
+
+    addTests({&PngImageConverterTest::compressionPresetSize});
+
+    addInstancedTests({&PngImageConverterTest::compressionInvalidOption},
+        Containers::arraySize(CompressionInvalidOptionData));
+
+    addInstancedTests({&PngImageConverterTest::threads},
+        Containers::arraySize(ThreadsData));
+
+    addInstancedBenchmarks({&PngImageConverterTest::benchmarkEncode}, 5,
+        Containers::arraySize(BenchmarkData), BenchmarkType::WallTime);
+
+    addCustomInstancedBenchmarks({&PngImageConverterTest::benchmarkSize}, 1,
+        Containers::arraySize(BenchmarkData),
+        &PngImageConverterTest::benchmarkSizeBegin,
+        &PngImageConverterTest::benchmarkSizeEnd,
+        BenchmarkUnits::Bytes);
+
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
     #ifdef PNGIMAGECONVERTER_PLUGIN_FILENAME
@@ -419,6 +613,208 @@ void PngImageConverterTest::unsupportedMetadata() {
         CORRADE_COMPARE(out, Utility::format("Trade::PngImageConverter::convertToData(): {}\n", data.message));
 }
 
+void PngImageConverterTest::compression() {
+    auto&& data = CompressionData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const Vector2i size{67, 43};
+    const Containers::Array<char> imageData = benchmarkImage(PixelFormat::RGBA8Unorm, size);
+    /* Odd width, so the rows need to be unpadded */
+    const ImageView2D image{PixelStorage{}.setAlignment(1), PixelFormat::RGBA8Unorm, size, imageData};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("PngImageConverter");
+    converter->configuration().setValue("preset", data.preset);
+    if(data.compressionLevel)
+        converter->configuration().setValue("compressionLevel", data.compressionLevel);
+    if(data.filter)
+        converter->configuration().setValue("filter", data.filter);
+    if(data.compressionStrategy)
+        converter->configuration().setValue("compressionStrategy", data.compressionStrategy);
+    if(data.idatSize)
+        converter->configuration().setValue("idatSize", data.idatSize);
+
+    Containers::Optional<Containers::Array<char>> out = converter->convertToData(image);
+    CORRADE_VERIFY(out);
+
+    /* With no compression the output has to be larger than the input */
+    if(data.compressionLevel && data.compressionLevel == "0"_s)
+        CORRADE_COMPARE_AS(out->size(), imageData.size(),
+            TestSuite::Compare::Greater);
+
+    /* If IDAT size is set, the chunks should be at most that large */
+    Containers::Pair<Containers::Array<std::size_t>, Containers::Array<char>> idat = idatChunks(*out);
+    CORRADE_VERIFY(!idat.first().isEmpty());
+    if(data.idatSize) {
+        CORRADE_COMPARE_AS(idat.first().size(), std::size_t{1},
+            TestSuite::Compare::Greater);
+        for(const std::size_t chunkSize: idat.first())
+            CORRADE_COMPARE_AS(chunkSize, std::size_t(std::strtoul(data.idatSize, nullptr, 10)),
+                TestSuite::Compare::LessOrEqual);
+    }
+
+    /* The compression level and strategy is reflected in the zlib header */
+    CORRADE_COMPARE_AS(idat.second().size(), std::size_t{2},
+        TestSuite::Compare::GreaterOrEqual);
+    CORRADE_COMPARE(UnsignedByte(UnsignedByte(idat.second()[1]) >> 6), data.expectedFlevel);
+
+    /* Each decompressed row starts with a filter type byte, which should be
+       one of the allowed */
+    const std::size_t filteredRowSize = size.x()*4 + 1;
+    Containers::Array<UnsignedByte> filtered{NoInit, filteredRowSize*size.y()};
+    uLongf filteredSize = filtered.size();
+    CORRADE_COMPARE(uncompress(filtered.data(), &filteredSize, reinterpret_cast<const Bytef*>(idat.second().data()), idat.second().size()), Z_OK);
+    CORRADE_COMPARE(filteredSize, filtered.size());
+    for(Int y = 0; y != size.y(); ++y) {
+        CORRADE_ITERATION(y);
+        const UnsignedByte filter = filtered[y*filteredRowSize];
+        CORRADE_COMPARE_AS(filter, UnsignedByte{4},
+            TestSuite::Compare::LessOrEqual);
+        CORRADE_VERIFY(data.expectedFilters & (1 << filter));
+    }
+
+    if(_importerManager.loadState("PngImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("PngImporter plugin not found, cannot test");
+
+    /* Regardless of the options, the output is a standard PNG that decodes
+       to the same pixels */
+    Containers::Pointer<AbstractImporter> importer = _importerManager.instantiate("PngImporter");
+    CORRADE_VERIFY(importer->openData(*out));
+    Containers::Optional<Trade::ImageData2D> converted = importer->image2D(0);
+    CORRADE_VERIFY(converted);
+    CORRADE_COMPARE_AS(*converted, image, DebugTools::CompareImage);
+}
+
+void PngImageConverterTest::compressionPresetSize() {
+    const Vector2i size{256, 256};
+    const Containers::Array<char> imageData = benchmarkImage(PixelFormat::RGBA8Unorm, size);
+    const ImageView2D image{PixelFormat::RGBA8Unorm, size, imageData};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("PngImageConverter");
+    std::size_t sizes[3];
+    const char* const presets[]{"fast", "default", "small"};
+    for(std::size_t i = 0; i != Containers::arraySize(presets); ++i) {
+        CORRADE_ITERATION(presets[i]);
+        converter->configuration().setValue("preset", presets[i]);
+        Containers::Optional<Containers::Array<char>> out = converter->convertToData(image);
+        CORRADE_VERIFY(out);
+        sizes[i] = out->size();
+    }
+
+    /* Each preset should trade more time for a smaller output than the
+       previous one */
+    CORRADE_COMPARE_AS(sizes[1], sizes[0],
+        TestSuite::Compare::Less);
+    CORRADE_COMPARE_AS(sizes[2], sizes[1],
+        TestSuite::Compare::Less);
+}
+
+void PngImageConverterTest::compressionInvalidOption() {
+    auto&& data = CompressionInvalidOptionData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("PngImageConverter");
+    converter->configuration().setValue(data.option, data.value);
+
+    const char imageData[4]{};
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!converter->convertToData(ImageView2D{PixelFormat::RGBA8Unorm, {1, 1}, imageData}));
+    CORRADE_COMPARE(out, Utility::format("Trade::PngImageConverter::convertToData(): {}\n", data.message));
+}
+
+void PngImageConverterTest::threads() {
+    auto&& data = ThreadsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const Containers::Array<char> imageData = benchmarkImage(data.format, data.size);
+    const ImageView2D image{PixelStorage{}.setAlignment(1), data.format, data.size, imageData};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("PngImageConverter");
+    converter->configuration().setValue("threads", data.threads);
+    converter->configuration().setValue("preset", data.preset);
+    if(data.filter)
+        converter->configuration().setValue("filter", data.filter);
+    if(data.idatSize)
+        converter->configuration().setValue("idatSize", data.idatSize);
+
+    Containers::Optional<Containers::Array<char>> out = converter->convertToData(image);
+    CORRADE_VERIFY(out);
+
+    /* The file should start with the signature and IHDR and end with IEND,
+       same as when written by libpng alone. If IDAT size is set, the chunks
+       should be at most that large. */
+    CORRADE_COMPARE_AS(Containers::StringView{*out},
+        "\x89PNG\r\n\x1a\n\0\0\0\x0dIHDR"_s,
+        TestSuite::Compare::StringHasPrefix);
+    CORRADE_COMPARE_AS(Containers::StringView{*out},
+        "\0\0\0\0IEND\xae\x42\x60\x82"_s,
+        TestSuite::Compare::StringHasSuffix);
+    if(data.idatSize) {
+        for(const std::size_t chunkSize: idatChunks(*out).first())
+            CORRADE_COMPARE_AS(chunkSize, std::size_t(std::strtoul(data.idatSize, nullptr, 10)),
+                TestSuite::Compare::LessOrEqual);
+    }
+
+    if(_importerManager.loadState("PngImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("PngImporter plugin not found, cannot test");
+
+    /* The output should be a standard PNG with a single zlib stream that
+       decodes to the same pixels */
+    Containers::Pointer<AbstractImporter> importer = _importerManager.instantiate("PngImporter");
+    CORRADE_VERIFY(importer->openData(*out));
+    Containers::Optional<Trade::ImageData2D> converted = importer->image2D(0);
+    CORRADE_VERIFY(converted);
+    CORRADE_COMPARE_AS(*converted, image, DebugTools::CompareImage);
+}
+
+void PngImageConverterTest::benchmarkEncode() {
+    auto&& data = BenchmarkData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const Vector2i size{1024, 2048};
+    const Containers::Array<char> imageData = benchmarkImage(data.format, size);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("PngImageConverter");
+    converter->configuration().setValue("preset", data.preset);
+    converter->configuration().setValue("threads", data.threads);
+
+    Containers::Optional<Containers::Array<char>> out;
+    CORRADE_BENCHMARK(1)
+        out = converter->convertToData(ImageView2D{data.format, size, imageData});
+
+    CORRADE_VERIFY(out);
+}
+
+void PngImageConverterTest::benchmarkSize() {
+    auto&& data = BenchmarkData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const Vector2i size{1024, 2048};
+    const Containers::Array<char> imageData = benchmarkImage(data.format, size);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("PngImageConverter");
+    converter->configuration().setValue("preset", data.preset);
+    converter->configuration().setValue("threads", data.threads);
+
+    /* Not measuring time but the output size, reported by
+       benchmarkSizeEnd() */
+    Containers::Optional<Containers::Array<char>> out;
+    CORRADE_BENCHMARK(1) {
+        out = converter->convertToData(ImageView2D{data.format, size, imageData});
+        _benchmarkOutputSize = out ? out->size() : 0;
+    }
+
+    CORRADE_VERIFY(out);
+}
+
+void PngImageConverterTest::benchmarkSizeBegin() {
+    _benchmarkOutputSize = 0;
+}
+
+std::uint64_t PngImageConverterTest::benchmarkSizeEnd() {
+    return _benchmarkOutputSize;
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::Trade::Test::PngImageConverterTest)
@@ -26,7 +26,7 @@
 
 #include "PngImporter.h"
 
-#include <cstring> /* std::strcmp(), std::memcpy() */
+#include <cstring> /* std::strcmp(), std::memcmp(), std::memcpy(), std::memset() */
 #include <png.h>
 /*
     The <csetjmp> header has to be included *after* png.h, otherwise older
@@ -38,8 +38,11 @@
     New versions don't have that anymore: https://github.com/glennrp/libpng/commit/6c2e919c7eb736d230581a4c925fa67bd901fcf8
 */
 #include <csetjmp> /* setjmp(), libpng why are you still insane */
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/ScopeGuard.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Magnum/PixelFormat.h>
@@ -50,6 +53,175 @@ namespace Magnum { namespace Trade {
 
 using namespace Containers::Literals;
 
+namespace {
+
+UnsignedInt readBigEndian32(const char* const data) {
+    const auto* const d = reinterpret_cast<const UnsignedByte*>(data);
+    return UnsignedInt(d[0]) << 24 | UnsignedInt(d[1]) << 16 | UnsignedInt(d[2]) << 8 | UnsignedInt(d[3]);
+}
+
+UnsignedShort readBigEndian16(const char* const data) {
+    const auto* const d = reinterpret_cast<const UnsignedByte*>(data);
+    return UnsignedShort(d[0] << 8 | d[1]);
+}
+
+char* writeBigEndian32(char* const out, const UnsignedInt value) {
+    out[0] = char(value >> 24);
+    out[1] = char(value >> 16);
+    out[2] = char(value >> 8);
+    out[3] = char(value);
+    return out + 4;
+}
+
+/* CRC-32 as used by PNG chunks, needed because libpng verifies checksums of
+   the chunks synthesized for animation frames */
+UnsignedInt crc32(UnsignedInt crc, const Containers::ArrayView<const char> data) {
+    static const struct Table {
+        Table() {
+            for(UnsignedInt i = 0; i != 256; ++i) {
+                UnsignedInt c = i;
+                for(Int k = 0; k != 8; ++k)
+                    c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                values[i] = c;
+            }
+        }
+
+        UnsignedInt values[256];
+    } table;
+
+    for(const char i: data)
+        crc = table.values[(crc ^ UnsignedByte(i)) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+/* APNG frame control, https://wiki.mozilla.org/APNG_Specification */
+enum: UnsignedByte {
+    DisposeOpNone = 0,
+    DisposeOpBackground = 1,
+    DisposeOpPrevious = 2
+};
+
+enum: UnsignedByte {
+    BlendOpSource = 0,
+    BlendOpOver = 1
+};
+
+struct Frame {
+    /* Offset is from the top left corner, as in the file */
+    Vector2i size, offset;
+    UnsignedByte disposeOp, blendOp;
+    /* Contents of IDAT chunks or fdAT chunks without the sequence number */
+    Containers::Array<Containers::ArrayView<const char>> data;
+};
+
+/* Creates a standalone PNG file with a single frame that libpng can decode.
+   The IHDR chunk gets the frame size, other chunks that were before the first
+   IDAT (palette, transparency, gamma...) are copied as-is and the frame data
+   are concatenated to a single IDAT chunk. */
+Containers::Array<char> framePng(const Containers::ArrayView<const char> header, const Containers::ArrayView<const Containers::ArrayView<const char>> headerChunks, const Frame& frame) {
+    std::size_t size = 8 + 12 + header.size() + 12 + 12;
+    for(const Containers::ArrayView<const char>& chunk: headerChunks)
+        size += chunk.size();
+    std::size_t dataSize = 0;
+    for(const Containers::ArrayView<const char>& data: frame.data)
+        dataSize += data.size();
+    size += dataSize;
+
+    Containers::Array<char> out{NoInit, size};
+    char* i = out.data();
+    std::memcpy(i, "\x89PNG\r\n\x1a\n", 8);
+    i += 8;
+
+    /* IHDR with the frame size */
+    i = writeBigEndian32(i, UnsignedInt(header.size()));
+    char* const headerBegin = i;
+    std::memcpy(i, "IHDR", 4);
+    std::memcpy(i + 4, header.data(), header.size());
+    writeBigEndian32(i + 4, frame.size.x());
+    writeBigEndian32(i + 8, frame.size.y());
+    i += 4 + header.size();
+    i = writeBigEndian32(i, ~crc32(~0u, {headerBegin, std::size_t(i - headerBegin)}));
+
+    for(const Containers::ArrayView<const char>& chunk: headerChunks) {
+        std::memcpy(i, chunk.data(), chunk.size());
+        i += chunk.size();
+    }
+
+    /* IDAT with all frame data */
+    i = writeBigEndian32(i, UnsignedInt(dataSize));
+    char* const dataBegin = i;
+    std::memcpy(i, "IDAT", 4);
+    i += 4;
+    for(const Containers::ArrayView<const char>& data: frame.data) {
+        std::memcpy(i, data.data(), data.size());
+        i += data.size();
+    }
+    i = writeBigEndian32(i, ~crc32(~0u, {dataBegin, std::size_t(i - dataBegin)}));
+
+    /* IEND, with a constant CRC */
+    std::memcpy(i, "\0\0\0\0IEND\xae\x42\x60\x82", 12);
+    i += 12;
+
+    CORRADE_INTERNAL_ASSERT(i == out.end());
+    return out;
+}
+
+/* Blending as specified by APNG, with the alpha being the last channel. For
+   premultiplied alpha the color channels are just scaled by the inverse
+   source alpha. */
+template<class T> void blendOver(char* const dstData, const char* const srcData, const UnsignedInt channelCount, const bool premultiplied) {
+    auto* const dst = reinterpret_cast<T*>(dstData);
+    const auto* const src = reinterpret_cast<const T*>(srcData);
+    constexpr Float Max = Float(T(~T{}));
+    const UnsignedInt alpha = channelCount - 1;
+
+    if(src[alpha] == T(~T{})) {
+        std::memcpy(dst, src, channelCount*sizeof(T));
+        return;
+    }
+    if(src[alpha] == 0)
+        return;
+
+    const Float srcAlpha = src[alpha]/Max;
+    const Float dstAlpha = dst[alpha]/Max;
+    const Float outAlpha = srcAlpha + dstAlpha*(1.0f - srcAlpha);
+    for(UnsignedInt c = 0; c != alpha; ++c) {
+        const Float value = premultiplied ?
+            src[c] + dst[c]*(1.0f - srcAlpha) :
+            (src[c]*srcAlpha + dst[c]*dstAlpha*(1.0f - srcAlpha))/outAlpha;
+        dst[c] = T(Math::min(value + 0.5f, Max));
+    }
+    dst[alpha] = T(outAlpha*Max + 0.5f);
+}
+
+}
+
+struct PngImporter::Animation {
+    /* Contents of the IHDR chunk */
+    Containers::ArrayView<const char> header;
+    /* Whole chunks between IHDR and the first IDAT that aren't APNG-specific,
+       copied to the PNG stream synthesized for each frame */
+    Containers::Array<Containers::ArrayView<const char>> headerChunks;
+    Containers::Array<Frame> frames;
+    /* Exposed through importerState() */
+    Containers::Array<Int> delays;
+    Vector2i size;
+
+    /* Compositing state. The canvas contains the output of the frame before
+       nextFrame, with its disposal not applied yet so it can be returned
+       again without compositing anything, and is Y-flipped like the imported
+       images. If that frame is disposed to previous, the area it overwrote is
+       in `previous`. Configuration that affects the decoded format is
+       remembered to restart the compositing if it changes between imports. */
+    UnsignedInt nextFrame;
+    Containers::String alphaMode;
+    Int forceBitDepth{};
+    PixelFormat format;
+    std::size_t stride;
+    Containers::Array<char> canvas;
+    Containers::Array<char> previous;
+};
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 PngImporter::PngImporter() = default; /* LCOV_EXCL_LINE */
 #endif
@@ -62,7 +234,10 @@ ImporterFeatures PngImporter::doFeatures() const { return ImporterFeature::OpenD
 
 bool PngImporter::doIsOpened() const { return _in; }
 
-void PngImporter::doClose() { _in = nullptr; }
+void PngImporter::doClose() {
+    _in = nullptr;
+    _animation = nullptr;
+}
 
 void PngImporter::doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) {
     /* Because here we're copying the data and using the _in to check if file
@@ -82,11 +257,248 @@ void PngImporter::doOpenData(Containers::Array<char>&& data, DataFlags dataFlags
         _in = Utility::move(data);
     else
         _in = Containers::Array<char>{InPlaceInit, data};
+
+    /* Walk the chunks to find out if the file is an APNG. Only the chunk
+       structure is checked here, everything else including a bad signature
+       is left for libpng to complain about in image2D(). */
+    _animation = nullptr;
+    if(_in.size() < 8 || std::memcmp(_in.data(), "\x89PNG\r\n\x1a\n", 8) != 0)
+        return;
+
+    Containers::Pointer<Animation> animation{InPlaceInit};
+    Containers::Array<Frame> frames;
+    UnsignedInt frameCount = 0;
+    /* fcTL and fdAT chunks share a sequence that has to start at zero and
+       increase by one with each chunk */
+    UnsignedInt sequenceNumber = 0;
+    bool animated = false;
+    bool seenData = false;
+    Containers::ArrayView<const char> in = _in.exceptPrefix(8);
+    while(in.size() >= 12) {
+        const std::size_t length = readBigEndian32(in.data());
+        if(in.size() < 12 + length)
+            break;
+        const Containers::StringView type{in.data() + 4, 4};
+        const Containers::ArrayView<const char> chunk = in.prefix(12 + length);
+        const Containers::ArrayView<const char> chunkData = in.sliceSize(8, length);
+        in = in.exceptPrefix(12 + length);
+
+        if(type == "IHDR"_s) {
+            /* Sizes above 2^31 - 1 are invalid in PNG, leave those for libpng
+               to complain about. The canvas size then always fits into an
+               Int. */
+            if(length != 13)
+                break;
+            const UnsignedInt width = readBigEndian32(chunkData.data());
+            const UnsignedInt height = readBigEndian32(chunkData.data() + 4);
+            if(width > 0x7fffffffu || height > 0x7fffffffu)
+                break;
+            animation->header = chunkData;
+            animation->size = {Int(width), Int(height)};
+        } else if(type == "acTL"_s) {
+            if(length != 8) {
+                Error{} << "Trade::PngImporter::openData(): invalid acTL chunk size" << length;
+                _in = nullptr;
+                return;
+            }
+            animated = true;
+            frameCount = readBigEndian32(chunkData.data());
+        } else if(type == "fcTL"_s) {
+            if(length != 26) {
+                Error{} << "Trade::PngImporter::openData(): invalid fcTL chunk size" << length;
+                _in = nullptr;
+                return;
+            }
+            if(readBigEndian32(chunkData.data()) != sequenceNumber) {
+                Error{} << "Trade::PngImporter::openData(): expected fcTL sequence number" << sequenceNumber << "but got" << readBigEndian32(chunkData.data());
+                _in = nullptr;
+                return;
+            }
+            ++sequenceNumber;
+
+            /* The values come from the file, so do the bounds check on the
+               unsigned values in 64 bits to avoid overflows. Once it passes,
+               everything is within the canvas size and thus fits into an
+               Int. */
+            const Vector2ui size{readBigEndian32(chunkData.data() + 4),
+                                 readBigEndian32(chunkData.data() + 8)};
+            const Vector2ui offset{readBigEndian32(chunkData.data() + 12),
+                                   readBigEndian32(chunkData.data() + 16)};
+            if(!size.x() || !size.y() ||
+               UnsignedLong{offset.x()} + size.x() > UnsignedLong(animation->size.x()) ||
+               UnsignedLong{offset.y()} + size.y() > UnsignedLong(animation->size.y())) {
+                Error{} << "Trade::PngImporter::openData(): frame" << frames.size() << "with size" << Debug::packed << size << "and offset" << Debug::packed << offset << "out of bounds for a" << Debug::packed << animation->size << "image";
+                _in = nullptr;
+                return;
+            }
+            Frame frame;
+            frame.size = Vector2i{size};
+            frame.offset = Vector2i{offset};
+            /* Zero denominator means hundredths of a second */
+            const UnsignedShort delayNumerator = readBigEndian16(chunkData.data() + 20);
+            const UnsignedShort delayDenominator = readBigEndian16(chunkData.data() + 22);
+            arrayAppend(animation->delays, Int(delayNumerator*1000/(delayDenominator ? delayDenominator : 100)));
+            frame.disposeOp = chunkData[24];
+            frame.blendOp = chunkData[25];
+            /* Restoring to previous for the first frame is treated as
+               clearing to background */
+            if(frames.isEmpty() && frame.disposeOp == DisposeOpPrevious)
+                frame.disposeOp = DisposeOpBackground;
+            arrayAppend(frames, Utility::move(frame));
+        } else if(type == "IDAT"_s) {
+            /* The default image is a part of the animation only if there was
+               a fcTL chunk before it */
+            seenData = true;
+            if(frames.size() == 1)
+                arrayAppend(frames.back().data, chunkData);
+        } else if(type == "fdAT"_s) {
+            if(frames.isEmpty() || length < 4) {
+                Error{} << "Trade::PngImporter::openData(): unexpected fdAT chunk";
+                _in = nullptr;
+                return;
+            }
+            if(readBigEndian32(chunkData.data()) != sequenceNumber) {
+                Error{} << "Trade::PngImporter::openData(): expected fdAT sequence number" << sequenceNumber << "but got" << readBigEndian32(chunkData.data());
+                _in = nullptr;
+                return;
+            }
+            ++sequenceNumber;
+            arrayAppend(frames.back().data, chunkData.exceptPrefix(4));
+        } else if(type == "IEND"_s) {
+            break;
+        } else if(!seenData) {
+            arrayAppend(animation->headerChunks, chunk);
+        }
+    }
+
+    if(!animated)
+        return;
+    if(!frameCount || frames.size() != frameCount) {
+        Error{} << "Trade::PngImporter::openData(): expected" << frameCount << "animation frames but got" << frames.size();
+        _in = nullptr;
+        return;
+    }
+    for(std::size_t i = 0; i != frames.size(); ++i) if(frames[i].data.isEmpty()) {
+        Error{} << "Trade::PngImporter::openData(): no data for animation frame" << i;
+        _in = nullptr;
+        return;
+    }
+
+    animation->frames = Utility::move(frames);
+    animation->nextFrame = 0;
+    _animation = Utility::move(animation);
 }
 
-UnsignedInt PngImporter::doImage2DCount() const { return 1; }
+UnsignedInt PngImporter::doImage2DCount() const {
+    return _animation ? _animation->frames.size() : 1;
+}
+
+const void* PngImporter::doImporterState() const {
+    return _animation ? _animation->delays.data() : nullptr;
+}
+
+Containers::Optional<ImageData2D> PngImporter::doImage2D(const UnsignedInt id, UnsignedInt) {
+    if(!_animation)
+        return decode(_in, true);
+
+    /* If the configuration changed since the last import, the canvas is no
+       longer valid. Otherwise, the last composited frame is still on the
+       canvas and can be returned again directly, and going back further
+       restarts the compositing from the first frame. */
+    Animation& animation = *_animation;
+    const Containers::StringView alphaMode = configuration().value<Containers::StringView>("alphaMode");
+    const Int forceBitDepth = configuration().value<Int>("forceBitDepth");
+    if(id + 1 < animation.nextFrame || alphaMode != animation.alphaMode || forceBitDepth != animation.forceBitDepth)
+        animation.nextFrame = 0;
+
+    /* Pointer to the bottom row of given frame on the Y-flipped canvas */
+    const auto canvasRow = [&animation](const Frame& frame, const Int y) {
+        return animation.canvas.data() + (animation.size.y() - frame.offset.y() - frame.size.y() + y)*animation.stride + frame.offset.x()*pixelFormatSize(animation.format);
+    };
+
+    const bool premultiplied = !alphaMode.isEmpty();
+    while(animation.nextFrame <= id) {
+        /* Dispose the previous frame first */
+        if(animation.nextFrame != 0) {
+            const Frame& previousFrame = animation.frames[animation.nextFrame - 1];
+            const std::size_t previousRowSize = previousFrame.size.x()*pixelFormatSize(animation.format);
+            if(previousFrame.disposeOp == DisposeOpBackground) {
+                for(Int y = 0; y != previousFrame.size.y(); ++y)
+                    std::memset(canvasRow(previousFrame, y), 0, previousRowSize);
+            } else if(previousFrame.disposeOp == DisposeOpPrevious) {
+                for(Int y = 0; y != previousFrame.size.y(); ++y)
+                    std::memcpy(canvasRow(previousFrame, y), animation.previous.data() + y*previousRowSize, previousRowSize);
+            }
+        }
+
+        const Frame& frame = animation.frames[animation.nextFrame];
+        Containers::Optional<ImageData2D> image = decode(framePng(animation.header, animation.headerChunks, frame), false);
+        if(!image) {
+            animation.nextFrame = 0;
+            return {};
+        }
+
+        /* Start with a transparent black canvas. All frames share the header
+           chunks, so with the same configuration they all decode to the same
+           format. */
+        if(animation.nextFrame == 0) {
+            animation.alphaMode = Containers::String{alphaMode};
+            animation.forceBitDepth = forceBitDepth;
+            animation.format = image->format();
+            animation.stride = 4*((animation.size.x()*pixelFormatSize(animation.format) + 3)/4);
+            animation.canvas = Containers::Array<char>{ValueInit, animation.stride*animation.size.y()};
+        }
+        CORRADE_INTERNAL_ASSERT(image->format() == animation.format);
 
-Containers::Optional<ImageData2D> PngImporter::doImage2D(UnsignedInt, UnsignedInt) {
+        const std::size_t pixelSize = pixelFormatSize(animation.format);
+        const std::size_t frameStride = 4*((frame.size.x()*pixelSize + 3)/4);
+        const std::size_t frameRowSize = frame.size.x()*pixelSize;
+
+        /* Save the area that's going to be restored when disposing */
+        if(frame.disposeOp == DisposeOpPrevious) {
+            animation.previous = Containers::Array<char>{NoInit, frameRowSize*frame.size.y()};
+            for(Int y = 0; y != frame.size.y(); ++y)
+                std::memcpy(animation.previous.data() + y*frameRowSize, canvasRow(frame, y), frameRowSize);
+        }
+
+        /* Composite the frame */
+        const UnsignedInt channelCount = pixelFormatChannelCount(animation.format);
+        const bool hasAlpha = channelCount == 2 || channelCount == 4;
+        for(Int y = 0; y != frame.size.y(); ++y) {
+            const char* const src = image->data().data() + y*frameStride;
+            char* const dst = canvasRow(frame, y);
+            if(frame.blendOp != BlendOpOver || !hasAlpha) {
+                std::memcpy(dst, src, frameRowSize);
+                continue;
+            }
+            for(Int x = 0; x != frame.size.x(); ++x) {
+                if(pixelSize/channelCount == 2)
+                    blendOver<UnsignedShort>(dst + x*pixelSize, src + x*pixelSize, channelCount, premultiplied);
+                else
+                    blendOver<UnsignedByte>(dst + x*pixelSize, src + x*pixelSize, channelCount, premultiplied);
+            }
+        }
+
+        ++animation.nextFrame;
+    }
+
+    /* The canvas now contains the requested frame, copy it out either to the
+       caller-provided buffer or to a new array */
+    CORRADE_INTERNAL_ASSERT(animation.nextFrame == id + 1);
+    const std::size_t dataSize = animation.canvas.size();
+    if(!_outputBuffer.isEmpty()) {
+        if(_outputBuffer.size() < dataSize) {
+            Error{} << "Trade::PngImporter::image2D(): expected an output buffer of at least" << dataSize << "bytes for a" << Debug::packed << animation.size << "image but got" << _outputBuffer.size();
+            return {};
+        }
+        Utility::copy(animation.canvas, _outputBuffer.prefix(dataSize));
+        return ImageData2D{animation.format, animation.size, DataFlag::Mutable, _outputBuffer.prefix(dataSize)};
+    }
+
+    return ImageData2D{animation.format, animation.size, Containers::Array<char>{InPlaceInit, animation.canvas}};
+}
+
+Containers::Optional<ImageData2D> PngImporter::decode(const Containers::ArrayView<const char> in, const bool direct) {
     /* Structures for reading the file */
     png_structp file = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     /** @todo this will assert if the PNG major/minor version doesn't match,
@@ -104,7 +516,6 @@ Containers::Optional<ImageData2D> PngImporter::doImage2D(UnsignedInt, UnsignedIn
     Containers::ScopeGuard pngStateGuard{&pngState, [](PngState* state) {
         png_destroy_read_struct(&state->file, &state->info, nullptr);
     }};
-    Containers::Array<png_bytep> rows;
     Containers::Array<char> data;
 
     /* Error handling routine. Since we're replacing the png_default_error()
@@ -129,9 +540,9 @@ Containers::Optional<ImageData2D> PngImporter::doImage2D(UnsignedInt, UnsignedIn
     );
 
     /* Set functions for reading */
-    Containers::ArrayView<char> input = _in;
+    Containers::ArrayView<const char> input = in;
     png_set_read_fn(file, &input, [](const png_structp file, const png_bytep data, const png_size_t length) {
-        auto&& input = *reinterpret_cast<Containers::ArrayView<char>*>(png_get_io_ptr(file));
+        auto&& input = *reinterpret_cast<Containers::ArrayView<const char>*>(png_get_io_ptr(file));
         if(input.size() < length)
             png_error(file, "file too short");
         std::memcpy(data, input.begin(), length);
@@ -307,8 +718,24 @@ Containers::Optional<ImageData2D> PngImporter::doImage2D(UnsignedInt, UnsignedIn
 
     /* Initialize data array, align rows to four bytes */
     CORRADE_INTERNAL_ASSERT(bits >= 8);
-    const std::size_t stride = ((size.x()*channels*bits/8 + 3)/4)*4;
-    data = Containers::Array<char>{stride*std::size_t(size.y())};
+    const std::size_t rowSize = size.x()*channels*bits/8;
+    const std::size_t stride = ((rowSize + 3)/4)*4;
+    const std::size_t dataSize = stride*std::size_t(size.y());
+
+    /* Decode either directly into the caller-provided buffer or into a newly
+       allocated array */
+    char* out;
+    const bool useOutputBuffer = direct && !_outputBuffer.isEmpty();
+    if(useOutputBuffer) {
+        if(_outputBuffer.size() < dataSize) {
+            Error{} << "Trade::PngImporter::image2D(): expected an output buffer of at least" << dataSize << "bytes for a" << Debug::packed << size << "image but got" << _outputBuffer.size();
+            return {};
+        }
+        out = _outputBuffer.data();
+    } else {
+        data = Containers::Array<char>{dataSize};
+        out = data.data();
+    }
 
     /* Endianness correction for 16 bit depth */
     #ifndef CORRADE_TARGET_BIG_ENDIAN
@@ -316,11 +743,20 @@ Containers::Optional<ImageData2D> PngImporter::doImage2D(UnsignedInt, UnsignedIn
         png_set_swap(file);
     #endif
 
-    /* Read image row by row */
-    rows = Containers::Array<png_bytep>{std::size_t(size.y())};
-    for(Int i = 0; i != size.y(); ++i)
-        rows[i] = reinterpret_cast<unsigned char*>(data.data()) + (size.y() - i - 1)*stride;
-    png_read_image(file, rows);
+    /* Read image row by row. Compared to png_read_image() this doesn't need a
+       temporary array of row pointers and allows the caller to be notified
+       about each decoded row. Interlaced images have the rows progressively
+       filled in each pass, so they're complete only in the last one. */
+    const Int passCount = png_set_interlace_handling(file);
+    for(Int pass = 0; pass != passCount; ++pass) {
+        for(Int i = 0; i != size.y(); ++i) {
+            const Int y = size.y() - i - 1;
+            char* const row = out + y*stride;
+            png_read_row(file, reinterpret_cast<png_bytep>(row), nullptr);
+            if(direct && _rowCallback && pass == passCount - 1)
+                _rowCallback(y, {row, rowSize}, _rowCallbackUserData);
+        }
+    }
 
     /* 8-bit images */
     PixelFormat format;
@@ -349,7 +785,10 @@ Containers::Optional<ImageData2D> PngImporter::doImage2D(UnsignedInt, UnsignedIn
        Only 1, 2, 4, 8 or 16 bits per channel, we expand the 1/2/4 to 8 above */
     } else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
 
-    /* Always using the default 4-byte alignment */
+    /* Always using the default 4-byte alignment. If decoded into the
+       caller-provided buffer, return a non-owning view on it. */
+    if(useOutputBuffer)
+        return Trade::ImageData2D{format, size, DataFlag::Mutable, _outputBuffer.prefix(dataSize)};
     return Trade::ImageData2D{format, size, Utility::move(data)};
 }
 
@@ -31,6 +31,7 @@
  */
 
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Magnum/Trade/AbstractImporter.h>
 
 #include "MagnumPlugins/PngImporter/configure.h"
@@ -143,6 +144,61 @@ has the support.
 The test for this plugin contains a file that can be used for verifying CgBI
 support.
 
+@subsection Trade-PngImporter-behavior-streaming Decoding into a caller-provided memory
+
+By default, each @ref image2D() call allocates a new data array for the
+decoded image. When decoding many images of the same size and format, for
+example in a tile server, it's possible to pass a reusable staging buffer to
+@ref setOutputBuffer(). Then the image is decoded directly into it and
+@ref image2D() returns an @ref ImageData2D that references the buffer instead
+of owning the data, with @ref DataFlag::Mutable set. The buffer is expected
+to be large enough to fit the image with four-byte aligned rows, and has to
+stay in scope for as long as the returned image is used. If it's too small,
+the import fails.
+
+Independently of that, with @ref setRowCallback() it's possible to get
+notified about each row as soon as it's decoded, which allows downstream
+processing to start before the whole image is decoded. Rows are delivered in
+the order they're stored in the file, which is from the top of the image,
+i.e. with the Y coordinate going from @cpp size.y() - 1 @ce down to
+@cpp 0 @ce. For interlaced files the rows are only complete after the last
+interlacing pass, so the callback is called only during that pass.
+
+Both APIs are defined inline and only set internal state that's consumed by
+@ref image2D(), which means they can be used also with a plugin instance
+that's loaded dynamically. If the plugin name is known to be
+@cpp "PngImporter" @ce, cast the @ref AbstractImporter instance to
+@ref PngImporter to access them:
+
+@code{.cpp}
+Containers::Pointer<Trade::AbstractImporter> importer =
+    manager.instantiate("PngImporter");
+Containers::Array<char> staging{NoInit, 256*256*4};
+static_cast<Trade::PngImporter&>(*importer).setOutputBuffer(staging);
+@endcode
+
+@subsection Trade-PngImporter-behavior-apng Animated PNGs
+
+If the file contains an [APNG](https://wiki.mozilla.org/APNG_Specification)
+animation, the importer reports the animation frame count in
+@ref image2DCount() and each frame can be imported separately. If the default
+image isn't a part of the animation, it's not exposed. Similarly to
+@ref Trade-StbImageImporter-behavior-animated-gifs "animated GIFs in StbImageImporter",
+frame delays are exposed through @ref importerState() as an array of
+@ref Magnum::Int "Int", where each entry is number of milliseconds to wait
+before advancing to the next frame.
+
+Opening the file only walks the chunk structure, the frames are decoded and
+composited on demand in @ref image2D(), with the frame disposal and blending
+operations applied according to the specification. Apart from the file data,
+only the compositing canvas is kept in memory. As each frame is composited on
+top of the previous ones, importing frames in order is the fastest. Importing
+the last imported frame again returns it without any decoding, going back
+further or changing the configuration restarts the compositing from the first
+frame. The output buffer set with
+@ref setOutputBuffer() is used for the composited frame, the row callback set
+with @ref setRowCallback() isn't called for animation frames.
+
 @section Trade-PngImporter-configuration Plugin-specific configuration
 
 For some formats, it's possible to tune various output options through
@@ -170,6 +226,58 @@ class MAGNUM_PNGIMPORTER_EXPORT PngImporter: public AbstractImporter {
 
         ~PngImporter();
 
+        /**
+         * @brief Output buffer
+         *
+         * Empty by default. See @ref setOutputBuffer() for more information.
+         */
+        Containers::ArrayView<char> outputBuffer() const {
+            return _outputBuffer;
+        }
+
+        /**
+         * @brief Set output buffer
+         *
+         * If non-empty, @ref image2D() decodes the image directly into
+         * @p buffer and returns a non-owning @ref ImageData2D referencing it
+         * instead of allocating a new data array. Pass an empty view to go
+         * back to the default behavior. See
+         * @ref Trade-PngImporter-behavior-streaming for more information.
+         */
+        void setOutputBuffer(Containers::ArrayView<char> buffer) {
+            _outputBuffer = buffer;
+        }
+
+        /**
+         * @brief Row callback function
+         *
+         * See @ref setRowCallback() for more information.
+         */
+        auto rowCallback() const -> void(*)(Int, Containers::ArrayView<const char>, void*) {
+            return _rowCallback;
+        }
+
+        /**
+         * @brief Row callback user data
+         *
+         * See @ref setRowCallback() for more information.
+         */
+        void* rowCallbackUserData() const { return _rowCallbackUserData; }
+
+        /**
+         * @brief Set row callback
+         *
+         * The @p callback is called from @ref image2D() with the Y coordinate
+         * of each row, its decoded data without row padding and
+         * @p userData as soon as the row is decoded. Pass @cpp nullptr @ce
+         * to reset the callback. See @ref Trade-PngImporter-behavior-streaming
+         * for more information.
+         */
+        void setRowCallback(void(*callback)(Int row, Containers::ArrayView<const char> data, void* userData), void* userData = nullptr) {
+            _rowCallback = callback;
+            _rowCallbackUserData = userData;
+        }
+
     private:
         MAGNUM_PNGIMPORTER_LOCAL ImporterFeatures doFeatures() const override;
         MAGNUM_PNGIMPORTER_LOCAL bool doIsOpened() const override;
@@ -179,7 +287,19 @@ class MAGNUM_PNGIMPORTER_EXPORT PngImporter: public AbstractImporter {
         MAGNUM_PNGIMPORTER_LOCAL UnsignedInt doImage2DCount() const override;
         MAGNUM_PNGIMPORTER_LOCAL Containers::Optional<ImageData2D> doImage2D(UnsignedInt id, UnsignedInt level) override;
 
+        MAGNUM_PNGIMPORTER_LOCAL const void* doImporterState() const override;
+
+        /* If direct is set, decodes into the output buffer and calls the row
+           callback, otherwise always into a new array */
+        MAGNUM_PNGIMPORTER_LOCAL Containers::Optional<ImageData2D> decode(Containers::ArrayView<const char> in, bool direct);
+
+        struct Animation;
+
         Containers::Array<char> _in;
+        Containers::Pointer<Animation> _animation;
+        Containers::ArrayView<char> _outputBuffer;
+        void(*_rowCallback)(Int, Containers::ArrayView<const char>, void*){};
+        void* _rowCallbackUserData{};
 };
 
 }}
@@ -24,6 +24,7 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include <cstring> /* std::memcpy() */
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Containers/String.h>
@@ -40,6 +41,8 @@
 #include <Magnum/Trade/AbstractImporter.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "MagnumPlugins/PngImporter/PngImporter.h"
+
 #include "configure.h"
 
 #include <png.h> /* PNG_WARNINGS_SUPPORTED */
@@ -68,6 +71,14 @@ struct PngImporterTest: TestSuite::Tester {
     void forceBitDepth16();
     void forceBitDepthInvalid();
 
+    void outputBuffer();
+    void outputBufferTooSmall();
+    void rowCallback();
+
+    void animated();
+    void animatedInvalidFrameCount();
+    void animatedInvalid();
+
     void openMemory();
     void openTwice();
     void importTwice();
@@ -180,6 +191,8 @@ constexpr struct {
     {"RGB, premultiplied alpha", "rgb.png", true},
     /* convert rgb.png -define png:exclude-chunks=date png8:palette.png */
     {"palette", "rgb-palette.png", false},
+    /* rgb.png saved with Adam7 interlacing, see README.md */
+    {"interlaced", "rgb-interlaced.png", false},
 };
 
 constexpr struct {
@@ -308,6 +321,34 @@ const struct {
     }}, false, nullptr}
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+} RowCallbackData[]{
+    {"", "rgb.png"},
+    {"interlaced", "rgb-interlaced.png"},
+};
+
+const struct {
+    const char* name;
+    std::size_t offset;
+    UnsignedInt value;
+    const char* message;
+} AnimatedInvalidData[]{
+    /* Offsets point to the second frame fcTL, the third frame fcTL and the
+       second frame fdAT in animated.png */
+    {"frame offset out of bounds", 141, 0x7fffffff,
+        "frame 1 with size {2, 2} and offset {2147483647, 1} out of bounds for a {4, 3} image"},
+    {"frame size out of bounds", 137, 0xffffffff,
+        "frame 1 with size {2, 4294967295} and offset {1, 1} out of bounds for a {4, 3} image"},
+    {"zero frame size", 133, 0,
+        "frame 1 with size {0, 2} and offset {1, 1} out of bounds for a {4, 3} image"},
+    {"fcTL sequence number", 203, 4,
+        "expected fcTL sequence number 3 but got 4"},
+    {"fdAT sequence number", 167, 5,
+        "expected fdAT sequence number 2 but got 5"},
+};
+
 /* Shared among all plugins that implement data copying optimizations */
 const struct {
     const char* name;
@@ -360,7 +401,19 @@ PngImporterTest::PngImporterTest() {
     addInstancedTests({&PngImporterTest::forceBitDepth16},
         Containers::arraySize(ForceBitDepth16Data));
 
-    addTests({&PngImporterTest::forceBitDepthInvalid});
+    addTests({&PngImporterTest::forceBitDepthInvalid,
+
+              &PngImporterTest::outputBuffer,
+              &PngImporterTest::outputBufferTooSmall});
+
+    addInstancedTests({&PngImporterTest::rowCallback},
+        Containers::arraySize(RowCallbackData));
+
+    addTests({&PngImporterTest::animated,
+              &PngImporterTest::animatedInvalidFrameCount});
+
+    addInstancedTests({&PngImporterTest::animatedInvalid},
+        Containers::arraySize(AnimatedInvalidData));
 
     addInstancedTests({&PngImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
@@ -781,6 +834,181 @@ void PngImporterTest::forceBitDepthInvalid() {
     CORRADE_COMPARE(out, "Trade::PngImporter::image2D(): expected forceBitDepth to be 0, 8 or 16 but got 4\n");
 }
 
+void PngImporterTest::outputBuffer() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PngImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(PNGIMPORTER_TEST_DIR, "rgb.png")));
+
+    Containers::Optional<Trade::ImageData2D> expected = importer->image2D(0);
+    CORRADE_VERIFY(expected);
+    CORRADE_COMPARE(expected->dataFlags(), DataFlag::Owned|DataFlag::Mutable);
+
+    /* Larger than needed, the returned image should reference only a prefix */
+    char buffer[32]{};
+    PngImporter& pngImporter = static_cast<PngImporter&>(*importer);
+    pngImporter.setOutputBuffer(buffer);
+    CORRADE_COMPARE(pngImporter.outputBuffer().data(), static_cast<void*>(buffer));
+
+    /* Import twice to verify the buffer gets reused */
+    for(std::size_t i = 0; i != 2; ++i) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE(image->dataFlags(), DataFlag::Mutable);
+        CORRADE_COMPARE(image->data().data(), static_cast<void*>(buffer));
+        CORRADE_COMPARE(image->data().size(), 24);
+        CORRADE_COMPARE(image->format(), PixelFormat::RGB8Unorm);
+        CORRADE_COMPARE(image->size(), (Vector2i{3, 2}));
+        CORRADE_COMPARE_AS(image->pixels<Color3ub>(),
+            expected->pixels<Color3ub>(),
+            TestSuite::Compare::Container);
+    }
+
+    /* Resetting the buffer goes back to allocating */
+    pngImporter.setOutputBuffer(nullptr);
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->dataFlags(), DataFlag::Owned|DataFlag::Mutable);
+    CORRADE_VERIFY(image->data().data() != static_cast<void*>(buffer));
+}
+
+void PngImporterTest::outputBufferTooSmall() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PngImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(PNGIMPORTER_TEST_DIR, "rgb.png")));
+
+    char buffer[23];
+    static_cast<PngImporter&>(*importer).setOutputBuffer(buffer);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, "Trade::PngImporter::image2D(): expected an output buffer of at least 24 bytes for a {3, 2} image but got 23\n");
+}
+
+void PngImporterTest::rowCallback() {
+    auto&& data = RowCallbackData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PngImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(PNGIMPORTER_TEST_DIR, data.filename)));
+
+    struct State {
+        Int rows[4];
+        std::size_t count;
+        char data[4][9];
+    } state{};
+    PngImporter& pngImporter = static_cast<PngImporter&>(*importer);
+    pngImporter.setRowCallback([](Int row, Containers::ArrayView<const char> data, void* userData) {
+        State& state = *static_cast<State*>(userData);
+        CORRADE_INTERNAL_ASSERT(state.count < 4 && data.size() == 9);
+        state.rows[state.count] = row;
+        std::memcpy(state.data[state.count], data.data(), data.size());
+        ++state.count;
+    }, &state);
+    CORRADE_COMPARE(pngImporter.rowCallbackUserData(), &state);
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+
+    /* Each row should be reported once, in the order they're stored in the
+       file, and with the data being already final */
+    CORRADE_COMPARE(state.count, 2);
+    CORRADE_COMPARE(state.rows[0], 1);
+    CORRADE_COMPARE(state.rows[1], 0);
+    CORRADE_COMPARE_AS(Containers::arrayView(state.data[0]),
+        image->data().sliceSize(12, 9),
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE_AS(Containers::arrayView(state.data[1]),
+        image->data().prefix(9),
+        TestSuite::Compare::Container);
+
+    /* Resetting the callback doesn't call it anymore */
+    pngImporter.setRowCallback(nullptr);
+    CORRADE_VERIFY(!pngImporter.rowCallback());
+    CORRADE_VERIFY(importer->image2D(0));
+    CORRADE_COMPARE(state.count, 2);
+}
+
+void PngImporterTest::animated() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PngImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(PNGIMPORTER_TEST_DIR, "animated.png")));
+    CORRADE_COMPARE(importer->image2DCount(), 4);
+
+    /* Delays in milliseconds */
+    CORRADE_VERIFY(importer->importerState());
+    CORRADE_COMPARE_AS((Containers::ArrayView<const Int>{static_cast<const Int*>(importer->importerState()), 4}), Containers::arrayView<Int>({
+        100, 50, 30, 1000
+    }), TestSuite::Compare::Container);
+
+    /* Bottom row first. The first frame is the default image, the second is
+       blended over it, including one half-transparent pixel, and cleared to
+       background after, the third replaces a single pixel and gets restored
+       to previous after, and the fourth replaces a single pixel again. */
+    const Color4ub expected[][12]{
+        {0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba,
+         0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba,
+         0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba},
+        {0xff0000ff_rgba, 0xff0000ff_rgba, 0x00ff00ff_rgba, 0xff0000ff_rgba,
+         0xff0000ff_rgba, 0x00ff00ff_rgba, 0x7f0080ff_rgba, 0xff0000ff_rgba,
+         0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba},
+        {0xff0000ff_rgba, 0x00000000_rgba, 0x00000000_rgba, 0xff0000ff_rgba,
+         0xff0000ff_rgba, 0x00000000_rgba, 0x00000000_rgba, 0xff0000ff_rgba,
+         0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba, 0x0000ffff_rgba},
+        {0xffffffff_rgba, 0x00000000_rgba, 0x00000000_rgba, 0xff0000ff_rgba,
+         0xff0000ff_rgba, 0x00000000_rgba, 0x00000000_rgba, 0xff0000ff_rgba,
+         0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba, 0xff0000ff_rgba},
+    };
+
+    /* Going forward, repeating a frame and going back, which restarts the
+       compositing */
+    for(UnsignedInt i: {0, 1, 2, 3, 3, 1, 2, 0}) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(i);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE(image->format(), PixelFormat::RGBA8Unorm);
+        CORRADE_COMPARE(image->size(), (Vector2i{4, 3}));
+        CORRADE_COMPARE_AS(image->pixels<Color4ub>().asContiguous(),
+            Containers::arrayView(expected[i]),
+            TestSuite::Compare::Container);
+    }
+}
+
+void PngImporterTest::animatedInvalidFrameCount() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PngImporter");
+    Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(PNGIMPORTER_TEST_DIR, "animated.png"));
+    CORRADE_VERIFY(data);
+
+    /* Patch the frame count in acTL to be one more */
+    CORRADE_COMPARE(Containers::StringView{data->sliceSize(37, 4)}, "acTL"_s);
+    CORRADE_COMPARE((*data)[44], '\x04');
+    (*data)[44] = '\x05';
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openData(*data));
+    CORRADE_COMPARE(out, "Trade::PngImporter::openData(): expected 5 animation frames but got 4\n");
+}
+
+void PngImporterTest::animatedInvalid() {
+    auto&& data = AnimatedInvalidData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("PngImporter");
+    Containers::Optional<Containers::Array<char>> file = Utility::Path::read(Utility::Path::join(PNGIMPORTER_TEST_DIR, "animated.png"));
+    CORRADE_VERIFY(file);
+
+    /* Patch a big-endian value. The chunk CRC isn't checked when walking the
+       chunks so it doesn't need to be updated. */
+    (*file)[data.offset + 0] = char(data.value >> 24);
+    (*file)[data.offset + 1] = char(data.value >> 16);
+    (*file)[data.offset + 2] = char(data.value >> 8);
+    (*file)[data.offset + 3] = char(data.value);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openData(*file));
+    CORRADE_COMPARE(out, Utility::format("Trade::PngImporter::openData(): {}\n", data.message));
+}
+
 void PngImporterTest::openMemory() {
     /* Same as gray16() except that it uses openData() & openMemory() instead
        of openFile() to test data copying on import */
@@ -26,21 +26,118 @@
 
 #include "ResvgImporter.h"
 
+#include <atomic>
+#include <cstring>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Containers/StringView.h>
+#include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Math/Color.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Matrix3.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/threadsAndCache.h"
+
 #include <resvg.h>
 
 namespace Magnum { namespace Trade {
 
 using namespace Containers::Literals;
 
+namespace {
+
+resvg_transform toResvg(const Matrix3& matrix) {
+    /* Total guesswork but based on resvg_transform_identity() returning
+       100100 I assume the matrix layout is the following, i.e.
+       column-major:
+
+        a c e   1 0 0
+        b d f   0 1 0
+
+       Thus compatible with Matrix3x2 and can be cast directly to it. */
+    resvg_transform transform;
+    Matrix3x2::from(&transform.a) = Matrix3x2{matrix};
+    return transform;
+}
+
+/* Size of the image rasterized at given scaling. The rounding (and DPI being
+   queried as a float) is verified in the load() test. */
+Vector2i imageSize(const resvg_render_tree* const tree, const Float scaling) {
+    const resvg_size size = resvg_get_image_size(tree);
+    return {Int(Math::round(size.width*scaling)),
+            Int(Math::round(size.height*scaling))};
+}
+
+/* Renders given area of the image into zero-initialized memory. The
+   translation is applied after the Y flip, so the area is in the output
+   pixel space. */
+void renderArea(const resvg_render_tree* const tree, const Matrix3& transform, const Range2Di& area, char* const out) {
+    resvg_render(tree, toResvg(Matrix3::translation(-Vector2{area.min()})*transform), area.sizeX(), area.sizeY(), out);
+}
+
+/* Renders the whole tree either at once or, if tileSize is non-zero, in tiles
+   distributed among threads, rendered into a per-thread scratch buffer and
+   copied into a single image. The output is premultiplied, exactly as
+   produced by resvg_render(). */
+Containers::Array<char> render(const resvg_render_tree* const tree, const Matrix3& transform, const Vector2i& size, const Vector2i& tileSize, const std::size_t threadCount) {
+    /* Useless behavior -- resvg_render() renders *onto* a bitmap, i.e. not
+       just writing to it but blending there. Thus the output memory has to be
+       zero-initialized and then the rendering operation does extra work that
+       cannot be turned off and could be better done by something else. Could
+       use it to specify background color for example, but then there's the
+       problem with incorrect premultiplication below (and thus likely
+       incorrect sRGB handling when blending as well) so ... */
+    /** @todo expose the background color option nevertheless? */
+    if(!tileSize.product()) {
+        Containers::Array<char> data{ValueInit, std::size_t(size.product()*4)};
+        renderArea(tree, transform, {{}, size}, data.data());
+        return data;
+    }
+
+    /* The tiles cover the whole image, so the output doesn't need to be
+       zero-initialized */
+    const Vector2i tileCount = (size + tileSize - Vector2i{1})/tileSize;
+    const std::size_t totalTileCount = std::size_t(tileCount.product());
+    Containers::Array<char> data{NoInit, std::size_t(size.product()*4)};
+    const Containers::StridedArrayView3D<char> image{data, {
+        std::size_t(size.y()), std::size_t(size.x()), 4}};
+
+    /* The tree isn't modified by resvg_render(), so it can be shared among
+       the threads. Tiles are ordered in rows starting from the bottom left,
+       the same as pixels. */
+    std::atomic<std::size_t> nextTile{0};
+    const auto worker = [&]() {
+        Containers::Array<char> scratch{NoInit, std::size_t(tileSize.product()*4)};
+
+        for(std::size_t i; (i = nextTile++) < totalTileCount; ) {
+            const Vector2i offset = tileSize*Vector2i{Int(i % tileCount.x()),
+                                                      Int(i / tileCount.x())};
+            const Range2Di area{offset, Math::min(offset + tileSize, size)};
+            const Containers::StridedArrayView3D<char> tile{scratch, {
+                std::size_t(area.sizeY()), std::size_t(area.sizeX()), 4}};
+            std::memset(scratch.data(), 0, area.size().product()*4);
+
+            renderArea(tree, transform, area, scratch.data());
+            Utility::copy(tile, image.sliceSize(
+                {std::size_t(offset.y()), std::size_t(offset.x()), 0},
+                tile.size()));
+        }
+    };
+
+    Implementation::runInThreads(Math::min(threadCount, totalTileCount), worker);
+
+    return data;
+}
+
+}
+
 struct ResvgImporter::State {
     explicit State() {
         options = resvg_options_create();
@@ -60,6 +157,18 @@ struct ResvgImporter::State {
     Float dpi; /* set in doOpenFile() */
     resvg_options* options;
     resvg_render_tree* tree{};
+
+    /* Rasterized images kept for repeated imports, limited by the cacheSize
+       budget. The data are premultiplied, exactly as produced by
+       resvg_render(). */
+    Implementation::ImageCache cache;
+
+    /* Tiling options, set in doOpenData() */
+    Vector2i tileSize;
+    bool tileImages;
+    /* With tileImages enabled, areas of the image covered by each tile,
+       referenced from importerState() of the imported tiles */
+    Containers::Array<Range2Di> tiles;
 };
 
 ResvgImporter::ResvgImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin) : AbstractImporter{manager, plugin} {}
@@ -105,6 +214,18 @@ void ResvgImporter::doOpenData(Containers::Array<char>&& data, DataFlags) {
     if(!_state)
         _state.emplace();
 
+    /* The tiling options affect the image count, so they're cached on
+       opening, similarly to the DPI. Checking them before parsing so people
+       don't just wait ages for doomed-to-fail import with large files. */
+    const Vector2i tileSize = configuration().value<Vector2i>("tileSize");
+    if(tileSize != Vector2i{} && !(tileSize > Vector2i{0}).all()) {
+        Error{} << "Trade::ResvgImporter::openData(): expected tileSize to be either empty or positive but got" << Debug::packed << tileSize;
+        _state = nullptr;
+        return;
+    }
+    _state->tileSize = tileSize;
+    _state->tileImages = tileSize.product() && configuration().value<bool>("tileImages");
+
     /* Set the DPI. The configuration default matches Resvg default of 96.
        Funnily enough this *does not* affect the actual rendered image size,
        one has to do that separately via a transformation matrix when
@@ -178,13 +299,37 @@ void ResvgImporter::doOpenData(Containers::Array<char>&& data, DataFlags) {
 
        There's also a whole logic around font loading. But, diven the above, do
        I even want to dive into that? */
+
+    /* With tiles imported as separate images, calculate the area each of them
+       covers. Tiles are ordered in rows starting from the bottom left, the
+       same as pixels, edge tiles are cut to the image size. */
+    if(_state->tileImages) {
+        const Vector2i size = imageSize(_state->tree, _state->dpi/96.0f);
+        const Vector2i tileCount = (size + tileSize - Vector2i{1})/tileSize;
+        _state->tiles = Containers::Array<Range2Di>{NoInit, std::size_t(tileCount.product())};
+        for(std::size_t i = 0; i != _state->tiles.size(); ++i) {
+            const Vector2i offset = tileSize*Vector2i{Int(i % tileCount.x()),
+                                                      Int(i / tileCount.x())};
+            _state->tiles[i] = {offset, Math::min(offset + tileSize, size)};
+        }
+    }
 }
 
 UnsignedInt ResvgImporter::doImage2DCount() const {
-    return 1;
+    return _state->tileImages ? UnsignedInt(_state->tiles.size()) : 1;
 }
 
-Containers::Optional<ImageData2D> ResvgImporter::doImage2D(UnsignedInt, UnsignedInt) {
+UnsignedInt ResvgImporter::doImage2DLevelCount(UnsignedInt) {
+    /* Tiles are calculated for the dpi option only */
+    if(_state->tileImages)
+        return 1;
+
+    /* Unlike the dpi option, this isn't cached on opening, so the levels can
+       be changed without having to parse the file again */
+    return 1 + UnsignedInt(configuration().values<Float>("levelDpi").size());
+}
+
+Containers::Optional<ImageData2D> ResvgImporter::doImage2D(const UnsignedInt id, const UnsignedInt level) {
     /* The alpha mode can be changed for every image import, so do the checking
        here and not in doOpenData(). Also doing that before anything else so
        people don't just wait ages for doomed-to-fail import with large
@@ -196,6 +341,8 @@ Containers::Optional<ImageData2D> ResvgImporter::doImage2D(UnsignedInt, Unsigned
         return {};
     }
 
+    const std::size_t threadCount = Implementation::threadCount(configuration().value<UnsignedInt>("threads"));
+
     /* Apparently resvg_options_set_dpi() doesn't actually affect the output
        size (while setting DPI in Inkscape output does, which seems like a good
        standard to match), so multiply the size by the ratio to the default 96
@@ -204,41 +351,34 @@ Containers::Optional<ImageData2D> ResvgImporter::doImage2D(UnsignedInt, Unsigned
        resvg_options_set_dpi() actually does and whether it affects also
        resvg_parse_tree_from_data() or only resvg_render() -- thus it's set
        in doOpenData() above already and the DPI value is cached to ensure the
-       same value is used for parsing and for rendering. */
-    const Float scaling = _state->dpi/96.0f;
-    const resvg_size sizeF = resvg_get_image_size(_state->tree);
-    /* The rounding (and DPI being queried as a float) is verified in the
-       load() test as well. */
-    const Vector2i size{Int(Math::round(sizeF.width*scaling)),
-                        Int(Math::round(sizeF.height*scaling))};
+       same value is used for parsing and for rendering. Additional levels
+       are the same parsed tree just rendered with a different scaling. */
+    const Float scaling = (level ? configuration().values<Float>("levelDpi")[level - 1] : _state->dpi)/96.0f;
+    const Vector2i size = imageSize(_state->tree, scaling);
 
     /* Do an Y flip simply by specifying an Y-flipping transform in addition to
-       the DPI scaling. Total guesswork but based on resvg_transform_identity()
-       returning 100100 I assume the matrix layout is the following, i.e.
-       column-major:
-
-        a c e   1 0 0
-        b d f   0 1 0
-
-       Thus compatible with Matrix3x2 and can be cast directly to it. */
+       the DPI scaling. Tiles then additionally translate by their offset. */
     const Matrix3 yFlip =
         Matrix3::translation(Vector2::yAxis(size.y()))*
         Matrix3::scaling({scaling, -scaling});
-    resvg_transform transform;
-    Matrix3x2::from(&transform.a) = Matrix3x2{yFlip};
 
     /** @todo expose rendering of subnodes? is it useful for anything? */
 
-    /* Useless behavior -- resvg_render() renders *onto* a bitmap, i.e. not
-       just writing to it but blending there. Thus the output memory has to be
-       zero-initialized and then the rendering operation does extra work that
-       cannot be turned off and could be better done by something else. Could
-       use it to specify background color for example, but then there's the
-       problem with incorrect premultiplication below (and thus likely
-       incorrect sRGB handling when blending as well) so ... */
-    /** @todo expose the background color option nevertheless? */
-    Containers::Array<char> data{ValueInit, std::size_t(size.product()*4)};
-    resvg_render(_state->tree, transform, size.x(), size.y(), data.data());
+    /* If the tiles are imported as separate images, render just the one
+       requested. Tiles bypass the cache. */
+    Containers::Array<char> data;
+    const void* importerState = nullptr;
+    if(_state->tileImages) {
+        const Range2Di& tile = _state->tiles[id];
+        data = Containers::Array<char>{ValueInit, std::size_t(tile.size().product()*4)};
+        renderArea(_state->tree, yFlip, tile, data.data());
+        importerState = &tile;
+
+    /* Otherwise, if the image was rendered at the same scaling before and is
+       still in the cache, return a copy of it, otherwise render it */
+    } else data = Implementation::renderCached(_state->cache, scaling, configuration().value<std::size_t>("cacheSize"), [&]() {
+        return render(_state->tree, yFlip, size, _state->tileSize, threadCount);
+    });
 
     /* Resvg produces a premultiplied output, unfortunately it doesn't
        correctly premultiply in sRGB. So when one wants to do the
@@ -253,7 +393,8 @@ Containers::Optional<ImageData2D> ResvgImporter::doImage2D(UnsignedInt, Unsigned
             i = i.unpremultiplied();
     else CORRADE_INTERNAL_ASSERT(alphaMode == "premultipliedLinear"_s);
 
-    return ImageData2D{PixelFormat::RGBA8Unorm, size, Utility::move(data)};
+    const Vector2i outputSize = _state->tileImages ? _state->tiles[id].size() : size;
+    return ImageData2D{PixelFormat::RGBA8Unorm, outputSize, Utility::move(data), ImageFlags2D{}, importerState};
 }
 
 }}
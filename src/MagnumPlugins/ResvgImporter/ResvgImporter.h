@@ -148,6 +148,51 @@ case.
 The library also claims to support text rendering, but such feature so far
 wasn't explicitly tested in the plugin implementation.
 
+@subsection Trade-ResvgImporter-behavior-levels Rasterizing at multiple sizes
+
+The file is parsed just once on opening, with the @cb{.ini} dpi @ce option
+being used for both parsing and rendering. To rasterize the already parsed
+file at other sizes, add one or more @cb{.ini} levelDpi @ce
+@ref Trade-ResvgImporter-configuration "configuration options". Each of them
+is then exposed as an additional image level, with @ref image2DLevelCount()
+reflecting the count. Unlike @cb{.ini} dpi @ce, the @cb{.ini} levelDpi @ce
+values can be changed after the file is opened.
+
+Setting the @cb{.ini} cacheSize @ce option to a non-zero value keeps rasterized
+images in a cache up to given total size in bytes, with least recently used
+images being discarded first. Repeated imports of a level with the same DPI
+then only make a copy of the cached data instead of rasterizing again. The
+cache is discarded when the file is closed.
+
+@subsection Trade-ResvgImporter-behavior-tiling Tiled and multithreaded rasterization
+
+By default the whole image is rasterized at once in the calling thread.
+Setting the @cb{.ini} tileSize @ce
+@ref Trade-ResvgImporter-configuration "configuration option" makes the image
+rasterized in tiles of given size instead, each with the transformation
+translated by the tile offset. The @cb{.ini} threads @ce option then controls
+how many threads the tiles are distributed among, with @cpp 0 @ce using all
+hardware threads. The parsed document is shared among the threads. Tiles are
+assembled into a single image of the same size as without tiling. Note that
+filters such as blur that sample outside of a tile may produce different
+results along tile edges.
+
+On Linux, using more than one thread requires the application to be linked
+to `pthread`, see @ref cmake-plugins-threads for details.
+
+Enabling @cb{.ini} tileImages @ce in addition to @cb{.ini} tileSize @ce makes
+each tile exposed as a separate image instead, with @ref image2DCount()
+reflecting the tile count. The tiles are ordered in rows starting from the
+bottom left corner, edge tiles are cut to the image size. Each tile is
+rasterized in the calling thread only when imported, directly into its
+output, which means the whole image never needs to be in memory at once. The
+@ref ImageData::importerState() of each tile points to a @ref Range2Di with
+the area it covers in the whole image, which is valid until the file is
+closed. The whole image size is the @ref Range2Di::max() of the last tile.
+Both options are used during file opening already, changing them afterwards
+has no effect. Levels specified via @cb{.ini} levelDpi @ce are not exposed in
+this case and the tiles are not put into the cache.
+
 @section Trade-ResvgImporter-configuration Plugin-specific configuration
 
 It's possible to tune various import options through @ref configuration(). See
@@ -173,6 +218,7 @@ class MAGNUM_RESVGIMPORTER_EXPORT ResvgImporter: public AbstractImporter {
         MAGNUM_RESVGIMPORTER_LOCAL void doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) override;
 
         MAGNUM_RESVGIMPORTER_LOCAL UnsignedInt doImage2DCount() const override;
+        MAGNUM_RESVGIMPORTER_LOCAL UnsignedInt doImage2DLevelCount(UnsignedInt id) override;
         MAGNUM_RESVGIMPORTER_LOCAL Containers::Optional<ImageData2D> doImage2D(UnsignedInt id, UnsignedInt level) override;
 
         struct State;
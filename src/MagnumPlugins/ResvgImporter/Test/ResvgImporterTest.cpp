@@ -36,6 +36,8 @@
 #include <Magnum/ImageView.h>
 #include <Magnum/DebugTools/CompareImage.h>
 #include <Magnum/Math/Color.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/Trade/AbstractImporter.h>
 #include <Magnum/Trade/ImageData.h>
 
@@ -63,6 +65,12 @@ struct ResvgImporterTest: TestSuite::Tester {
     /* There are also external fonts, but given how external image loading
        "works" I don't even want to try. */
 
+    void levels();
+    void cache();
+    void tiled();
+    void tiledInvalidSize();
+    void tileImages();
+
     void openTwice();
     void importTwice();
 
@@ -128,6 +136,18 @@ const struct {
     {"external", "external.svg"},
 };
 
+const struct {
+    const char* name;
+    Vector2i tileSize;
+    UnsignedInt threads;
+} TiledData[]{
+    {"single tile", {32, 24}, 1},
+    {"tile larger than the image", {64, 64}, 1},
+    {"7x5 tiles", {7, 5}, 1},
+    {"7x5 tiles, 4 threads", {7, 5}, 4},
+    {"8x8 tiles, all hardware threads", {8, 8}, 0},
+};
+
 ResvgImporterTest::ResvgImporterTest() {
     addInstancedTests({&ResvgImporterTest::invalidData},
         Containers::arraySize(InvalidDataData));
@@ -149,6 +169,15 @@ ResvgImporterTest::ResvgImporterTest() {
     addTests({&ResvgImporterTest::externalImageNotFound,
               &ResvgImporterTest::externalImageFromData,
 
+              &ResvgImporterTest::levels,
+              &ResvgImporterTest::cache});
+
+    addInstancedTests({&ResvgImporterTest::tiled},
+        Containers::arraySize(TiledData));
+
+    addTests({&ResvgImporterTest::tiledInvalidSize,
+              &ResvgImporterTest::tileImages,
+
               &ResvgImporterTest::openTwice,
               &ResvgImporterTest::importTwice});
 
@@ -401,6 +430,194 @@ void ResvgImporterTest::externalImageFromData() {
         DebugTools::CompareImage);
 }
 
+void ResvgImporterTest::levels() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("ResvgImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+
+    /* By default there's just one level */
+    CORRADE_COMPARE(importer->image2DLevelCount(0), 1);
+
+    /* The levels can be added after the file is opened, without opening it
+       again */
+    importer->configuration().addValue("levelDpi", 133.6f);
+    importer->configuration().addValue("levelDpi", 48.0f);
+    CORRADE_COMPARE(importer->image2DLevelCount(0), 3);
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    Containers::Optional<Trade::ImageData2D> image133dpi = importer->image2D(0, 1);
+    Containers::Optional<Trade::ImageData2D> image48dpi = importer->image2D(0, 2);
+    CORRADE_VERIFY(image);
+    CORRADE_VERIFY(image133dpi);
+    CORRADE_VERIFY(image48dpi);
+    CORRADE_COMPARE(image->size(), (Vector2i{32, 24}));
+    CORRADE_COMPARE(image133dpi->size(), (Vector2i{45, 33}));
+    CORRADE_COMPARE(image48dpi->size(), (Vector2i{16, 12}));
+
+    if(_manager.loadState("AnyImageImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("AnyImageImporter plugin not found, cannot test contents");
+    if(_manager.loadState("PngImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("PngImporter plugin not found, cannot test contents");
+
+    /* Same thresholds as in load() */
+    CORRADE_COMPARE_WITH(*image133dpi,
+        Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file-133dpi.png"),
+        (DebugTools::CompareImageToFile{_manager, 111.25f, 1.333f}));
+    CORRADE_COMPARE_WITH(*image48dpi,
+        Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file-48dpi.png"),
+        (DebugTools::CompareImageToFile{_manager, 4.0f, 0.1993f}));
+}
+
+void ResvgImporterTest::cache() {
+    /* Reference output without a cache */
+    Containers::Pointer<AbstractImporter> reference = _manager.instantiate("ResvgImporter");
+    reference->configuration().addValue("levelDpi", 48.0f);
+    CORRADE_VERIFY(reference->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+    Containers::Optional<Trade::ImageData2D> expected = reference->image2D(0);
+    Containers::Optional<Trade::ImageData2D> expected48dpi = reference->image2D(0, 1);
+    CORRADE_VERIFY(expected);
+    CORRADE_VERIFY(expected48dpi);
+
+    /* The budget is enough for both levels */
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("ResvgImporter");
+    importer->configuration().setValue("cacheSize", 32*24*4 + 16*12*4);
+    importer->configuration().addValue("levelDpi", 48.0f);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+
+    /* Modifying the returned data shouldn't affect what's in the cache */
+    {
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE_AS(*image, *expected, DebugTools::CompareImage);
+        for(char& i: image->mutableData())
+            i = '\x7f';
+    }
+
+    /* Both levels should be the same when imported again from the cache */
+    for(std::size_t i = 0; i != 2; ++i) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+        Containers::Optional<Trade::ImageData2D> image48dpi = importer->image2D(0, 1);
+        CORRADE_VERIFY(image);
+        CORRADE_VERIFY(image48dpi);
+        CORRADE_COMPARE_AS(*image, *expected, DebugTools::CompareImage);
+        CORRADE_COMPARE_AS(*image48dpi, *expected48dpi, DebugTools::CompareImage);
+    }
+
+    /* The cached data are the raw rasterizer output, so changing the alpha
+       mode should have the same effect as without a cache */
+    importer->configuration().setValue("alphaMode", "premultipliedLinear");
+    reference->configuration().setValue("alphaMode", "premultipliedLinear");
+    Containers::Optional<Trade::ImageData2D> premultiplied = importer->image2D(0);
+    Containers::Optional<Trade::ImageData2D> expectedPremultiplied = reference->image2D(0);
+    CORRADE_VERIFY(premultiplied);
+    CORRADE_VERIFY(expectedPremultiplied);
+    CORRADE_COMPARE_AS(*premultiplied, *expectedPremultiplied, DebugTools::CompareImage);
+
+    /* Making the budget smaller or disabling the cache should still give back
+       the same output */
+    for(std::size_t cacheSize: {16*12*4, 0}) {
+        CORRADE_ITERATION(cacheSize);
+        importer->configuration().setValue("cacheSize", cacheSize);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE_AS(*image, *expectedPremultiplied, DebugTools::CompareImage);
+    }
+}
+
+void ResvgImporterTest::tiled() {
+    auto&& data = TiledData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> reference = _manager.instantiate("ResvgImporter");
+    CORRADE_VERIFY(reference->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+    Containers::Optional<Trade::ImageData2D> expected = reference->image2D(0);
+    CORRADE_VERIFY(expected);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("ResvgImporter");
+    importer->configuration().setValue("tileSize", data.tileSize);
+    importer->configuration().setValue("threads", data.threads);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+
+    /* Without tileImages it's still a single image */
+    CORRADE_COMPARE(importer->image2DCount(), 1);
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->format(), PixelFormat::RGBA8Unorm);
+    CORRADE_COMPARE(image->size(), (Vector2i{32, 24}));
+    /* The tiles are rendered with an integer translation so the output should
+       match, allow for minor differences in antialiasing nevertheless */
+    CORRADE_COMPARE_WITH(*image, *expected,
+        (DebugTools::CompareImage{1.0f, 0.01f}));
+}
+
+void ResvgImporterTest::tiledInvalidSize() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("ResvgImporter");
+    importer->configuration().setValue("tileSize", Vector2i{0, 5});
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+    CORRADE_VERIFY(!importer->isOpened());
+    CORRADE_COMPARE(out, "Trade::ResvgImporter::openData(): expected tileSize to be either empty or positive but got {0, 5}\n");
+}
+
+void ResvgImporterTest::tileImages() {
+    /* Reference assembled from the same tiles, which should thus match
+       exactly */
+    Containers::Pointer<AbstractImporter> reference = _manager.instantiate("ResvgImporter");
+    reference->configuration().setValue("tileSize", Vector2i{20, 16});
+    CORRADE_VERIFY(reference->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+    Containers::Optional<Trade::ImageData2D> expected = reference->image2D(0);
+    CORRADE_VERIFY(expected);
+    CORRADE_COMPARE(expected->size(), (Vector2i{32, 24}));
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("ResvgImporter");
+    importer->configuration().setValue("tileSize", Vector2i{20, 16});
+    importer->configuration().setValue("tileImages", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(RESVGIMPORTER_TEST_DIR, "file.svg")));
+
+    /* 32x24 split into 2x2 tiles, levels aren't exposed for tiles */
+    importer->configuration().addValue("levelDpi", 48.0f);
+    CORRADE_COMPARE(importer->image2DCount(), 4);
+    CORRADE_COMPARE(importer->image2DLevelCount(0), 1);
+
+    /* Changing the options after opening has no effect */
+    importer->configuration().setValue("tileSize", Vector2i{8, 8});
+    importer->configuration().setValue("tileImages", false);
+    CORRADE_COMPARE(importer->image2DCount(), 4);
+
+    /* Going from bottom left, edge tiles are cut to the image size */
+    const Range2Di expectedAreas[]{
+        {{ 0,  0}, {20, 16}},
+        {{20,  0}, {32, 16}},
+        {{ 0, 16}, {20, 24}},
+        {{20, 16}, {32, 24}},
+    };
+    Containers::Optional<Trade::ImageData2D> tiles[4];
+    for(UnsignedInt i = 0; i != 4; ++i) {
+        CORRADE_ITERATION(i);
+        tiles[i] = importer->image2D(i);
+        CORRADE_VERIFY(tiles[i]);
+        CORRADE_COMPARE(tiles[i]->format(), PixelFormat::RGBA8Unorm);
+        CORRADE_COMPARE(tiles[i]->size(), expectedAreas[i].size());
+        CORRADE_COMPARE_AS(*tiles[i], (ImageView2D{
+            PixelStorage{}
+                .setRowLength(32)
+                .setSkip({expectedAreas[i].min(), 0}),
+            PixelFormat::RGBA8Unorm, expectedAreas[i].size(), expected->data()}),
+            DebugTools::CompareImage);
+    }
+
+    /* The importer state of each tile should stay the same after importing
+       the others */
+    for(UnsignedInt i = 0; i != 4; ++i) {
+        CORRADE_ITERATION(i);
+        CORRADE_VERIFY(tiles[i]->importerState());
+        CORRADE_COMPARE(*static_cast<const Range2Di*>(tiles[i]->importerState()), expectedAreas[i]);
+    }
+}
+
 void ResvgImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("ResvgImporter");
 
@@ -26,15 +26,19 @@
 
 #include "StbDxtImageConverter.h"
 
+#include <atomic>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Magnum/Math/Color.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/threadsAndCache.h"
+
 #define STB_DXT_IMPLEMENTATION
 /* LOL the thing doesn't #include <string.h> on its own, wtf */
 #include <cstring>
@@ -68,7 +72,12 @@ Containers::Optional<ImageData3D> convertInternal(const ImageView3D& image, Util
         case PixelFormat::RGBA8Srgb:
             outputFormat = CompressedPixelFormat::Bc3RGBASrgb;
             break;
-        /** @todo BC4/5 (single/two channel) -- template the loop? */
+        case PixelFormat::R8Unorm:
+            outputFormat = CompressedPixelFormat::Bc4RUnorm;
+            break;
+        case PixelFormat::RG8Unorm:
+            outputFormat = CompressedPixelFormat::Bc5RGUnorm;
+            break;
         default:
             Error{} << "Trade::StbDxtImageConverter::convert(): unsupported format" << image.format();
             return {};
@@ -77,9 +86,11 @@ Containers::Optional<ImageData3D> convertInternal(const ImageView3D& image, Util
     const bool srgb = isPixelFormatSrgb(image.format());
     bool alpha = inputChannelCount == 4;
 
-    /* If the alpha option is set, override the default. Input channel count
-       stays the same, of course. */
-    if(configuration.value<Containers::StringView>("alpha")) {
+    /* If the alpha option is set, override the default for RGB and RGBA
+       inputs. Input channel count stays the same, of course. BC4 and BC5 have
+       no alpha channel, so the option is ignored for single- and two-channel
+       inputs. */
+    if(inputChannelCount >= 3 && configuration.value<Containers::StringView>("alpha")) {
         if(configuration.value<bool>("alpha")) {
             alpha = true;
             outputFormat = srgb ?
@@ -100,7 +111,12 @@ Containers::Optional<ImageData3D> convertInternal(const ImageView3D& image, Util
 
     const Containers::StridedArrayView4D<const UnsignedByte> input = Containers::arrayCast<const UnsignedByte>(image.pixels());
 
-    const std::size_t outputBlockSize = alpha ? 16 : 8;
+    /* BC3 and BC5 have 128-bit blocks, BC1 and BC4 64-bit */
+    const std::size_t outputBlockSize = alpha || inputChannelCount == 2 ? 16 : 8;
+
+    /* BC1 and BC3 compression takes four bytes per pixel even if the alpha is
+       unused, BC4 and BC5 take a tightly packed single or two channels */
+    const std::size_t blockPixelSize = inputChannelCount >= 3 ? 4 : inputChannelCount;
 
     /** @todo use blocks() once the compressed image APIs are done */
     Containers::Array<char> outputData{NoInit, std::size_t(image.size().product()*outputBlockSize/16)};
@@ -112,32 +128,63 @@ Containers::Optional<ImageData3D> convertInternal(const ImageView3D& image, Util
          outputBlockSize}
     };
 
-    /* Prepare destination where to copy linearized input data. If the alpha is
-       missing in the input, fill it to 255. */
-    UnsignedByte inputBlockData[16*4];
-    if(inputChannelCount == 3) {
-        /* Utility::copy() would work but be a lot more painful in this case */
-        for(std::size_t i = 0; i != sizeof(inputBlockData); i += 4)
-            inputBlockData[i + 3] = 255;
-    }
-    const Containers::StridedArrayView3D<UnsignedByte> inputBlock{inputBlockData, {4, 4, inputChannelCount}, {4*4, 4, 1}};
-
-    /* Go through all blocks in the input file, linearize and compress them */
-    for(std::size_t z = 0, zMax = input.size()[0]; z != zMax; ++z) {
-        const Containers::StridedArrayView3D<const UnsignedByte> inputLayer = input[z];
-        const Containers::StridedArrayView3D<UnsignedByte> outputLayer = output[z];
-        for(std::size_t y = 0, yMax = input.size()[1]/4; y < yMax; ++y) {
-            const Containers::StridedArrayView2D<UnsignedByte> outputRow = outputLayer[y];
-            for(std::size_t x = 0, xMax = input.size()[2]/4; x < xMax; ++x) {
-                /* If the alpha is missing, it'll copy only the RGB values into
-                   the destination */
-                Utility::copy(inputLayer.slice({4*y, 4*x, 0}, {4*y + 4, 4*x + 4, inputChannelCount}), inputBlock);
-
-                /* Compress the block */
+    /* If the input pixels are tightly packed and have the same size as in the
+       block, which is the case for everything except RGB, each row of a block
+       is contiguous and can be copied directly without going through the
+       generic strided Utility::copy() */
+    const bool contiguous = std::size_t(input.stride()[2]) == blockPixelSize &&
+        input.stride()[3] == 1;
+
+    /* Compresses a single row of blocks, given its index in all rows of all
+       layers */
+    const std::size_t blockRowsPerLayer = input.size()[1]/4;
+    const std::size_t blocksPerRow = input.size()[2]/4;
+    const auto compressBlockRow = [&](UnsignedByte* const inputBlockData, const std::size_t blockRow) {
+        const std::size_t z = blockRow/blockRowsPerLayer;
+        const std::size_t y = blockRow%blockRowsPerLayer;
+        const Containers::StridedArrayView3D<const UnsignedByte> inputRows = input[z].slice({4*y, 0, 0}, {4*y + 4, input.size()[2], inputChannelCount});
+        const Containers::StridedArrayView2D<UnsignedByte> outputRow = output[z][y];
+        const Containers::StridedArrayView3D<UnsignedByte> inputBlock{Containers::arrayView(inputBlockData, 16*blockPixelSize), {4, 4, inputChannelCount}, {std::ptrdiff_t(4*blockPixelSize), std::ptrdiff_t(blockPixelSize), 1}};
+        for(std::size_t x = 0; x != blocksPerRow; ++x) {
+            if(contiguous) {
+                for(std::size_t i = 0; i != 4; ++i)
+                    std::memcpy(inputBlockData + i*4*blockPixelSize, &inputRows[i][4*x][0], 4*blockPixelSize);
+
+            /* If the alpha is missing, it'll copy only the RGB values into
+               the destination */
+            } else Utility::copy(inputRows.slice({0, 4*x, 0}, {4, 4*x + 4, inputChannelCount}), inputBlock);
+
+            /* Compress the block */
+            if(inputChannelCount == 1)
+                stb_compress_bc4_block(&outputRow[x][0], inputBlockData);
+            else if(inputChannelCount == 2)
+                stb_compress_bc5_block(&outputRow[x][0], inputBlockData);
+            else
                 stb_compress_dxt_block(&outputRow[x][0], inputBlockData, alpha, flags);
-            }
         }
-    }
+    };
+
+    /* Value of 0 means all hardware threads, 1 means compressing serially in
+       the calling thread */
+    const UnsignedInt threadCount = Implementation::threadCount(configuration.value<UnsignedInt>("threads"));
+
+    /* Every thread, including the calling one, picks the next unprocessed
+       block row from all rows of all layers until there's none left. Each
+       has its own destination where to copy linearized input data. If the
+       alpha is missing in the input, it's filled with 255. */
+    const std::size_t blockRowCount = input.size()[0]*blockRowsPerLayer;
+    std::atomic<std::size_t> nextBlockRow{0};
+    Implementation::runInThreads(Math::min(std::size_t(threadCount), blockRowCount), [&]() {
+        UnsignedByte inputBlockData[16*4];
+        if(inputChannelCount == 3) {
+            /* Utility::copy() would work but be a lot more painful in this
+               case */
+            for(std::size_t i = 0; i != sizeof(inputBlockData); i += 4)
+                inputBlockData[i + 3] = 255;
+        }
+        for(std::size_t blockRow; (blockRow = nextBlockRow++) < blockRowCount; )
+            compressBlockRow(inputBlockData, blockRow);
+    });
 
     return ImageData3D{outputFormat, image.size(), Utility::move(outputData), image.flags()};
 }
@@ -54,11 +54,12 @@
 namespace Magnum { namespace Trade {
 
 /**
-@brief BC1/BC3 compressor using stb_dxt
+@brief BC1/BC3/BC4/BC5 compressor using stb_dxt
 @m_since_latest_{plugins}
 
 Converts uncompressed 2D, 2D array or cube and 3D RGB and RGBA images to
-block-compressed BC1/BC3 images using the [stb_dxt](https://github.com/nothings/stb)
+block-compressed BC1/BC3 images and single- and two-channel images to BC4/BC5
+images using the [stb_dxt](https://github.com/nothings/stb)
 library.
 
 @m_class{m-block m-primary}
@@ -136,6 +137,13 @@ with @ref CompressedPixelFormat::Bc1RGBUnorm /
 override alpha channel presence in the output by explicitly enabling or
 disabling the @cb{.ini} alpha @ce @ref Trade-StbDxtImageConverter-configuration "configuration option".
 
+A @ref PixelFormat::R8Unorm input will produce
+@ref CompressedPixelFormat::Bc4RUnorm and a @ref PixelFormat::RG8Unorm input
+@ref CompressedPixelFormat::Bc5RGUnorm, suitable for example for roughness or
+normal maps. The @cb{.ini} alpha @ce and @cb{.ini} highQuality @ce options
+have no effect for these. Signed and sRGB single- and two-channel formats
+aren't supported.
+
 Image flags are passed through unchanged. 3D images are compressed
 slice-by-slice, independently of whether @ref ImageFlag3D::Array and/or
 @ref ImageFlag3D::CubeMap or neither is set. On the other hand, if a 2D image
@@ -154,6 +162,17 @@ with Y-flipping block-compressed data. This is in line with importers of
 compressed pixel formats such as @ref AstcImporter, @ref DdsImporter or
 @ref KtxImporter, which don't Y-flip compressed formats on import either.
 
+@subsection Trade-StbDxtImageConverter-behavior-multithreading Multithreaded compression
+
+By default the blocks are compressed serially in the calling thread. Setting
+the @cb{.ini} threads @ce @ref Trade-StbDxtImageConverter-configuration "configuration option"
+to a value other than @cpp 1 @ce distributes rows of blocks of all slices
+among given count of threads, with @cpp 0 @ce using all hardware threads. The
+output is the same regardless of the thread count.
+
+On Linux, using more than one thread requires the application to be linked
+to `pthread`, see @ref cmake-plugins-threads for details.
+
 @section Trade-StbDxtImageConverter-configuration Plugin-specific configuration
 
 Various compressor options can be set through @ref configuration(). See below
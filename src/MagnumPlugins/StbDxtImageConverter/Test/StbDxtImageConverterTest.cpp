@@ -49,6 +49,9 @@ struct StbDxtImageConverterTest: TestSuite::Tester {
 
     void rgba();
     void threeDimensions();
+    void threads();
+
+    void benchmark();
 
     /* Explicitly forbid system-wide plugin dependencies */
     PluginManager::Manager<AbstractImageConverter> _converterManager{"nonexistent"};
@@ -85,6 +88,46 @@ const struct {
         CompressedPixelFormat::Bc3RGBASrgb, "ship.bc3"},
     {"flag passthrough", 4, {}, {}, PixelFormat::RGBA8Unorm, ImageFlag2D(0xdea0),
         CompressedPixelFormat::Bc3RGBAUnorm, "ship.bc3"},
+    {"R", 1, {}, {}, {}, {},
+        CompressedPixelFormat::Bc4RUnorm, "ship.bc4"},
+    /* Neither BC4 nor BC5 has alpha, the option is ignored there. Same for
+       high quality, which affects only BC1 and BC3. */
+    {"R, alpha enabled", 1, true, true, {}, {},
+        CompressedPixelFormat::Bc4RUnorm, "ship.bc4"},
+    {"RG", 2, {}, {}, {}, {},
+        CompressedPixelFormat::Bc5RGUnorm, "ship.bc5"},
+    {"RG, alpha disabled", 2, false, true, {}, {},
+        CompressedPixelFormat::Bc5RGUnorm, "ship.bc5"},
+};
+
+const struct {
+    const char* name;
+    Int channelCount;
+    Int depth;
+    UnsignedInt threads;
+    const char* expectedFile;
+} ThreadsData[] {
+    {"RGBA, 2 threads", 4, 1, 2, "ship.bc3"},
+    {"RGBA, 3D, 5 threads", 4, 3, 5, "ship.bc3"},
+    {"RGB, 3D, 64 threads", 3, 3, 64, "ship.bc1"},
+    {"RGB, all hardware threads", 3, 1, 0, "ship.bc1"},
+    {"R, 3D, 3 threads", 1, 3, 3, "ship.bc4"},
+    {"RG, 3D, 4 threads", 2, 3, 4, "ship.bc5"},
+};
+
+const struct {
+    const char* name;
+    PixelFormat format;
+    Vector2i size;
+    UnsignedInt threads;
+} BenchmarkData[] {
+    {"RGB8, 256x256 (0.07 MPix)", PixelFormat::RGB8Unorm, {256, 256}, 1},
+    {"RGB8, 1024x1024 (1.05 MPix)", PixelFormat::RGB8Unorm, {1024, 1024}, 1},
+    {"RGB8, 1024x1024 (1.05 MPix), all hardware threads", PixelFormat::RGB8Unorm, {1024, 1024}, 0},
+    {"RGBA8, 256x256 (0.07 MPix)", PixelFormat::RGBA8Unorm, {256, 256}, 1},
+    {"RGBA8, 1024x1024 (1.05 MPix)", PixelFormat::RGBA8Unorm, {1024, 1024}, 1},
+    {"RGBA8, 1024x1024 (1.05 MPix), all hardware threads", PixelFormat::RGBA8Unorm, {1024, 1024}, 0},
+    {"RGBA8, 2048x2048 (4.19 MPix), all hardware threads", PixelFormat::RGBA8Unorm, {2048, 2048}, 0},
 };
 
 StbDxtImageConverterTest::StbDxtImageConverterTest() {
@@ -98,6 +141,14 @@ StbDxtImageConverterTest::StbDxtImageConverterTest() {
 
     addTests({&StbDxtImageConverterTest::threeDimensions});
 
+    addInstancedTests({&StbDxtImageConverterTest::threads},
+        Containers::arraySize(ThreadsData));
+
+    /* Wall time, divide the megapixel count in the instance name by the
+       reported time to get MPix/s */
+    addInstancedBenchmarks({&StbDxtImageConverterTest::benchmark}, 5,
+        Containers::arraySize(BenchmarkData), BenchmarkType::WallTime);
+
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
     #ifdef STBDXTIMAGECONVERTER_PLUGIN_FILENAME
@@ -110,12 +161,12 @@ StbDxtImageConverterTest::StbDxtImageConverterTest() {
 }
 
 void StbDxtImageConverterTest::unsupportedFormat() {
-    ImageView2D image{PixelFormat::RG8Unorm, {}, nullptr};
+    ImageView2D image{PixelFormat::RG8Snorm, {}, nullptr};
 
     Containers::String out;
     Error redirectError{&out};
     CORRADE_VERIFY(!_converterManager.instantiate("StbDxtImageConverter")->convert(image));
-    CORRADE_COMPARE(out, "Trade::StbDxtImageConverter::convert(): unsupported format PixelFormat::RG8Unorm\n");
+    CORRADE_COMPARE(out, "Trade::StbDxtImageConverter::convert(): unsupported format PixelFormat::RG8Snorm\n");
 }
 
 void StbDxtImageConverterTest::unsupportedSize() {
@@ -178,7 +229,7 @@ void StbDxtImageConverterTest::rgba() {
     CORRADE_COMPARE(compressed->compressedFormat(), data.expectedFormat);
     CORRADE_COMPARE(compressed->size(), (Vector2i{160, 96}));
     /* The data should be exactly the size of 4x4 128-bit blocks for BC3 and
-       64-bit blocks for BC1 (without alpha) */
+       BC5 and 64-bit blocks for BC1 (without alpha) and BC4 */
     /** @todo drop this and let the ImageData constructor take care of this? */
     CORRADE_COMPARE(compressed->data().size(),
         compressed->size().product()*compressedPixelFormatBlockDataSize(data.expectedFormat)/16);
@@ -221,6 +272,62 @@ void StbDxtImageConverterTest::threeDimensions() {
         TestSuite::Compare::StringToFile);
 }
 
+void StbDxtImageConverterTest::threads() {
+    auto&& data = ThreadsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    if(_importerManager.loadState("StbImageImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("StbImageImporter plugin not found, cannot test");
+
+    Containers::Pointer<AbstractImporter> importer = _importerManager.instantiate("StbImageImporter");
+    importer->configuration().setValue("forceChannelCount", data.channelCount);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBDXTIMAGECONVERTER_TEST_DIR, "ship.jpg")));
+    Containers::Optional<Trade::ImageData2D> uncompressed = importer->image2D(0);
+    CORRADE_VERIFY(uncompressed);
+    CORRADE_COMPARE(uncompressed->size(), (Vector2i{160, 96}));
+
+    /* Same as in threeDimensions(), optionally cutting the input into
+       horizontal slices */
+    ImageView3D uncompressed3D{uncompressed->format(), {160, 96/data.depth, data.depth}, uncompressed->data()};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("StbDxtImageConverter");
+    converter->configuration().setValue("threads", data.threads);
+    Containers::Optional<Trade::ImageData3D> compressed = converter->convert(uncompressed3D);
+    CORRADE_VERIFY(compressed);
+    CORRADE_COMPARE(compressed->size(), (Vector3i{160, 96/data.depth, data.depth}));
+
+    /* The output should be exactly the same as when compressing serially */
+    /** @todo Compare::DataToFile */
+    CORRADE_COMPARE_AS(Containers::StringView{compressed->data()},
+        Utility::Path::join(STBDXTIMAGECONVERTER_TEST_DIR, data.expectedFile),
+        TestSuite::Compare::StringToFile);
+}
+
+void StbDxtImageConverterTest::benchmark() {
+    auto&& data = BenchmarkData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Some arbitrary gradients with a bit of noise so the blocks aren't
+       trivially uniform */
+    const std::size_t pixelSize = pixelFormatSize(data.format);
+    Containers::Array<char> pixels{NoInit, std::size_t(data.size.product())*pixelSize};
+    for(std::size_t y = 0; y != std::size_t(data.size.y()); ++y)
+        for(std::size_t x = 0; x != std::size_t(data.size.x()); ++x)
+            for(std::size_t c = 0; c != pixelSize; ++c)
+                pixels[(y*data.size.x() + x)*pixelSize + c] = char(x*(c + 1) + y*(3 - c) + ((x*y) >> 3)*(c & 1));
+    const ImageView2D image{data.format, data.size, pixels};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("StbDxtImageConverter");
+    converter->configuration().setValue("threads", data.threads);
+
+    Containers::Optional<Trade::ImageData2D> compressed;
+    CORRADE_BENCHMARK(5)
+        compressed = converter->convert(image);
+
+    CORRADE_VERIFY(compressed);
+    CORRADE_COMPARE(compressed->size(), data.size);
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::Trade::Test::StbDxtImageConverterTest)
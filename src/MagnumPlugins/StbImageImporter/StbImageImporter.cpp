@@ -26,8 +26,12 @@
 
 #include "StbImageImporter.h"
 
-#include <Corrade/Containers/Array.h>
+#include <cstring>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Magnum/PixelFormat.h>
@@ -55,6 +59,99 @@
 
 namespace Magnum { namespace Trade {
 
+namespace {
+
+/* Walks the GIF block structure without decoding any pixel data to count the
+   frames and gather their delays. Mirrors what stbi__gif_load_next() does
+   apart from the LZW decoding, including stopping at the first unknown block
+   like stbi__load_gif_main() does. */
+void scanGifFrames(stbi__context& s, stbi__gif& g, Containers::Array<int>& delays) {
+    int components;
+    if(!stbi__gif_header(&s, &g, &components, 0))
+        return;
+
+    int delay = 0;
+    for(;;) switch(stbi__get8(&s)) {
+        /* Image descriptor */
+        case 0x2C: {
+            /* Offset and size */
+            stbi__skip(&s, 8);
+            /* Local color table, if present */
+            const int flags = stbi__get8(&s);
+            if(flags & 0x80)
+                stbi__skip(&s, 3*(2 << (flags & 7)));
+            /* LZW code size and the data sub-blocks */
+            stbi__get8(&s);
+            for(int length; (length = stbi__get8(&s)) != 0; )
+                stbi__skip(&s, length);
+            arrayAppend(delays, delay);
+        } break;
+
+        /* Extension */
+        case 0x21: {
+            int length;
+            if(stbi__get8(&s) == 0xF9) {
+                length = stbi__get8(&s);
+                /* Flags, delay in 1/100ths of a second and transparent
+                   index. Like in stb_image, if the graphic control extension
+                   has an unexpected length, the sub-blocks after aren't
+                   skipped. */
+                if(length == 4) {
+                    stbi__get8(&s);
+                    delay = 10*stbi__get16le(&s);
+                    stbi__get8(&s);
+                } else {
+                    stbi__skip(&s, length);
+                    break;
+                }
+            }
+            while((length = stbi__get8(&s)) != 0)
+                stbi__skip(&s, length);
+        } break;
+
+        /* End of the stream or an unknown block */
+        default:
+            return;
+    }
+}
+
+/* Decoding state for GIF frames imported on demand */
+struct GifStream {
+    explicit GifStream(const Containers::ArrayView<const char> data): data{data} {
+        restart();
+    }
+
+    ~GifStream() {
+        STBI_FREE(gif.out);
+        STBI_FREE(gif.background);
+        STBI_FREE(gif.history);
+    }
+
+    /* Disable copies and moves to avoid accidental double deletion */
+    GifStream(const GifStream&) = delete;
+    GifStream& operator=(const GifStream&) = delete;
+
+    void restart() {
+        STBI_FREE(gif.out);
+        STBI_FREE(gif.background);
+        STBI_FREE(gif.history);
+        std::memset(&gif, 0, sizeof(stbi__gif));
+        stbi__start_mem(&context, reinterpret_cast<const stbi_uc*>(data.data()), data.size());
+        nextFrame = 0;
+    }
+
+    Containers::ArrayView<const char> data;
+    stbi__context context;
+    stbi__gif gif{};
+    /* Copies of the two most recently decoded frames, with frame N being in
+       slot N % 2. The frame two back is needed for the "restore to previous"
+       disposal mode. Not Y-flipped. */
+    Containers::Array<char> frames[2];
+    UnsignedInt nextFrame;
+};
+
+}
+
 struct StbImageImporter::State {
     Containers::Array<char> data;
 
@@ -62,6 +159,9 @@ struct StbImageImporter::State {
     Vector3i gifSize;
     std::size_t gifFrameStride;
     Containers::Array<int> gifDelays;
+
+    /* Set if GIF frames are decoded on demand instead of all on opening */
+    Containers::Pointer<GifStream> gifStream;
 };
 
 #ifdef MAGNUM_BUILD_DEPRECATED /* LCOV_EXCL_START */
@@ -114,6 +214,33 @@ void StbImageImporter::doOpenData(Containers::Array<char>&& data, const DataFlag
     #endif
         (true);
 
+    /* If streaming GIF frames, only walk the file structure to get the frame
+       count and delays, the frames are then decoded on demand in
+       doImage2D(). If the file isn't a GIF or has no frames, the actual
+       opening (and error handling) is done in doImage2D() as well. */
+    if(configuration().value<bool>("streamGifFrames")) {
+        _in.emplace();
+        if(dataFlags & (DataFlag::Owned|DataFlag::ExternallyOwned))
+            _in->data = Utility::move(data);
+        else
+            _in->data = Containers::Array<char>{InPlaceInit, data};
+
+        _in->gifStream.emplace(_in->data);
+        GifStream& stream = *_in->gifStream;
+        if(stbi__gif_test(&stream.context))
+            scanGifFrames(stream.context, stream.gif, _in->gifDelays);
+        if(_in->gifDelays.isEmpty()) {
+            _in->gifStream = nullptr;
+            return;
+        }
+
+        /* Same as below, the output is always four-channel */
+        _in->gifSize = {stream.gif.w, stream.gif.h, Int(_in->gifDelays.size())};
+        _in->gifFrameStride = _in->gifSize.xy().product()*4;
+        stream.restart();
+        return;
+    }
+
     /* Try to open as a gif. If that succeeds, great. If that fails, the actual
        opening (and error handling) is done in doImage2D(). */
     {
@@ -160,6 +287,47 @@ UnsignedInt StbImageImporter::doImage2DCount() const {
 }
 
 Containers::Optional<ImageData2D> StbImageImporter::doImage2D(const UnsignedInt id, UnsignedInt) {
+    /* This is a GIF with frames decoded on demand. Because each frame is
+       composited on top of the previous ones, all frames up to the requested
+       one have to be decoded, going back further than the two most recently
+       decoded frames means starting from the beginning again. Importing
+       frames in order is thus the fastest. */
+    if(_in->gifStream) {
+        GifStream& stream = *_in->gifStream;
+        if(id + 2 < stream.nextFrame)
+            stream.restart();
+
+        for(; stream.nextFrame <= id; ++stream.nextFrame) {
+            /* stbi__load_gif_main() doesn't calculate the pointer to the
+               frame two back correctly, here it's the actual frame */
+            stbi_uc* const twoBack = stream.nextFrame >= 2 ?
+                reinterpret_cast<stbi_uc*>(stream.frames[stream.nextFrame % 2].data()) : nullptr;
+            int components;
+            stbi_uc* const out = stbi__gif_load_next(&stream.context, &stream.gif, &components, 0, twoBack);
+            /* The context pointer is returned as an end of file marker. The
+               decoder state is now inconsistent, so start over the next
+               time. */
+            if(!out || out == reinterpret_cast<stbi_uc*>(&stream.context)) {
+                Error{} << "Trade::StbImageImporter::image2D(): cannot decode frame" << stream.nextFrame << Debug::nospace << ":" << (out ? "unexpected end of file" : stbi_failure_reason());
+                stream.restart();
+                return {};
+            }
+
+            Containers::Array<char>& frame = stream.frames[stream.nextFrame % 2];
+            if(!frame)
+                frame = Containers::Array<char>{NoInit, _in->gifFrameStride};
+            Utility::copy(Containers::arrayView(reinterpret_cast<const char*>(out), _in->gifFrameStride), frame);
+        }
+
+        /* Y-flip the frame while copying it out */
+        const Containers::Size2D size{std::size_t(_in->gifSize.y()),
+                                      std::size_t(_in->gifSize.x()*4)};
+        Containers::Array<char> data{NoInit, _in->gifFrameStride};
+        Utility::copy(Containers::StridedArrayView2D<const char>{stream.frames[id % 2], size}.flipped<0>(),
+            Containers::StridedArrayView2D<char>{data, size});
+        return Trade::ImageData2D{PixelFormat::RGBA8Unorm, _in->gifSize.xy(), Utility::move(data)};
+    }
+
     /* This is a GIF that was loaded already during data opening. Return Nth
        image */
     if(!_in->gifSize.isZero()) {
@@ -186,6 +186,18 @@ frame. Example usage:
 Note that the support for GIF transitions is currently incomplete, see
 [nothings/stb#683](https://github.com/nothings/stb/pull/683) for details.
 
+By default all frames are decoded already when opening the file and kept in
+memory until the file is closed, which can get large for long animations.
+Enabling the @cb{.ini} streamGifFrames @ce
+@ref Trade-StbImageImporter-configuration "configuration option" makes the
+importer only walk the file structure on opening to get the frame count and
+delays, and decode the frames on demand in @ref image2D(). Apart from the file
+data, only the compositing state and the two most recently decoded frames are
+kept in memory. As each frame is composited on top of the previous ones,
+importing frames in order is the fastest, going back further than the two most
+recently decoded frames restarts the decoding from the first frame. Errors in
+frame data are reported only when the frame is imported.
+
 @subsection Trade-StbImageImporter-behavior-arithmetic-jpeg Arithmetic JPEG decoding
 
 [Arithmetic coding](https://en.wikipedia.org/wiki/Arithmetic_coding) is not
@@ -71,6 +71,11 @@ struct StbImageImporterTest: TestSuite::Tester {
     void rgbaPng();
 
     void animatedGif();
+    void animatedGifStream();
+    void animatedGifStreamDisposePrevious();
+    void animatedGifStreamTruncated();
+    void animatedGifStreamTruncatedNoFrames();
+    void animatedGifStreamNotGif();
 
     void forceBitDepth8();
     void forceBitDepth16();
@@ -275,7 +280,12 @@ StbImageImporterTest::StbImageImporterTest() {
 
     addInstancedTests({&StbImageImporterTest::rgbaPng}, Containers::arraySize(RgbaPngTestData));
 
-    addTests({&StbImageImporterTest::animatedGif});
+    addTests({&StbImageImporterTest::animatedGif,
+              &StbImageImporterTest::animatedGifStream,
+              &StbImageImporterTest::animatedGifStreamDisposePrevious,
+              &StbImageImporterTest::animatedGifStreamTruncated,
+              &StbImageImporterTest::animatedGifStreamTruncatedNoFrames,
+              &StbImageImporterTest::animatedGifStreamNotGif});
 
     addInstancedTests({&StbImageImporterTest::forceBitDepth8},
         Containers::arraySize(ForceBitDepth8Data));
@@ -669,6 +679,157 @@ void StbImageImporterTest::animatedGif() {
     }
 }
 
+void StbImageImporterTest::animatedGifStream() {
+    Containers::Pointer<AbstractImporter> reference = _manager.instantiate("StbImageImporter");
+    CORRADE_VERIFY(reference->openFile(Utility::Path::join(STBIMAGEIMPORTER_TEST_DIR, "dispose_bgnd.gif")));
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbImageImporter");
+    importer->configuration().setValue("streamGifFrames", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBIMAGEIMPORTER_TEST_DIR, "dispose_bgnd.gif")));
+
+    /* Frame count and delays are known without decoding any frames */
+    CORRADE_COMPARE(importer->image2DCount(), 5);
+    CORRADE_VERIFY(importer->importerState());
+    CORRADE_COMPARE_AS(
+        Containers::arrayView(reinterpret_cast<const Int*>(importer->importerState()), importer->image2DCount()),
+        Containers::arrayView<Int>({1000, 1000, 1000, 1000, 1000}),
+        TestSuite::Compare::Container);
+
+    /* In order, repeated, going back to one of the two most recently decoded
+       frames, and going further back which restarts the decoding */
+    for(UnsignedInt i: {0, 1, 2, 2, 1, 4, 0, 3}) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(i);
+        Containers::Optional<Trade::ImageData2D> expected = reference->image2D(i);
+        CORRADE_VERIFY(image);
+        CORRADE_VERIFY(expected);
+        CORRADE_COMPARE(image->format(), PixelFormat::RGBA8Unorm);
+        CORRADE_COMPARE(image->size(), Vector2i(100, 100));
+        CORRADE_COMPARE_AS(image->data(), expected->data(),
+            TestSuite::Compare::Container);
+    }
+}
+
+void StbImageImporterTest::animatedGifStreamDisposePrevious() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbImageImporter");
+    importer->configuration().setValue("streamGifFrames", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBIMAGEIMPORTER_TEST_DIR, "dispose-previous.gif")));
+
+    CORRADE_COMPARE(importer->image2DCount(), 4);
+    CORRADE_VERIFY(importer->importerState());
+    CORRADE_COMPARE_AS(
+        Containers::arrayView(reinterpret_cast<const Int*>(importer->importerState()), importer->image2DCount()),
+        Containers::arrayView<Int>({100, 200, 300, 400}),
+        TestSuite::Compare::Container);
+
+    /* Not compared against the non-streaming import as stb_image passes an
+       invalid pointer for the frame two back there. See dispose-previous.py
+       for the frame contents, here it's bottom row first. The third frame is
+       restored to previous after, which stb_image does by restoring to the
+       frame two back, i.e. to the blue square that was cleared to the
+       background after the second frame. */
+    using namespace Math::Literals;
+    const Color4ub r = 0xff0000ff_rgba;
+    const Color4ub b = 0x0000ffff_rgba;
+    const Color4ub g = 0x00ff00ff_rgba;
+    const Color4ub w = 0xffffffff_rgba;
+    const Color4ub expected[][12]{
+        {r, r, r, r,
+         r, r, r, r,
+         r, r, r, r},
+        {r, b, b, r,
+         r, b, b, r,
+         r, r, r, r},
+        {r, g, g, r,
+         r, g, g, r,
+         r, r, r, r},
+        {r, b, b, r,
+         r, b, b, r,
+         r, r, r, w},
+    };
+
+    /* Going back to the frame two back to verify the slots are correctly
+       used, and further back to verify the frame two back is correct after a
+       restart as well */
+    for(UnsignedInt i: {0, 1, 2, 3, 3, 2, 3, 1, 0, 3}) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(i);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE(image->format(), PixelFormat::RGBA8Unorm);
+        CORRADE_COMPARE(image->size(), (Vector2i{4, 3}));
+        CORRADE_COMPARE_AS(image->pixels<Color4ub>().asContiguous(),
+            Containers::arrayView(expected[i]),
+            TestSuite::Compare::Container);
+    }
+}
+
+void StbImageImporterTest::animatedGifStreamTruncated() {
+    Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(STBIMAGEIMPORTER_TEST_DIR, "dispose_bgnd.gif"));
+    CORRADE_VERIFY(data);
+
+    /* Cut in the middle of the fourth frame. stb_image decodes the frame
+       until the end of data and then stops, the streaming import should give
+       back the same. */
+    const Containers::ArrayView<const char> truncated = data->prefix(1100);
+
+    Containers::Pointer<AbstractImporter> reference = _manager.instantiate("StbImageImporter");
+    CORRADE_VERIFY(reference->openData(truncated));
+    CORRADE_COMPARE(reference->image2DCount(), 4);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbImageImporter");
+    importer->configuration().setValue("streamGifFrames", true);
+    CORRADE_VERIFY(importer->openData(truncated));
+    CORRADE_COMPARE(importer->image2DCount(), 4);
+
+    for(UnsignedInt i = 0; i != importer->image2DCount(); ++i) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(i);
+        Containers::Optional<Trade::ImageData2D> expected = reference->image2D(i);
+        CORRADE_VERIFY(image);
+        CORRADE_VERIFY(expected);
+        CORRADE_COMPARE_AS(image->data(), expected->data(),
+            TestSuite::Compare::Container);
+    }
+}
+
+void StbImageImporterTest::animatedGifStreamTruncatedNoFrames() {
+    Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(STBIMAGEIMPORTER_TEST_DIR, "dispose_bgnd.gif"));
+    CORRADE_VERIFY(data);
+
+    /* Cut right before the first image descriptor. Opening succeeds as it
+       falls back to the regular decoding, which then fails. */
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbImageImporter");
+    importer->configuration().setValue("streamGifFrames", true);
+    CORRADE_VERIFY(importer->openData(data->prefix(46)));
+    CORRADE_COMPARE(importer->image2DCount(), 1);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, "Trade::StbImageImporter::image2D(): cannot open the image: unknown code\n");
+}
+
+void StbImageImporterTest::animatedGifStreamNotGif() {
+    Containers::Pointer<AbstractImporter> reference = _manager.instantiate("StbImageImporter");
+    CORRADE_VERIFY(reference->openFile(Utility::Path::join(PNGIMPORTER_TEST_DIR, "rgb.png")));
+
+    /* A non-GIF file is imported the usual way */
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbImageImporter");
+    importer->configuration().setValue("streamGifFrames", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(PNGIMPORTER_TEST_DIR, "rgb.png")));
+    CORRADE_COMPARE(importer->image2DCount(), 1);
+    CORRADE_VERIFY(!importer->importerState());
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    Containers::Optional<Trade::ImageData2D> expected = reference->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_VERIFY(expected);
+    CORRADE_COMPARE(image->format(), expected->format());
+    CORRADE_COMPARE(image->size(), expected->size());
+    CORRADE_COMPARE_AS(image->data(), expected->data(),
+        TestSuite::Compare::Container);
+}
+
 void StbImageImporterTest::forceBitDepth8() {
     auto&& data = ForceBitDepth8Data[testCaseInstanceId()];
     setTestCaseDescription(data.name);
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+
+#
+#   This file is part of Magnum.
+#
+#   Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+#               2020, 2021, 2022, 2023, 2024, 2025
+#             Vladimír Vondruš <mosra@centrum.cz>
+#
+#   Permission is hereby granted, free of charge, to any person obtaining a
+#   copy of this software and associated documentation files (the "Software"),
+#   to deal in the Software without restriction, including without limitation
+#   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+#   and/or sell copies of the Software, and to permit persons to whom the
+#   Software is furnished to do so, subject to the following conditions:
+#
+#   The above copyright notice and this permission notice shall be included
+#   in all copies or substantial portions of the Software.
+#
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+#   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+#   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+#   DEALINGS IN THE SOFTWARE.
+#
+# Generates dispose-previous.gif, a 4x3 animation exercising the "restore to
+# previous" disposal method, which stb_image implements by restoring from the
+# frame two back. No library used as none can produce an arbitrary
+# combination of disposal methods. Usage:
+#
+#   ./dispose-previous.py
+#
+# The frames are:
+#
+#   0.  whole image red, not disposed
+#   1.  2x2 blue square at (1, 1), restored to background after
+#   2.  2x2 green square at (1, 1), restored to previous after
+#   3.  white pixel at (3, 0)
+
+import struct
+
+palette = [(0xff, 0x00, 0x00), (0x00, 0x00, 0xff), (0x00, 0xff, 0x00), (0xff, 0xff, 0xff)]
+
+# x, y, width, height, palette index, disposal method, delay in 1/100 s
+frames = [
+    (0, 0, 4, 3, 0, 1, 10),
+    (1, 1, 2, 2, 1, 2, 20),
+    (1, 1, 2, 2, 2, 3, 30),
+    (3, 0, 1, 1, 3, 1, 40),
+]
+
+# LZW with a 2-bit minimum code size, emitting a clear code after every two
+# pixels so the code size stays at 3 bits and there's no need to implement
+# the dictionary
+def lzw(pixels):
+    clear, end = 4, 5
+    codes = []
+    for i in range(0, len(pixels), 2):
+        codes += [clear] + pixels[i:i + 2]
+    codes += [end]
+
+    bits = 0
+    bitCount = 0
+    out = bytearray()
+    for code in codes:
+        bits |= code << bitCount
+        bitCount += 3
+        while bitCount >= 8:
+            out.append(bits & 0xff)
+            bits >>= 8
+            bitCount -= 8
+    if bitCount:
+        out.append(bits & 0xff)
+
+    blocks = bytearray()
+    for i in range(0, len(out), 255):
+        chunk = out[i:i + 255]
+        blocks += bytes([len(chunk)]) + chunk
+    return bytes([2]) + blocks + b'\0'
+
+data = b'GIF89a' + struct.pack('<HHBBB', 4, 3, 0x81, 0, 0)
+for color in palette:
+    data += bytes(color)
+for x, y, width, height, index, disposal, delay in frames:
+    # Graphic control extension
+    data += struct.pack('<BBBBHBB', 0x21, 0xf9, 4, disposal << 2, delay, 0, 0)
+    # Image descriptor
+    data += struct.pack('<BHHHHB', 0x2c, x, y, width, height, 0)
+    data += lzw([index]*(width*height))
+data += b'\x3b'
+
+with open('dispose-previous.gif', 'wb') as f:
+    f.write(data)
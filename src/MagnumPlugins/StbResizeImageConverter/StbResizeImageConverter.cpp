@@ -27,6 +27,8 @@
 
 #include "StbResizeImageConverter.h"
 
+#include <atomic>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Utility/Algorithms.h>
@@ -34,8 +36,11 @@
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/threadsAndCache.h"
+
 #define STBIR_ASSERT CORRADE_INTERNAL_DEBUG_ASSERT
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #include "stb_image_resize2.h"
@@ -52,69 +57,148 @@ ImageConverterFeatures StbResizeImageConverter::doFeatures() const {
 
 namespace {
 
-Containers::Optional<ImageData3D> convertInternal(const ImageView3D& image, Utility::ConfigurationGroup& configuration) {
+/* Resizes all layers of the source into the destination. The samplers,
+   containing the filter kernels and coefficients, depend only on the input
+   and output size, so they're built just once and then reused for each layer
+   with only the buffer pointers changing. */
+void resizeLayers(const Containers::StridedArrayView4D<const char>& src, const Containers::StridedArrayView4D<char>& dst, const stbir_pixel_layout layout, const stbir_datatype type, const stbir_edge edge, const stbir_filter filter, const std::size_t threadCount) {
+    const auto init = [&](STBIR_RESIZE& resize) {
+        stbir_resize_init(&resize,
+            src.data(), src.size()[2], src.size()[1], src.stride()[1],
+            dst.data(), dst.size()[2], dst.size()[1], dst.stride()[1],
+            layout, type);
+        stbir_set_edgemodes(&resize, edge, edge);
+        stbir_set_filters(&resize, filter, filter);
+    };
+    const auto setLayer = [&](STBIR_RESIZE& resize, const std::size_t z) {
+        stbir_set_buffer_ptrs(&resize,
+            src[z].data(), src.stride()[1],
+            dst[z].data(), dst.stride()[1]);
+    };
+
+    /* Apart from wrong input (which is checked in parseOptions()), the
+       only way the sampler building and resizing could fail is due to a
+       memory allocation failure. Which is likely only when doing some really
+       crazy upsample, and then it'd fail already when allocating the output
+       image. */
+
+    /* If there's at least as many layers as threads, each thread picks the
+       next unprocessed layer until there's none left. As the samplers contain
+       also the buffer pointers and scratch memory, each thread has its own. */
+    const std::size_t layerCount = src.size()[0];
+    if(threadCount <= 1 || layerCount >= threadCount) {
+        std::atomic<std::size_t> nextLayer{0};
+        Implementation::runInThreads(Math::min(threadCount, layerCount), [&]() {
+            STBIR_RESIZE resize;
+            init(resize);
+            CORRADE_INTERNAL_ASSERT_OUTPUT(stbir_build_samplers(&resize));
+            for(std::size_t z; (z = nextLayer++) < layerCount; ) {
+                setLayer(resize, z);
+                CORRADE_INTERNAL_ASSERT_OUTPUT(stbir_resize_extended(&resize));
+            }
+            stbir_free_samplers(&resize);
+        });
+
+    /* Otherwise the output of each layer is split into horizontal stripes
+       that are then processed in parallel. The samplers are built for given
+       split count once, stb_image_resize may decide to use less splits if the
+       output is too small. */
+    } else {
+        STBIR_RESIZE resize;
+        init(resize);
+        const int splitCount = stbir_build_samplers_with_splits(&resize, int(threadCount));
+        CORRADE_INTERNAL_ASSERT(splitCount);
+        for(std::size_t z = 0; z != layerCount; ++z) {
+            setLayer(resize, z);
+            std::atomic<int> nextSplit{0};
+            Implementation::runInThreads(std::size_t(splitCount), [&]() {
+                for(int split; (split = nextSplit++) < splitCount; )
+                    CORRADE_INTERNAL_ASSERT_OUTPUT(stbir_resize_extended_split(&resize, split, 1));
+            });
+        }
+        stbir_free_samplers(&resize);
+    }
+}
+
+struct Options {
+    Vector2i size;
+    stbir_datatype type;
+    stbir_pixel_layout layout;
+    stbir_edge edge;
+    stbir_filter filter;
+    std::size_t threadCount;
+};
+
+/* Checks the input image and parses the configuration. The size option is
+   required unless producing a mip chain, in which case it defaults to the
+   input image size. */
+Containers::Optional<Options> parseOptions(const ImageView3D& image, const Utility::ConfigurationGroup& configuration, const bool mipChain, const char* const messagePrefix) {
     /* Image has to be non-empty, otherwise we hit an assertion deep in the
        algorithm. Overriding STBIR_ASSERT() would help neither making the
        failure graceful nor having a human-readable message. */
     if(!image.size().product()) {
-        Error{} << "Trade::StbResizeImageConverter::convert(): invalid input image size" << Debug::packed << image.size().xy();
+        Error{} << messagePrefix << "invalid input image size" << Debug::packed << image.size().xy();
         return {};
     }
 
+    Options options;
+
     /* Target output size. The final output size depends on whether upscaling is
        disabled. */
-    if(!configuration.value<Containers::StringView>("size")) {
-        Error{} << "Trade::StbResizeImageConverter::convert(): output size was not specified";
-        return {};
-    }
-    const Vector2i targetSize = configuration.value<Vector2i>("size");
-    if(!targetSize.product()) {
-        Error{} << "Trade::StbResizeImageConverter::convert(): invalid output image size" << Debug::packed << targetSize;
+    Vector2i targetSize;
+    if(configuration.value<Containers::StringView>("size")) {
+        targetSize = configuration.value<Vector2i>("size");
+        if(!targetSize.product()) {
+            Error{} << messagePrefix << "invalid output image size" << Debug::packed << targetSize;
+            return {};
+        }
+    } else if(mipChain) {
+        targetSize = image.size().xy();
+    } else {
+        Error{} << messagePrefix << "output size was not specified";
         return {};
     }
 
     /* Actual output size depending on whether upsampling is desired or not */
-    const Vector2i size = configuration.value<bool>("upsample") ? targetSize : Vector2i{Math::min(targetSize, image.size().xy())};
+    options.size = configuration.value<bool>("upsample") ? targetSize : Vector2i{Math::min(targetSize, image.size().xy())};
 
     /* Data type and component count. Branching on isPixelFormatDepthOrStencil()
        to avoid having a dedicated error path for depth/stencil formats. */
-    stbir_datatype type;
     switch(isPixelFormatDepthOrStencil(image.format()) ? image.format() : pixelFormatChannelFormat(image.format())) {
         case PixelFormat::R8Unorm:
-            type = STBIR_TYPE_UINT8;
+            options.type = STBIR_TYPE_UINT8;
             break;
         case PixelFormat::R8Srgb:
-            type = configuration.value<bool>("alphaUsesSrgb") ?
+            options.type = configuration.value<bool>("alphaUsesSrgb") ?
                 STBIR_TYPE_UINT8_SRGB_ALPHA : STBIR_TYPE_UINT8_SRGB;
             break;
         case PixelFormat::R16Unorm:
-            type = STBIR_TYPE_UINT16;
+            options.type = STBIR_TYPE_UINT16;
             break;
         case PixelFormat::R16F:
-            type = STBIR_TYPE_HALF_FLOAT;
+            options.type = STBIR_TYPE_HALF_FLOAT;
             break;
         case PixelFormat::R32F:
-            type = STBIR_TYPE_FLOAT;
+            options.type = STBIR_TYPE_FLOAT;
             break;
         default:
-            Error{} << "Trade::StbResizeImageConverter::convert(): unsupported format" << image.format();
+            Error{} << messagePrefix << "unsupported format" << image.format();
             return {};
     }
 
     /* Channel layout */
-    stbir_pixel_layout layout;
     switch(pixelFormatChannelCount(image.format())) {
         case 1:
-            layout = STBIR_1CHANNEL;
+            options.layout = STBIR_1CHANNEL;
             break;
         case 2:
-            layout = STBIR_2CHANNEL;
+            options.layout = STBIR_2CHANNEL;
             break;
         case 3:
-            layout = STBIR_RGB;
+            options.layout = STBIR_RGB;
             break;
         case 4:
-            layout = configuration.value<bool>("alphaPremultiplied") ?
+            options.layout = configuration.value<bool>("alphaPremultiplied") ?
                 STBIR_RGBA_PM : STBIR_RGBA;
             break;
         default: CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
@@ -122,104 +206,202 @@ Containers::Optional<ImageData3D> convertInternal(const ImageView3D& image, Util
 
     /* Edge mode */
     const Containers::StringView edgeString = configuration.value<Containers::StringView>("edge");
-    stbir_edge edge;
     /* LCOV_EXCL_START, it makes no sense to test each and every */
     if(edgeString == "clamp"_s)
-        edge = STBIR_EDGE_CLAMP;
+        options.edge = STBIR_EDGE_CLAMP;
     else if(edgeString == "reflect"_s)
-        edge = STBIR_EDGE_REFLECT;
+        options.edge = STBIR_EDGE_REFLECT;
     else if(edgeString == "wrap"_s)
-        edge = STBIR_EDGE_WRAP;
+        options.edge = STBIR_EDGE_WRAP;
     else if(edgeString == "zero"_s)
-        edge = STBIR_EDGE_ZERO;
+        options.edge = STBIR_EDGE_ZERO;
     /* LCOV_EXCL_STOP */
     else {
-        Error{} << "Trade::StbResizeImageConverter::convert(): expected edge mode to be one of clamp, reflect, wrap or zero, got" << edgeString;
+        Error{} << messagePrefix << "expected edge mode to be one of clamp, reflect, wrap or zero, got" << edgeString;
         return {};
     }
 
     /* Filter */
     const Containers::StringView filterString = configuration.value<Containers::StringView>("filter");
-    stbir_filter filter;
     /* LCOV_EXCL_START, it makes no sense to test each and every */
     if(!filterString)
-        filter = STBIR_FILTER_DEFAULT;
+        options.filter = STBIR_FILTER_DEFAULT;
     else if(filterString == "box"_s)
-        filter = STBIR_FILTER_BOX;
+        options.filter = STBIR_FILTER_BOX;
     else if(filterString == "triangle"_s)
-        filter = STBIR_FILTER_TRIANGLE;
+        options.filter = STBIR_FILTER_TRIANGLE;
     else if(filterString == "cubicspline"_s)
-        filter = STBIR_FILTER_CUBICBSPLINE;
+        options.filter = STBIR_FILTER_CUBICBSPLINE;
     else if(filterString == "catmullrom"_s)
-        filter = STBIR_FILTER_CATMULLROM;
+        options.filter = STBIR_FILTER_CATMULLROM;
     else if(filterString == "mitchell"_s)
-        filter = STBIR_FILTER_MITCHELL;
+        options.filter = STBIR_FILTER_MITCHELL;
     else if(filterString == "point"_s)
-        filter = STBIR_FILTER_POINT_SAMPLE;
+        options.filter = STBIR_FILTER_POINT_SAMPLE;
     /* LCOV_EXCL_STOP */
     else {
-        Error{} << "Trade::StbResizeImageConverter::convert(): expected filter to be empty or one of box, triangle, cubicspline, catmullrom, mitchell or point, got" << filterString;
+        Error{} << messagePrefix << "expected filter to be empty or one of box, triangle, cubicspline, catmullrom, mitchell or point, got" << filterString;
         return {};
     }
 
-    /* Always align output rows at four bytes */
+    /* Value of 0 means all hardware threads, 1 means resizing serially in
+       the calling thread */
+    options.threadCount = Implementation::threadCount(configuration.value<UnsignedInt>("threads"));
+
+    /* GCC 4.8 needs extra help here */
+    return Containers::optional(options);
+}
+
+/* Resizes all layers of the image to given size, returning a new image with
+   the default pixel storage */
+ImageData3D resize(const ImageView3D& image, const Vector2i& size, const Options& options) {
     const std::size_t stride = 4*((size.x()*image.pixelSize() + 3)/4);
-    Trade::ImageData3D out{image.format(), {size, image.size().z()}, Containers::Array<char>{NoInit, stride*size.y()*image.size().z()}, image.flags()};
+    Containers::Array<char> data{NoInit, stride*size.y()*image.size().z()};
+    const MutableImageView3D out{image.format(), {size, image.size().z()}, data};
+
+    /* If the size is the same as the image size (which is also the case if
+       upsampling is disabled and the image is smaller or equal in both
+       dimensions than the target), just copy the data over to avoid needless
+       work and undesired artifacts */
+    if(size == image.size().xy())
+        Utility::copy(image.pixels(), out.pixels());
+    else
+        resizeLayers(image.pixels(), out.pixels(), options.layout, options.type, options.edge, options.filter, options.threadCount);
+
+    return ImageData3D{image.format(), {size, image.size().z()}, Utility::move(data), image.flags()};
+}
 
-    const Containers::StridedArrayView4D<const char> srcPixels = image.pixels();
-    const Containers::StridedArrayView4D<char> dstPixels = out.mutablePixels();
+/* The converter works with 3D images internally, 2D images are a single
+   layer */
+ImageData2D to2D(ImageData3D&& image) {
+    CORRADE_INTERNAL_ASSERT(image.size().z() == 1);
+    const Vector2i size = image.size().xy();
+    return ImageData2D{image.format(), size, image.release(), ImageFlag2D(UnsignedShort(image.flags()))};
+}
 
-    /* If the target size is the same as the image size, or if upsampling is
-       disabled and the image is smaller (or equal) in both dimensions, just
-       copy the data over to avoid needless work and undesired artifacts */
-    if(image.size().xy() == targetSize || (!configuration.value<bool>("upsample") && (image.size().xy() <= targetSize).all())) {
-        Utility::copy(srcPixels, dstPixels);
-        return Containers::optional(Utility::move(out));
-    }
+Containers::Optional<ImageData3D> convertInternal(const ImageView3D& image, const Utility::ConfigurationGroup& configuration) {
+    const Containers::Optional<Options> options = parseOptions(image, configuration, false, "Trade::StbResizeImageConverter::convert():");
+    if(!options)
+        return {};
 
-    /* Apart from wrong input (which we check here), the only way this function
-       could fail is due to a memory allocation failure. Which is likely only
-       when doing some really crazy upsample, and then it'd fail already when
-       allocating the output image above. */
-    for(std::size_t z = 0, zMax = image.size().z(); z != zMax; ++z) {
-        const Containers::StridedArrayView3D<const char> srcPixelLayer = srcPixels[z];
-        const Containers::StridedArrayView3D<char> dstPixelLayer = dstPixels[z];
-        CORRADE_INTERNAL_ASSERT_OUTPUT(stbir_resize(
-            srcPixelLayer.data(), srcPixelLayer.size()[1], srcPixelLayer.size()[0], srcPixelLayer.stride()[0],
-            dstPixelLayer.data(), dstPixelLayer.size()[1], dstPixelLayer.size()[0], dstPixelLayer.stride()[0],
-            layout, type, edge, filter));
+    return resize(image, options->size, *options);
+}
+
+Containers::Optional<Containers::Array<ImageData3D>> convertMipChainInternal(const ImageView3D& image, const Utility::ConfigurationGroup& configuration) {
+    const Containers::Optional<Options> options = parseOptions(image, configuration, true, "Trade::StbResizeImageConverter::convertMipChain():");
+    if(!options)
+        return {};
+
+    /* Each next level is half the size of the previous one, rounded down,
+       until reaching 1x1 */
+    const std::size_t levelCount = Math::log2(UnsignedInt(options->size.max())) + 1;
+    Containers::Array<ImageData3D> levels;
+    arrayReserve(levels, levelCount);
+
+    /* By default, each next level is resampled from the previous one, which
+       is the cheapest option. The levels are then processed one after
+       another, with each using all threads. */
+    if(!configuration.value<bool>("mipChainFromSource")) {
+        Vector2i size = options->size;
+        for(std::size_t i = 0; i != levelCount; ++i) {
+            const ImageView3D source = i ? ImageView3D(levels.back()) : image;
+            ImageData3D level = resize(source, size, *options);
+            arrayAppend(levels, Utility::move(level));
+            size = Math::max(size/2, Vector2i{1});
+        }
+
+    /* Alternatively all levels are resampled directly from the source to
+       avoid accumulating filtering error. Then the levels don't depend on
+       each other, so whole levels are distributed among the threads, each
+       resized serially. As every level reads the whole source, the work per
+       level doesn't shrink as fast as the level size, and the largest levels
+       get picked first. */
+    } else {
+        Containers::Array<Vector2i> sizes{NoInit, levelCount};
+        for(std::size_t i = 0; i != levelCount; ++i)
+            sizes[i] = i ? Math::max(sizes[i - 1]/2, Vector2i{1}) : options->size;
+
+        Options levelOptions = *options;
+        levelOptions.threadCount = 1;
+        Containers::Array<Containers::Optional<ImageData3D>> results{levelCount};
+        Implementation::parallelFor(options->threadCount, levelCount, [&](const std::size_t i) {
+            results[i] = resize(image, sizes[i], levelOptions);
+        });
+
+        for(Containers::Optional<ImageData3D>& level: results)
+            arrayAppend(levels, Utility::move(*level));
     }
 
+    /* Can't use growable deleters in a plugin, convert back to the default
+       deleter */
+    arrayShrink(levels);
+
     /* GCC 4.8 needs extra help here */
-    return Containers::optional(Utility::move(out));
+    return Containers::optional(Utility::move(levels));
 }
 
 }
 
 Containers::Optional<ImageData2D> StbResizeImageConverter::doConvert(const ImageView2D& image) {
+    const char* const messagePrefix = _mipChain2D ? "Trade::StbResizeImageConverter::convertMipChain():" : "Trade::StbResizeImageConverter::convert():";
+
     if(image.flags() & ImageFlag2D::Array) {
         /** @todo or take only the X size instead? then it would make sense to
             provide also a non-array 1D variant */
-        Error{} << "Trade::StbResizeImageConverter::convert(): 1D array images are not supported";
+        Error{} << messagePrefix << "1D array images are not supported";
         return {};
     }
 
-    Containers::Optional<ImageData3D> out = convertInternal(image, configuration());
-    if(!out)
+    if(!_mipChain2D) {
+        Containers::Optional<ImageData3D> out = convertInternal(image, configuration());
+        if(!out)
+            return {};
+
+        return to2D(Utility::move(*out));
+    }
+
+    /* Called from convertMipChain(), put all levels into the array it passed
+       and return the first one */
+    Containers::Optional<Containers::Array<ImageData3D>> levels = convertMipChainInternal(image, configuration());
+    if(!levels)
         return {};
 
-    CORRADE_INTERNAL_ASSERT(out->size().z() == 1);
-    const Vector2i size = out->size().xy();
-    return ImageData2D{out->format(), size, out->release(), ImageFlag2D(UnsignedShort(out->flags()))};
+    Containers::Array<ImageData2D> out;
+    arrayReserve(out, levels->size());
+    for(ImageData3D& level: *levels)
+        arrayAppend(out, to2D(Utility::move(level)));
+
+    /* Can't use growable deleters in a plugin, convert back to the default
+       deleter */
+    arrayShrink(out);
+
+    ImageData2D first = Utility::move(out[0]);
+    *_mipChain2D = Utility::move(out);
+    /* GCC 4.8 needs extra help here */
+    return Containers::optional(Utility::move(first));
 }
 
 Containers::Optional<ImageData3D> StbResizeImageConverter::doConvert(const ImageView3D& image) {
+    const char* const messagePrefix = _mipChain3D ? "Trade::StbResizeImageConverter::convertMipChain():" : "Trade::StbResizeImageConverter::convert():";
+
     if(!(image.flags() & (ImageFlag3D::Array|ImageFlag3D::CubeMap))) {
-        Error{} << "Trade::StbResizeImageConverter::convert(): 3D images are not supported";
+        Error{} << messagePrefix << "3D images are not supported";
         return {};
     }
 
-    return convertInternal(image, configuration());
+    if(!_mipChain3D)
+        return convertInternal(image, configuration());
+
+    /* Called from convertMipChain(), put all levels into the array it passed
+       and return the first one */
+    Containers::Optional<Containers::Array<ImageData3D>> levels = convertMipChainInternal(image, configuration());
+    if(!levels)
+        return {};
+
+    ImageData3D first = Utility::move((*levels)[0]);
+    *_mipChain3D = Utility::move(*levels);
+    /* GCC 4.8 needs extra help here */
+    return Containers::optional(Utility::move(first));
 }
 
 }}
@@ -31,7 +31,11 @@
  * @m_since_latest_{plugins}
  */
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/Move.h>
 #include <Magnum/Trade/AbstractImageConverter.h>
+#include <Magnum/Trade/ImageData.h>
 
 #include "MagnumPlugins/StbResizeImageConverter/configure.h"
 
@@ -139,9 +143,56 @@ and 1D array images (with @ref ImageFlag2D::Array set) are not supported, 3D
 images are expected to have either @ref ImageFlag3D::Array nor
 @ref ImageFlag3D::CubeMap set.
 
+@subsection Trade-StbResizeImageConverter-behavior-mip-chain Mip chain generation
+
+As the @ref AbstractImageConverter interface returns just a single image, a
+full mip chain is produced through the plugin-specific
+@ref convertMipChain(const ImageView2D&) and
+@ref convertMipChain(const ImageView3D&) functions instead. They return a list
+of images, the first having the size given by the @cb{.ini} size @ce
+@ref Trade-StbResizeImageConverter-configuration "configuration option" and
+each next one having half the size of the previous one rounded down, until
+reaching a size of @cpp {1, 1} @ce. Every level contains all array layers or
+cube map faces.
+
+@snippet StbResizeImageConverter.cpp mip-chain
+
+The @cb{.ini} size @ce option is optional in this case, if not specified the
+first level has the same size as the input image and is copied unchanged. The
+filter kernels and coefficients are calculated just once for each level and
+reused for all its layers.
+
+Both functions are defined inline and only go through the generic
+@ref convert() with internal state telling it to produce all levels, which
+means they can be used also with a plugin instance that's loaded
+dynamically, as shown in the snippet above.
+
+By default each level is resampled from the previous one, which is the
+fastest but accumulates filtering error. Enabling the
+@cb{.ini} mipChainFromSource @ce option resamples every level directly from
+the input image instead.
+
+@subsection Trade-StbResizeImageConverter-behavior-multithreading Multithreaded resizing
+
+By default the image is resized serially in the calling thread. Setting the
+@cb{.ini} threads @ce @ref Trade-StbResizeImageConverter-configuration "configuration option"
+to a value other than @cpp 1 @ce makes the resize use given count of threads,
+with @cpp 0 @ce using all hardware threads. If the image has at least as many
+array layers or cube map faces as there's threads, whole layers are
+distributed among the threads, otherwise the output of each layer is split
+into horizontal stripes that are resized in parallel. With a
+@ref Trade-StbResizeImageConverter-behavior-mip-chain "mip chain" the levels
+are by default processed one after another, each using all threads. If the
+@cb{.ini} mipChainFromSource @ce option is enabled, the levels don't depend
+on each other and whole levels are distributed among the threads instead.
+The output is the same regardless of the thread count.
+
+On Linux, using more than one thread requires the application to be linked
+to `pthread`, see @ref cmake-plugins-threads for details.
+
 @section Trade-StbResizeImageConverter-configuration Plugin-specific configuration
 
-Apart from the mandatory @cb{.ini} size @ce, other options can be set through
+Apart from the @cb{.ini} size @ce, other options can be set through
 @ref configuration(). See below for all options and their default values:
 
 @snippet MagnumPlugins/StbResizeImageConverter/StbResizeImageConverter.conf configuration_
@@ -154,10 +205,57 @@ class MAGNUM_STBRESIZEIMAGECONVERTER_EXPORT StbResizeImageConverter: public Abst
         /** @brief Plugin manager constructor */
         explicit StbResizeImageConverter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin);
 
+        /**
+         * @brief Convert a 2D image to a mip chain
+         *
+         * Returns the image resized to the @cb{.ini} size @ce
+         * @ref Trade-StbResizeImageConverter-configuration "configuration option"
+         * or to the input size if not set, followed by all smaller levels
+         * down to @cpp {1, 1} @ce. Expects the same input as
+         * @ref convert(const ImageView2D&), on failure
+         * prints a message to @relativeref{Magnum,Error} and returns
+         * @relativeref{Corrade,Containers::NullOpt}. See
+         * @ref Trade-StbResizeImageConverter-behavior-mip-chain for more
+         * information.
+         */
+        Containers::Optional<Containers::Array<ImageData2D>> convertMipChain(const ImageView2D& image) {
+            /* The implementation puts all levels into the array and returns
+               the first one, leaving a moved-out instance in its place */
+            Containers::Array<ImageData2D> levels;
+            _mipChain2D = &levels;
+            Containers::Optional<ImageData2D> first = convert(image);
+            _mipChain2D = nullptr;
+            if(!first) return {};
+            levels[0] = Utility::move(*first);
+            /* GCC 4.8 needs extra help here */
+            return Containers::optional(Utility::move(levels));
+        }
+
+        /**
+         * @brief Convert a 2D array or cube map image to a mip chain
+         *
+         * Like @ref convertMipChain(const ImageView2D&), but for images
+         * with @ref ImageFlag3D::Array or @ref ImageFlag3D::CubeMap set.
+         */
+        Containers::Optional<Containers::Array<ImageData3D>> convertMipChain(const ImageView3D& image) {
+            Containers::Array<ImageData3D> levels;
+            _mipChain3D = &levels;
+            Containers::Optional<ImageData3D> first = convert(image);
+            _mipChain3D = nullptr;
+            if(!first) return {};
+            levels[0] = Utility::move(*first);
+            /* GCC 4.8 needs extra help here */
+            return Containers::optional(Utility::move(levels));
+        }
+
     private:
         MAGNUM_STBRESIZEIMAGECONVERTER_LOCAL ImageConverterFeatures doFeatures() const override;
         MAGNUM_STBRESIZEIMAGECONVERTER_LOCAL Containers::Optional<ImageData2D> doConvert(const ImageView2D& image) override;
         MAGNUM_STBRESIZEIMAGECONVERTER_LOCAL Containers::Optional<ImageData3D> doConvert(const ImageView3D& image) override;
+
+        /* Set only for the duration of a convertMipChain() call */
+        Containers::Array<ImageData2D>* _mipChain2D{};
+        Containers::Array<ImageData3D>* _mipChain3D{};
 };
 
 }}
@@ -25,9 +25,11 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
@@ -38,6 +40,8 @@
 #include <Magnum/Trade/AbstractImageConverter.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "MagnumPlugins/StbResizeImageConverter/StbResizeImageConverter.h"
+
 #include "configure.h"
 
 namespace Magnum { namespace Trade { namespace Test { namespace {
@@ -66,6 +70,14 @@ struct StbResizeImageConverterTest: TestSuite::Tester {
 
     void upsample();
 
+    void mipChain();
+    void mipChainArray();
+    void mipChainInvalid();
+
+    void threads();
+
+    void benchmark();
+
     /* Explicitly forbid system-wide plugin dependencies */
     PluginManager::Manager<AbstractImageConverter> _converterManager{"nonexistent"};
 };
@@ -137,6 +149,58 @@ const struct {
         {0xff3366_rgb, 0xff6633_rgb, 0x66ffcc_rgb, {}}},
 };
 
+const struct {
+    const char* name;
+    Containers::Optional<Vector2i> size;
+    bool fromSource;
+    Containers::Optional<UnsignedInt> threads;
+    std::size_t levelCount;
+    Vector2i expectedSizes[3];
+} MipChainData[]{
+    {"", {}, false, {},
+        3, {{7, 5}, {3, 2}, {1, 1}}},
+    {"target size", Vector2i{4, 3}, false, {},
+        3, {{4, 3}, {2, 1}, {1, 1}}},
+    {"target size, single level", Vector2i{1, 1}, false, {},
+        1, {{1, 1}}},
+    {"from source", {}, true, {},
+        3, {{7, 5}, {3, 2}, {1, 1}}},
+    {"from source, target size", Vector2i{4, 3}, true, {},
+        3, {{4, 3}, {2, 1}, {1, 1}}},
+    {"from source, 2 threads", {}, true, 2,
+        3, {{7, 5}, {3, 2}, {1, 1}}},
+    {"from source, 64 threads", Vector2i{4, 3}, true, 64,
+        3, {{4, 3}, {2, 1}, {1, 1}}},
+    {"from source, all hardware threads", {}, true, 0,
+        3, {{7, 5}, {3, 2}, {1, 1}}},
+};
+
+const struct {
+    const char* name;
+    Vector3i size;
+    Vector2i targetSize;
+    UnsignedInt threads;
+} ThreadsData[]{
+    {"2D, 2 threads", {64, 48, 1}, {32, 16}, 2},
+    {"2D, 64 threads", {64, 48, 1}, {32, 16}, 64},
+    {"2D, upsample, 3 threads", {16, 12, 1}, {48, 40}, 3},
+    {"2D, too small to split, 4 threads", {8, 6, 1}, {4, 3}, 4},
+    {"array, layers distributed, 3 threads", {32, 24, 5}, {12, 16}, 3},
+    {"array, layers split, 5 threads", {32, 24, 2}, {12, 16}, 5},
+    {"array, all hardware threads", {32, 24, 3}, {12, 16}, 0},
+};
+
+const struct {
+    const char* name;
+    PixelFormat format;
+    UnsignedInt threads;
+} BenchmarkData[]{
+    {"RGBA8, 7680x4320 (33.18 MPix)", PixelFormat::RGBA8Unorm, 1},
+    {"RGBA8, 7680x4320 (33.18 MPix), all hardware threads", PixelFormat::RGBA8Unorm, 0},
+    {"RGBA16F, 7680x4320 (33.18 MPix)", PixelFormat::RGBA16F, 1},
+    {"RGBA16F, 7680x4320 (33.18 MPix), all hardware threads", PixelFormat::RGBA16F, 0},
+};
+
 StbResizeImageConverterTest::StbResizeImageConverterTest() {
     addTests({&StbResizeImageConverterTest::emptySize,
               &StbResizeImageConverterTest::emptyInputImage,
@@ -161,6 +225,20 @@ StbResizeImageConverterTest::StbResizeImageConverterTest() {
     addInstancedTests({&StbResizeImageConverterTest::upsample},
         Containers::arraySize(UpsampleData));
 
+    addInstancedTests({&StbResizeImageConverterTest::mipChain},
+        Containers::arraySize(MipChainData));
+
+    addTests({&StbResizeImageConverterTest::mipChainArray,
+              &StbResizeImageConverterTest::mipChainInvalid});
+
+    addInstancedTests({&StbResizeImageConverterTest::threads},
+        Containers::arraySize(ThreadsData));
+
+    /* Wall time, divide the megapixel count in the instance name by the
+       reported time to get MPix/s */
+    addInstancedBenchmarks({&StbResizeImageConverterTest::benchmark}, 3,
+        Containers::arraySize(BenchmarkData), BenchmarkType::WallTime);
+
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
     #ifdef STBRESIZEIMAGECONVERTER_PLUGIN_FILENAME
@@ -487,6 +565,160 @@ void StbResizeImageConverterTest::upsample() {
         }), DebugTools::CompareImage);
 }
 
+void StbResizeImageConverterTest::mipChain() {
+    auto&& data = MipChainData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Some arbitrary pattern, with odd sizes and rows not aligned to four
+       bytes */
+    Color3ub input[7*5];
+    for(std::size_t i = 0; i != Containers::arraySize(input); ++i)
+        input[i] = Color3ub{UnsignedByte(i*37), UnsignedByte(255 - i*11), UnsignedByte(i*i)};
+    const ImageView2D image{PixelStorage{}.setAlignment(1), PixelFormat::RGB8Unorm, {7, 5}, input, ImageFlag2D(0xdea0)};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("StbResizeImageConverter");
+    converter->configuration().setValue("mipChainFromSource", data.fromSource);
+    if(data.size)
+        converter->configuration().setValue("size", *data.size);
+    if(data.threads)
+        converter->configuration().setValue("threads", *data.threads);
+
+    Containers::Optional<Containers::Array<ImageData2D>> out = static_cast<StbResizeImageConverter&>(*converter).convertMipChain(image);
+    CORRADE_VERIFY(out);
+    CORRADE_COMPARE(out->size(), data.levelCount);
+
+    /* Each level should be exactly the same as when resized separately,
+       either from the source or from the previous level */
+    Containers::Pointer<AbstractImageConverter> reference = _converterManager.instantiate("StbResizeImageConverter");
+    for(std::size_t i = 0; i != data.levelCount; ++i) {
+        CORRADE_ITERATION(i);
+        const ImageData2D& level = (*out)[i];
+        CORRADE_COMPARE(level.size(), data.expectedSizes[i]);
+        /* Flags should be passed through unchanged to all levels */
+        CORRADE_COMPARE(level.flags(), ImageFlag2D(0xdea0));
+        /* The data should contain just the level itself */
+        CORRADE_COMPARE(level.data().size(), std::size_t(level.pixels().stride()[0]*level.size().y()));
+
+        reference->configuration().setValue("size", data.expectedSizes[i]);
+        Containers::Optional<ImageData2D> expected = reference->convert(i && !data.fromSource ? ImageView2D((*out)[i - 1]) : image);
+        CORRADE_VERIFY(expected);
+        CORRADE_COMPARE_AS(level, *expected, DebugTools::CompareImage);
+    }
+}
+
+void StbResizeImageConverterTest::mipChainArray() {
+    /* Two layers with the second one having the pattern reversed, so any
+       cross-layer filtering would be visible */
+    Color4ub input[5*4*2];
+    for(std::size_t i = 0; i != 5*4; ++i)
+        input[i] = input[5*4*2 - i - 1] = Color4ub{UnsignedByte(i*37), UnsignedByte(255 - i*11), UnsignedByte(i*i), UnsignedByte(255 - i)};
+    const ImageView3D image{PixelFormat::RGBA8Unorm, {5, 4, 2}, input, ImageFlag3D::Array};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("StbResizeImageConverter");
+    converter->configuration().setValue("size", (Vector2i{4, 4}));
+
+    Containers::Optional<Containers::Array<ImageData3D>> out = static_cast<StbResizeImageConverter&>(*converter).convertMipChain(image);
+    CORRADE_VERIFY(out);
+    CORRADE_COMPARE(out->size(), 3);
+
+    /* Each level should contain all layers and be the same as when resized
+       separately. The rows are always four-byte aligned with RGBA8 so the
+       data can be compared directly. */
+    Containers::Pointer<AbstractImageConverter> reference = _converterManager.instantiate("StbResizeImageConverter");
+    const Vector2i sizes[]{{4, 4}, {2, 2}, {1, 1}};
+    for(std::size_t i = 0; i != Containers::arraySize(sizes); ++i) {
+        CORRADE_ITERATION(i);
+        const ImageData3D& level = (*out)[i];
+        CORRADE_COMPARE(level.size(), (Vector3i{sizes[i], 2}));
+        CORRADE_COMPARE(level.flags(), ImageFlag3D::Array);
+
+        reference->configuration().setValue("size", sizes[i]);
+        Containers::Optional<ImageData3D> expected = reference->convert(i ? ImageView3D((*out)[i - 1]) : image);
+        CORRADE_VERIFY(expected);
+        CORRADE_COMPARE_AS(level.data(),
+            expected->data(),
+            TestSuite::Compare::Container);
+    }
+}
+
+void StbResizeImageConverterTest::mipChainInvalid() {
+    const char data[4]{};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("StbResizeImageConverter");
+    StbResizeImageConverter& resizer = static_cast<StbResizeImageConverter&>(*converter);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!resizer.convertMipChain(ImageView2D{PixelFormat::RGBA8Unorm, {1, 1}, data, ImageFlag2D::Array}));
+    CORRADE_VERIFY(!resizer.convertMipChain(ImageView3D{PixelFormat::RGBA8Unorm, {1, 1, 1}, data}));
+    CORRADE_VERIFY(!resizer.convertMipChain(ImageView2D{PixelFormat::RGBA8Unorm, {1, 0}, nullptr}));
+    CORRADE_VERIFY(!resizer.convertMipChain(ImageView2D{PixelFormat::RGBA8UI, {1, 1}, data}));
+    /* The mip chain state shouldn't leak into subsequent convert() calls */
+    CORRADE_VERIFY(!converter->convert(ImageView2D{PixelFormat::RGBA8Unorm, {1, 1}, data, ImageFlag2D::Array}));
+    CORRADE_VERIFY(!converter->convert(ImageView3D{PixelFormat::RGBA8Unorm, {1, 1, 1}, data}));
+    CORRADE_COMPARE(out,
+        "Trade::StbResizeImageConverter::convertMipChain(): 1D array images are not supported\n"
+        "Trade::StbResizeImageConverter::convertMipChain(): 3D images are not supported\n"
+        "Trade::StbResizeImageConverter::convertMipChain(): invalid input image size {1, 0}\n"
+        "Trade::StbResizeImageConverter::convertMipChain(): unsupported format PixelFormat::RGBA8UI\n"
+        "Trade::StbResizeImageConverter::convert(): 1D array images are not supported\n"
+        "Trade::StbResizeImageConverter::convert(): 3D images are not supported\n");
+}
+
+void StbResizeImageConverterTest::threads() {
+    auto&& data = ThreadsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Some arbitrary pattern */
+    Containers::Array<Color4ub> input{NoInit, std::size_t(data.size.product())};
+    for(std::size_t i = 0; i != input.size(); ++i)
+        input[i] = Color4ub{UnsignedByte(i*37), UnsignedByte(255 - i*11), UnsignedByte(i*i), UnsignedByte(i ^ (i >> 3))};
+    const ImageView3D image{PixelFormat::RGBA8Unorm, data.size, input, ImageFlag3D::Array};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("StbResizeImageConverter");
+    converter->configuration().setValue("size", data.targetSize);
+    Containers::Optional<ImageData3D> expected = converter->convert(image);
+    CORRADE_VERIFY(expected);
+
+    converter->configuration().setValue("threads", data.threads);
+    Containers::Optional<ImageData3D> out = converter->convert(image);
+    CORRADE_VERIFY(out);
+    CORRADE_COMPARE(out->size(), (Vector3i{data.targetSize, data.size.z()}));
+
+    /* The output should be exactly the same as when resizing serially */
+    CORRADE_COMPARE_AS(out->data(),
+        expected->data(),
+        TestSuite::Compare::Container);
+}
+
+void StbResizeImageConverterTest::benchmark() {
+    auto&& data = BenchmarkData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Some arbitrary gradients with a bit of noise. For RGBA16F the upper
+       byte of each half-float is fixed, which keeps the values finite and in
+       a sane range */
+    const Vector2i size{7680, 4320};
+    const std::size_t pixelSize = pixelFormatSize(data.format);
+    Containers::Array<char> pixels{NoInit, std::size_t(size.product())*pixelSize};
+    for(std::size_t y = 0; y != std::size_t(size.y()); ++y)
+        for(std::size_t x = 0; x != std::size_t(size.x()); ++x)
+            for(std::size_t c = 0; c != pixelSize; ++c)
+                pixels[(y*size.x() + x)*pixelSize + c] = pixelSize == 8 && (c & 1) ? '\x30' : char(x*(c + 1) + y*(3 - c) + ((x*y) >> 3)*(c & 1));
+    const ImageView2D image{data.format, size, pixels};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("StbResizeImageConverter");
+    converter->configuration().setValue("size", size/2);
+    converter->configuration().setValue("threads", data.threads);
+
+    Containers::Optional<ImageData2D> out;
+    CORRADE_BENCHMARK(1)
+        out = converter->convert(image);
+
+    CORRADE_VERIFY(out);
+    CORRADE_COMPARE(out->size(), size/2);
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::Trade::Test::StbResizeImageConverterTest)
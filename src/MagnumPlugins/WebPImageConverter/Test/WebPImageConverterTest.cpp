@@ -53,6 +53,8 @@ struct WebPImageConverterTest: TestSuite::Tester {
 
     void rgb();
     void rgba();
+    void speedOptions();
+    void speedOptionsMethodSize();
     void importFailed();
     void encodingFailed();
 
@@ -69,16 +71,19 @@ const struct {
     Containers::Optional<Int> lossless;
     Containers::Optional<Float> lossy;
     Containers::Optional<Int> alphaQuality;
+    Containers::Optional<Int> method;
     const char* expectedError;
 } InvalidConfigurationData[]{
-    {"invalid preset", "portrait", {}, {}, {},
+    {"invalid preset", "portrait", {}, {}, {}, {},
         "expected preset to be one of lossless, default, picture, photo, drawing, icon or text but got portrait"},
-    {"invalid lossless level", nullptr, 10, {}, {},
+    {"invalid lossless level", nullptr, 10, {}, {}, {},
         "cannot apply a lossless preset with level 10"},
-    {"invalid lossy quality", "photo", {}, 100.1, {},
+    {"invalid lossy quality", "photo", {}, 100.1, {}, {},
         "cannot apply a photo preset with quality 100.1"},
-    {"invalid alpha quality", nullptr, {}, {}, 101,
-        "option validation failed, check the alphaQuality configuration option"},
+    {"invalid alpha quality", nullptr, {}, {}, 101, {},
+        "option validation failed, check the alphaQuality and method configuration options"},
+    {"invalid method", nullptr, {}, {}, {}, 7,
+        "option validation failed, check the alphaQuality and method configuration options"},
 };
 
 const struct {
@@ -141,6 +146,39 @@ const struct {
         "drawing", {}, 0, 71.0f, 23.34f, 124},
 };
 
+const struct {
+    const char* name;
+    const char* preset;
+    Containers::Optional<Int> method;
+    Containers::Optional<bool> lowMemory;
+    Containers::Optional<bool> multithreaded;
+    Float maxThreshold, meanThreshold;
+} SpeedOptionsData[]{
+    /* None of these should affect the lossless output, only speed and size */
+    {"lossless, method 0",
+        "lossless", 0, {}, {}, 0.0f, 0.0f},
+    {"lossless, method 6",
+        "lossless", 6, {}, {}, 0.0f, 0.0f},
+    {"lossless, low memory",
+        "lossless", {}, true, {}, 0.0f, 0.0f},
+    {"lossless, multithreaded",
+        "lossless", {}, {}, true, 0.0f, 0.0f},
+    /* Lossy output differs with the method, use the thresholds of the
+       lossy default from rgb() with some headroom */
+    {"lossy, method 0, low memory, multithreaded",
+        "default", 0, true, true, 20.0f, 8.0f},
+    {"lossy, method 6, multithreaded",
+        "default", 6, {}, true, 20.0f, 8.0f},
+};
+
+const struct {
+    const char* name;
+    const char* preset;
+} SpeedOptionsMethodSizeData[]{
+    {"lossless", "lossless"},
+    {"lossy", "default"},
+};
+
 const struct {
     const char* name;
     ImageConverterFlags converterFlags;
@@ -165,6 +203,12 @@ WebPImageConverterTest::WebPImageConverterTest() {
     addInstancedTests({&WebPImageConverterTest::rgba},
         Containers::arraySize(RgbaData));
 
+    addInstancedTests({&WebPImageConverterTest::speedOptions},
+        Containers::arraySize(SpeedOptionsData));
+
+    addInstancedTests({&WebPImageConverterTest::speedOptionsMethodSize},
+        Containers::arraySize(SpeedOptionsMethodSizeData));
+
     addTests({&WebPImageConverterTest::importFailed,
               &WebPImageConverterTest::encodingFailed});
 
@@ -195,6 +239,8 @@ void WebPImageConverterTest::invalidConfiguration() {
         converter->configuration().setValue("lossy", *data.lossy);
     if(data.alphaQuality)
         converter->configuration().setValue("alphaQuality", *data.alphaQuality);
+    if(data.method)
+        converter->configuration().setValue("method", *data.method);
 
     Containers::String out;
     Error redirectError{&out};
@@ -331,6 +377,56 @@ void WebPImageConverterTest::rgba() {
         TestSuite::Compare::LessOrEqual);
 }
 
+void WebPImageConverterTest::speedOptions() {
+    auto&& data = SpeedOptionsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _manager.instantiate("WebPImageConverter");
+    converter->configuration().setValue("preset", data.preset);
+    if(data.method)
+        converter->configuration().setValue("method", *data.method);
+    if(data.lowMemory)
+        converter->configuration().setValue("lowMemory", *data.lowMemory);
+    if(data.multithreaded)
+        converter->configuration().setValue("multithreaded", *data.multithreaded);
+
+    Containers::Optional<Containers::Array<char>> output = converter->convertToData(OriginalRgb);
+    CORRADE_VERIFY(output);
+
+    if(_importerManager.loadState("WebPImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("WebPImporter plugin not found, cannot test");
+
+    Containers::Pointer<AbstractImporter> importer = _importerManager.instantiate("WebPImporter");
+    CORRADE_VERIFY(importer->openData(*output));
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE_WITH(*image, OriginalRgb,
+        (DebugTools::CompareImage{data.maxThreshold, data.meanThreshold}));
+}
+
+void WebPImageConverterTest::speedOptionsMethodSize() {
+    auto&& data = SpeedOptionsMethodSizeData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _manager.instantiate("WebPImageConverter");
+    converter->configuration().setValue("preset", data.preset);
+
+    converter->configuration().setValue("method", 0);
+    Containers::Optional<Containers::Array<char>> fastest = converter->convertToData(OriginalRgb);
+    CORRADE_VERIFY(fastest);
+
+    converter->configuration().setValue("method", 6);
+    Containers::Optional<Containers::Array<char>> smallest = converter->convertToData(OriginalRgb);
+    CORRADE_VERIFY(smallest);
+
+    /* The slowest method should produce a smaller output. With libwebp 1.2
+       it's 118 bytes instead of 146 for lossless and 78 bytes instead of 104
+       for lossy. */
+    CORRADE_COMPARE_AS(smallest->size(), fastest->size(),
+        TestSuite::Compare::Less);
+}
+
 void WebPImageConverterTest::importFailed() {
     /* https://github.com/webmproject/libwebp/commit/6c45cef7ff27d84330d2034b014716f75d76302e */
     if(WebPGetEncoderVersion() < 0x010203)
@@ -162,10 +162,14 @@ Containers::Optional<Containers::Array<char>> WebPImageConverter::doConvertToDat
         configuration().value<bool>("exactTransparentRgb") : losslessPreset;
     if(configuration().value<Containers::StringView>("alphaQuality"))
         config.alpha_quality = configuration().value<Int>("alphaQuality");
+    if(configuration().value<Containers::StringView>("method"))
+        config.method = configuration().value<Int>("method");
+    config.low_memory = configuration().value<bool>("lowMemory");
+    config.thread_level = configuration().value<bool>("multithreaded");
     if(!WebPValidateConfig(&config)) {
         /* Yeah, libwebp doesn't provide any better error handling than that.
            Expand when more options are added. */
-        Error{} << "Trade::WebPImageConverter::convertToData(): option validation failed, check the alphaQuality configuration option";
+        Error{} << "Trade::WebPImageConverter::convertToData(): option validation failed, check the alphaQuality and method configuration options";
         return {};
     }
 
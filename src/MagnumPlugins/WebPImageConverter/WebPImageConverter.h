@@ -142,6 +142,21 @@ the file is saved as a regular 2D image.
 The plugin recognizes @ref ImageConverterFlag::Quiet, which will cause all
 conversion warnings to be suppressed.
 
+@subsection Trade-WebPImageConverter-behavior-speed Encoding speed
+
+Besides picking a preset, the encoding speed is affected by the
+@cb{.ini} method @ce
+@ref Trade-WebPImageConverter-configuration "configuration option", which
+trades speed for output size in a range from @cpp 0 @ce to @cpp 6 @ce, and by
+@cb{.ini} lowMemory @ce, which makes lossy encoding use less memory at the
+cost of being slower. Enabling the @cb{.ini} multithreaded @ce option
+turns on multithreaded encoding in libwebp. Note that libwebp doesn't provide
+a way to control the actual thread count, and uses at most a few extra threads
+for parallelizing certain encoding steps, so the speedup is limited. For
+encoding many images at once, such as textures for a glTF asset using the
+`EXT_texture_webp` extension, it's usually more efficient to run several
+conversions in parallel, each with a separate converter instance.
+
 @section Trade-WebPImageConverter-configuration Plugin-specific configuration
 
 It's possible to tune various options through @ref configuration(). See below
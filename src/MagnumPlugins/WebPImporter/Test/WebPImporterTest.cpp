@@ -30,6 +30,7 @@
 #include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/ImageView.h>
@@ -51,6 +52,14 @@ struct WebPImporterTest: TestSuite::Tester {
     void rgb();
     void rgba();
 
+    void animated();
+    void animatedBlend();
+    void animatedRandomAccess();
+    void animatedInvalid();
+
+    void incremental();
+    void incrementalDifferentData();
+
     void openMemory();
     void openTwice();
     void importTwice();
@@ -68,7 +77,6 @@ const struct {
     const char* error;
 } InvalidData[] {
     {"wrong file signature", Utility::Path::join(PNGIMPORTER_TEST_DIR, "rgb.png"), {}, "WebP image features not found: bitstream error\n"},
-    {"animated file", "animated.webp", {}, "animated WebP images aren't supported\n"},
     /* The header information of a lossless bitstream takes 25 bytes according
        to its specification: https://developers.google.com/speed/webp/docs/webp_lossless_bitstream_specification#2_riff_header.
        Hence, 24 bytes would cause an error while trying to extract the header
@@ -127,6 +135,14 @@ WebPImporterTest::WebPImporterTest() {
     addInstancedTests({&WebPImporterTest::rgba},
         Containers::arraySize(RgbaData));
 
+    addTests({&WebPImporterTest::animated,
+              &WebPImporterTest::animatedBlend,
+              &WebPImporterTest::animatedRandomAccess,
+              &WebPImporterTest::animatedInvalid,
+
+              &WebPImporterTest::incremental,
+              &WebPImporterTest::incrementalDifferentData});
+
     addInstancedTests({&WebPImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
@@ -230,6 +246,198 @@ void WebPImporterTest::rgba() {
         (DebugTools::CompareImage{data.maxThreshold, data.meanThreshold}));
 }
 
+void WebPImporterTest::animated() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("WebPImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(WEBPIMPORTER_TEST_DIR, "animated.webp")));
+    CORRADE_COMPARE(importer->image2DCount(), 2);
+
+    /* Frame delays are exposed through importer state */
+    CORRADE_VERIFY(importer->importerState());
+    CORRADE_COMPARE_AS((Containers::ArrayView<const Int>{
+        reinterpret_cast<const Int*>(importer->importerState()),
+        importer->image2DCount()}),
+        Containers::arrayView<Int>({200, 200}),
+        TestSuite::Compare::Container);
+
+    for(UnsignedInt i: {0, 1}) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(i);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE(image->flags(), ImageFlags2D{});
+        CORRADE_COMPARE(image->size(), Vector2i(27, 27));
+        CORRADE_COMPARE(image->format(), PixelFormat::RGBA8Unorm);
+        CORRADE_COMPARE(image->data().size(), 27*27*4);
+    }
+}
+
+void WebPImporterTest::animatedBlend() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("WebPImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(WEBPIMPORTER_TEST_DIR, "animated-blend.webp")));
+    CORRADE_COMPARE(importer->image2DCount(), 3);
+
+    /* See animated-blend.py for how the frames are made. Both rows are the
+       same so the Y flip doesn't matter. The first frame is the whole canvas
+       red, the second blends an opaque blue square over the right half and
+       the third a fully transparent square over the left half, which leaves
+       it unchanged. */
+    const char expected[][2*16]{
+        {'\xff', 0, 0, '\xff', '\xff', 0, 0, '\xff',
+         '\xff', 0, 0, '\xff', '\xff', 0, 0, '\xff',
+         '\xff', 0, 0, '\xff', '\xff', 0, 0, '\xff',
+         '\xff', 0, 0, '\xff', '\xff', 0, 0, '\xff'},
+        {'\xff', 0, 0, '\xff', '\xff', 0, 0, '\xff',
+         0, 0, '\xff', '\xff', 0, 0, '\xff', '\xff',
+         '\xff', 0, 0, '\xff', '\xff', 0, 0, '\xff',
+         0, 0, '\xff', '\xff', 0, 0, '\xff', '\xff'},
+        {'\xff', 0, 0, '\xff', '\xff', 0, 0, '\xff',
+         0, 0, '\xff', '\xff', 0, 0, '\xff', '\xff',
+         '\xff', 0, 0, '\xff', '\xff', 0, 0, '\xff',
+         0, 0, '\xff', '\xff', 0, 0, '\xff', '\xff'},
+    };
+    for(UnsignedInt i: {0, 1, 2}) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(i);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE(image->size(), Vector2i(4, 2));
+        CORRADE_COMPARE(image->format(), PixelFormat::RGBA8Unorm);
+        CORRADE_COMPARE_AS(image->data(),
+            Containers::arrayView(expected[i]),
+            TestSuite::Compare::Container);
+    }
+}
+
+void WebPImporterTest::animatedRandomAccess() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("WebPImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(WEBPIMPORTER_TEST_DIR, "animated.webp")));
+
+    /* Import the frames in order first */
+    Containers::Optional<Trade::ImageData2D> first = importer->image2D(0);
+    Containers::Optional<Trade::ImageData2D> second = importer->image2D(1);
+    CORRADE_VERIFY(first);
+    CORRADE_VERIFY(second);
+
+    /* Importing the last decoded frame again, an earlier frame, which rewinds
+       the decoder, and a later frame again should give the same results */
+    for(UnsignedInt i: {1, 0, 1}) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> image = importer->image2D(i);
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE_WITH(*image, i ? *second : *first,
+            (DebugTools::CompareImage{0.0f, 0.0f}));
+    }
+}
+
+void WebPImporterTest::animatedInvalid() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("WebPImporter");
+
+    Containers::Optional<Containers::Array<char>> in = Utility::Path::read(Utility::Path::join(WEBPIMPORTER_TEST_DIR, "animated.webp"));
+    CORRADE_VERIFY(in);
+
+    /* Cut in the middle of the first frame */
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openData(in->prefix(100)));
+    CORRADE_COMPARE(out, "Trade::WebPImporter::openData(): cannot parse the animation\n");
+}
+
+const char IncrementalExpectedData[] {
+    '\x52', '\x52', '\xbe',
+    '\x52', '\x52', '\xbe',
+    '\x52', '\x52', '\xbe', 0, 0, 0,
+
+    '\xef', '\x91', '\x91',
+    '\xef', '\x91', '\x91',
+    '\xef', '\x91', '\x91', 0, 0, 0,
+
+    '\x1e', '\x6e', '\x1e',
+    '\x1e', '\x6e', '\x1e',
+    '\x1e', '\x6e', '\x1e', 0, 0, 0,
+};
+
+void WebPImporterTest::incremental() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("WebPImporter");
+    importer->configuration().setValue("incremental", true);
+    importer->addFlags(ImporterFlag::Verbose);
+
+    Containers::Optional<Containers::Array<char>> in = Utility::Path::read(Utility::Path::join(WEBPIMPORTER_TEST_DIR, "rgb-lossless.webp"));
+    CORRADE_VERIFY(in);
+
+    /* Just the header, which is 25 bytes for a lossless file. No pixel data
+       are there yet so the output is all zeros. Opened from a temporary copy
+       to verify the data don't need to stay around for the next open. */
+    {
+        Containers::Array<char> header{InPlaceInit, in->prefix(25)};
+        CORRADE_VERIFY(importer->openMemory(header));
+
+        Containers::String out;
+        Containers::Optional<Trade::ImageData2D> image;
+        {
+            Debug redirectOutput{&out};
+            image = importer->image2D(0);
+        }
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE(image->size(), Vector2i(3, 3));
+        CORRADE_COMPARE(image->format(), PixelFormat::RGB8Unorm);
+        const char zeros[36]{};
+        CORRADE_COMPARE_AS(image->data(),
+            Containers::arrayView(zeros),
+            TestSuite::Compare::Container);
+        CORRADE_COMPARE(out, "Trade::WebPImporter::image2D(): incomplete data, decoded 0 out of 3 rows\n");
+
+        importer->close();
+
+    /* The full file, which continues from where the decoding stopped */
+    } {
+        CORRADE_VERIFY(importer->openMemory(*in));
+
+        Containers::String out;
+        Containers::Optional<Trade::ImageData2D> image;
+        {
+            Debug redirectOutput{&out};
+            image = importer->image2D(0);
+        }
+        CORRADE_VERIFY(image);
+        CORRADE_COMPARE_AS(image->data(),
+            Containers::arrayView(IncrementalExpectedData),
+            TestSuite::Compare::Container);
+        CORRADE_COMPARE(out, "");
+
+        /* Importing again gives back the same */
+        Containers::Optional<Trade::ImageData2D> image2 = importer->image2D(0);
+        CORRADE_VERIFY(image2);
+        CORRADE_COMPARE_AS(image2->data(),
+            Containers::arrayView(IncrementalExpectedData),
+            TestSuite::Compare::Container);
+    }
+}
+
+void WebPImporterTest::incrementalDifferentData() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("WebPImporter");
+    importer->configuration().setValue("incremental", true);
+
+    Containers::Optional<Containers::Array<char>> rgba = Utility::Path::read(Utility::Path::join(WEBPIMPORTER_TEST_DIR, "rgba-lossless.webp"));
+    Containers::Optional<Containers::Array<char>> rgb = Utility::Path::read(Utility::Path::join(WEBPIMPORTER_TEST_DIR, "rgb-lossless.webp"));
+    CORRADE_VERIFY(rgba);
+    CORRADE_VERIFY(rgb);
+
+    /* Start decoding a partial RGBA file */
+    CORRADE_VERIFY(importer->openData(rgba->prefix(25)));
+    Containers::Optional<Trade::ImageData2D> partial = importer->image2D(0);
+    CORRADE_VERIFY(partial);
+    CORRADE_COMPARE(partial->format(), PixelFormat::RGBA8Unorm);
+
+    /* Opening a different file then should start from scratch instead of
+       continuing with the previous one. Open it through openMemory() to
+       verify the previous data don't get referenced after close. */
+    CORRADE_VERIFY(importer->openMemory(*rgb));
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->format(), PixelFormat::RGB8Unorm);
+    CORRADE_COMPARE_AS(image->data(),
+        Containers::arrayView(IncrementalExpectedData),
+        TestSuite::Compare::Container);
+}
+
 void WebPImporterTest::openMemory() {
     auto&& data = OpenMemoryData[testCaseInstanceId()];
     setTestCaseDescription(data.name);
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+
+#
+#   This file is part of Magnum.
+#
+#   Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+#               2020, 2021, 2022, 2023, 2024, 2025
+#             Vladimír Vondruš <mosra@centrum.cz>
+#
+#   Permission is hereby granted, free of charge, to any person obtaining a
+#   copy of this software and associated documentation files (the "Software"),
+#   to deal in the Software without restriction, including without limitation
+#   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+#   and/or sell copies of the Software, and to permit persons to whom the
+#   Software is furnished to do so, subject to the following conditions:
+#
+#   The above copyright notice and this permission notice shall be included
+#   in all copies or substantial portions of the Software.
+#
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+#   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+#   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+#   DEALINGS IN THE SOFTWARE.
+# Generates animated-blend.webp, a 4x2 animation with frames smaller than the
+# canvas, exercising compositing of partial frames and alpha blending. No
+# library used as none allows picking the frame rectangles and blending
+# methods explicitly. Each frame is a single color, which makes it possible to
+# encode it as a lossless bitstream with single-symbol prefix codes that take
+# no bits per pixel. Usage:
+#
+#   ./animated-blend.py
+#
+# The frames are:
+#
+#   0.  whole image opaque red, not blended
+#   1.  2x2 opaque blue square at (2, 0), blended
+#   2.  2x2 fully transparent green square at (0, 0), blended, thus not
+#       changing anything
+
+import struct
+
+# x, y, width, height, RGBA color, blend, duration in milliseconds
+frames = [
+    (0, 0, 4, 2, (0xff, 0x00, 0x00, 0xff), False, 100),
+    (2, 0, 2, 2, (0x00, 0x00, 0xff, 0xff), True, 200),
+    (0, 0, 2, 2, (0x00, 0xff, 0x00, 0x00), True, 300),
+]
+
+class BitWriter:
+    def __init__(self):
+        self.bits = 0
+        self.bitCount = 0
+
+    def write(self, value, count):
+        self.bits |= value << self.bitCount
+        self.bitCount += count
+
+    def data(self):
+        return self.bits.to_bytes((self.bitCount + 7)//8, 'little')
+
+def vp8l(width, height, color):
+    r, g, b, a = color
+    out = BitWriter()
+    out.write(width - 1, 14)
+    out.write(height - 1, 14)
+    out.write(1, 1) # alpha is used
+    out.write(0, 3) # version
+    out.write(0, 1) # no transform
+    out.write(0, 1) # no color cache
+    out.write(0, 1) # no meta prefix codes
+    # Green, red, blue, alpha and distance prefix codes, each a simple code
+    # with a single 8-bit symbol
+    for symbol in [g, r, b, a, 0]:
+        out.write(1, 1) # simple code
+        out.write(0, 1) # one symbol
+        out.write(1, 1) # symbol is 8 bits
+        out.write(symbol, 8)
+    return b'\x2f' + out.data()
+
+def chunk(fourcc, data):
+    return fourcc + struct.pack('<I', len(data)) + data + b'\0'*(len(data) & 1)
+
+def uint24(value):
+    return struct.pack('<I', value)[:3]
+
+# Animation and alpha flags, canvas size
+data = chunk(b'VP8X', bytes([0x12, 0, 0, 0]) + uint24(4 - 1) + uint24(2 - 1))
+# Transparent background color, infinite loop
+data += chunk(b'ANIM', struct.pack('<IH', 0, 0))
+for x, y, width, height, color, blend, duration in frames:
+    data += chunk(b'ANMF',
+        uint24(x//2) + uint24(y//2) + uint24(width - 1) + uint24(height - 1) +
+        uint24(duration) + bytes([0 if blend else 2]) +
+        chunk(b'VP8L', vp8l(width, height, color)))
+
+with open('animated-blend.webp', 'wb') as f:
+    f.write(b'RIFF' + struct.pack('<I', len(data) + 4) + b'WEBP' + data)
@@ -27,17 +27,57 @@
 
 #include "WebPImporter.h"
 
+#include <cstring>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/Vector2.h>
 #include <Magnum/Trade/ImageData.h>
 
 #include <webp/types.h>
 #include <webp/decode.h>
+#include <webp/demux.h>
 #include <webp/mux_types.h>
 
 namespace Magnum { namespace Trade {
 
+struct WebPImporter::Animation {
+    ~Animation() { WebPAnimDecoderDelete(decoder); }
+
+    WebPAnimDecoder* decoder{};
+    Vector2i size;
+    /* Index of the frame the decoder returns next and the last decoded frame,
+       which stays valid until the next WebPAnimDecoderGetNext() or
+       WebPAnimDecoderReset() call */
+    UnsignedInt nextFrame{};
+    const std::uint8_t* lastFrame{};
+    /* Frame durations in milliseconds, exposed through importerState() */
+    Containers::Array<Int> delays;
+};
+
+struct WebPImporter::Incremental {
+    ~Incremental() { WebPIDelete(decoder); }
+
+    /* The decoder references the output and options inside config, so it has
+       to stay at a stable location for the whole decoder lifetime */
+    WebPDecoderConfig config;
+    WebPIDecoder* decoder{};
+    PixelFormat format;
+    Vector2i size;
+    /* Zero-initialized, rows that weren't decoded yet stay zero */
+    Containers::Array<char> out;
+    /* Copy of the data that were fed to the decoder so far, kept after
+       close() in order to detect whether the next opened data is a
+       continuation. The decoder itself only remembers how much of the data it
+       consumed and doesn't access them outside of WebPIUpdate(), so only the
+       part that wasn't there before is copied on every update. */
+    Containers::Array<char> in;
+};
+
 WebPImporter::WebPImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin): AbstractImporter{manager, plugin} {}
 
 WebPImporter::~WebPImporter() = default;
@@ -46,7 +86,11 @@ ImporterFeatures WebPImporter::doFeatures() const { return ImporterFeature::Open
 
 bool WebPImporter::doIsOpened() const { return _in; }
 
-void WebPImporter::doClose() { _in = nullptr; }
+void WebPImporter::doClose() {
+    /* The animation decoder references the input data, delete it first */
+    _animation = nullptr;
+    _in = nullptr;
+}
 
 void WebPImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dataFlags) {
     /* Because here we're copying the data and using the _in to check if file
@@ -66,6 +110,56 @@ void WebPImporter::doOpenData(Containers::Array<char>&& data, const DataFlags da
         _in = Utility::move(data);
     else
         _in = Containers::Array<char>{InPlaceInit, data};
+
+    /* Continue with the previous incremental decoding only if the new data
+       start with everything that was fed to the decoder so far, otherwise
+       start from scratch in doImage2D() */
+    if(_incremental && (!configuration().value<bool>("incremental") || _in.size() < _incremental->in.size() || std::memcmp(_in.data(), _incremental->in.data(), _incremental->in.size()) != 0))
+        _incremental = nullptr;
+
+    /* If the file is animated, set up an animation decoder. Other failures
+       are left for doImage2D() to handle. */
+    WebPBitstreamFeatures bitstream;
+    if(WebPGetFeatures(reinterpret_cast<std::uint8_t*>(_in.data()), _in.size(), &bitstream) != VP8_STATUS_OK || !bitstream.has_animation)
+        return;
+
+    WebPAnimDecoderOptions options;
+    CORRADE_INTERNAL_ASSERT_OUTPUT(WebPAnimDecoderOptionsInit(&options));
+    /* The decoder blends the frames together so the output always has an
+       alpha channel */
+    options.color_mode = MODE_RGBA;
+    WebPData webpData;
+    webpData.bytes = reinterpret_cast<std::uint8_t*>(_in.data());
+    webpData.size = _in.size();
+    WebPAnimDecoder* const decoder = WebPAnimDecoderNew(&webpData, &options);
+    if(!decoder) {
+        Error{} << "Trade::WebPImporter::openData(): cannot parse the animation";
+        _in = nullptr;
+        return;
+    }
+
+    _animation.emplace();
+    _animation->decoder = decoder;
+
+    WebPAnimInfo info;
+    CORRADE_INTERNAL_ASSERT_OUTPUT(WebPAnimDecoderGetInfo(decoder, &info));
+    _animation->size = {Int(info.canvas_width), Int(info.canvas_height)};
+
+    /* Frame durations are fetched from the demuxer, which doesn't need any
+       frame to be decoded */
+    const WebPDemuxer* const demuxer = WebPAnimDecoderGetDemuxer(decoder);
+    _animation->delays = Containers::Array<Int>{NoInit, info.frame_count};
+    for(UnsignedInt i = 0; i != info.frame_count; ++i) {
+        WebPIterator iterator;
+        /* Frame numbers are one-based */
+        CORRADE_INTERNAL_ASSERT_OUTPUT(WebPDemuxGetFrame(demuxer, i + 1, &iterator));
+        _animation->delays[i] = iterator.duration;
+        WebPDemuxReleaseIterator(&iterator);
+    }
+}
+
+const void* WebPImporter::doImporterState() const {
+    return _animation ? _animation->delays.data() : nullptr;
 }
 
 namespace {
@@ -89,9 +183,47 @@ const char* vp8StatusCodeString(const VP8StatusCode status) {
 
 }
 
-UnsignedInt WebPImporter::doImage2DCount() const { return 1; }
+UnsignedInt WebPImporter::doImage2DCount() const {
+    return _animation ? _animation->delays.size() : 1;
+}
+
+Containers::Optional<ImageData2D> WebPImporter::doImage2D(const UnsignedInt id, UnsignedInt) {
+    /* Animated file. The decoder can only go forward, so rewind it if an
+       earlier frame than the last decoded one is requested. Importing frames
+       in order thus decodes each of them just once. */
+    if(_animation) {
+        if(!_animation->lastFrame || id + 1 < _animation->nextFrame) {
+            WebPAnimDecoderReset(_animation->decoder);
+            _animation->nextFrame = 0;
+            _animation->lastFrame = nullptr;
+        }
+
+        while(_animation->nextFrame <= id) {
+            std::uint8_t* frame;
+            int timestamp;
+            if(!WebPAnimDecoderGetNext(_animation->decoder, &frame, &timestamp)) {
+                Error{} << "Trade::WebPImporter::image2D(): cannot decode frame" << _animation->nextFrame;
+                /* Start from scratch next time */
+                _animation->lastFrame = nullptr;
+                return {};
+            }
+
+            _animation->lastFrame = frame;
+            ++_animation->nextFrame;
+        }
+
+        /* The decoder doesn't have any option to flip the output, do that
+           while copying. Four-channel rows are always four-byte aligned. */
+        const Vector2i size = _animation->size;
+        Containers::Array<char> outData{NoInit, std::size_t(size.product()*4)};
+        const Containers::StridedArrayView2D<const char> src{
+            Containers::arrayView(reinterpret_cast<const char*>(_animation->lastFrame), outData.size()),
+            {std::size_t(size.y()), std::size_t(size.x()*4)}};
+        Utility::copy(src.flipped<0>(), Containers::StridedArrayView2D<char>{outData, {std::size_t(size.y()), std::size_t(size.x()*4)}});
+
+        return Trade::ImageData2D{PixelFormat::RGBA8Unorm, size, Utility::move(outData)};
+    }
 
-Containers::Optional<ImageData2D> WebPImporter::doImage2D(UnsignedInt, UnsignedInt) {
     /* Decoder configuration */
     WebPDecoderConfig config;
     CORRADE_INTERNAL_ASSERT_OUTPUT(WebPInitDecoderConfig(&config));
@@ -107,13 +239,6 @@ Containers::Optional<ImageData2D> WebPImporter::doImage2D(UnsignedInt, UnsignedI
         return {};
     }
 
-    /* Filtering animated WebP files, they are subject to a different decoding
-       process defined in demux library */
-    if(bitstream.format == 0) {
-        Error{} << "Trade::WebPImporter::image2D(): animated WebP images aren't supported";
-        return {};
-    }
-
     /* Channel number and pixel format (always 8-bit per channel) determined by
        alpha transparency. No special handling for lossy vs lossless files. */
     Int channels = 3;
@@ -125,9 +250,56 @@ Containers::Optional<ImageData2D> WebPImporter::doImage2D(UnsignedInt, UnsignedI
         colourDepth = MODE_RGBA;
     }
 
+    const std::size_t stride = 4*((bitstream.width*channels + 3)/4);
+
+    /* Incremental decoding, feeding the decoder with whatever new data were
+       added since the last call */
+    if(configuration().value<bool>("incremental")) {
+        if(!_incremental) {
+            _incremental.emplace();
+            CORRADE_INTERNAL_ASSERT_OUTPUT(WebPInitDecoderConfig(&_incremental->config));
+            _incremental->config.options.flip = true;
+            _incremental->format = pixelFormat;
+            _incremental->size = {bitstream.width, bitstream.height};
+            _incremental->out = Containers::Array<char>{ValueInit, stride*bitstream.height};
+
+            WebPDecBuffer& outputBuffer = _incremental->config.output;
+            outputBuffer.u.RGBA.size = _incremental->out.size();
+            outputBuffer.u.RGBA.stride = stride;
+            outputBuffer.u.RGBA.rgba = reinterpret_cast<std::uint8_t*>(_incremental->out.data());
+            outputBuffer.colorspace = colourDepth;
+            outputBuffer.is_external_memory = 1;
+
+            /* This fails only on an allocation failure */
+            _incremental->decoder = WebPIDecode(nullptr, 0, &_incremental->config);
+            CORRADE_INTERNAL_ASSERT(_incremental->decoder);
+        }
+
+        /* The decoder doesn't copy the data, it only remembers how much of
+           it was consumed already and continues from there */
+        const VP8StatusCode updateStatus = WebPIUpdate(_incremental->decoder, reinterpret_cast<std::uint8_t*>(_in.data()), _in.size());
+        if(updateStatus != VP8_STATUS_OK && updateStatus != VP8_STATUS_SUSPENDED) {
+            Error err;
+            err << "Trade::WebPImporter::image2D(): decoding error:" << vp8StatusCodeString(updateStatus);
+            /* Start from scratch next time */
+            _incremental = nullptr;
+            return {};
+        }
+        arrayAppend(_incremental->in, _in.exceptPrefix(_incremental->in.size()));
+
+        if(updateStatus == VP8_STATUS_SUSPENDED && (flags() & ImporterFlag::Verbose)) {
+            /* The last row is zero if nothing was decoded yet, in which case
+               the function returns null and doesn't touch it */
+            int lastRow = 0;
+            WebPIDecGetRGB(_incremental->decoder, &lastRow, nullptr, nullptr, nullptr);
+            Debug{} << "Trade::WebPImporter::image2D(): incomplete data, decoded" << lastRow << "out of" << _incremental->size.y() << "rows";
+        }
+
+        return Trade::ImageData2D{_incremental->format, _incremental->size, Containers::Array<char>{InPlaceInit, _incremental->out}};
+    }
+
     /* Structure and configuration for decoding */
     WebPDecBuffer& outputBuffer = config.output;
-    const std::size_t stride = 4*((bitstream.width*channels + 3)/4);
     outputBuffer.u.RGBA.size = stride*bitstream.height;
     outputBuffer.u.RGBA.stride = stride;
     outputBuffer.colorspace = colourDepth;
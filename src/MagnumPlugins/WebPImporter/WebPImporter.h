@@ -33,6 +33,7 @@
  */
 
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Magnum/Trade/AbstractImporter.h>
 
 #include "MagnumPlugins/WebPImporter/configure.h"
@@ -136,7 +137,53 @@ is imported as either @ref PixelFormat::RGB8Unorm or
 @ref PixelFormat::RGBA8Unorm. It doesn't have a special colorspace for
 grayscale, those are encoded the same way as RGB.
 
-The importer doesn't support decoding of animated WebP files.
+@subsection Trade-WebPImporter-behavior-animated Animated files
+
+Animated files are decoded using the demux library that's a part of libwebp.
+The importer reports frame count in @ref image2DCount() and each frame is
+imported as a separate @ref PixelFormat::RGBA8Unorm image of the full canvas
+size, with the frame already blended over the previous ones. Similarly to
+@ref StbImageImporter and animated GIFs, frame durations are exposed through
+@ref importerState() as an array of @ref Magnum::Int "Int", where each entry is
+number of milliseconds to wait before advancing to the next frame:
+
+@snippet WebPImporter.cpp animation-delays
+
+Because each frame depends on the previous ones, they're decoded on demand in
+a sequence. Importing the frames in order decodes each of them just once,
+importing a frame that's earlier than the last imported one restarts the
+decoding from the first frame.
+
+@subsection Trade-WebPImporter-behavior-incremental Incremental decoding
+
+If the @cb{.ini} incremental @ce
+@ref Trade-WebPImporter-configuration "configuration option" is enabled, still
+images are decoded using the libwebp incremental decoder, which allows
+displaying partially received files, for example when streaming them over a
+network. Opening a file that's incomplete succeeds as long as it contains the
+file header, @ref image2D() then returns an image of the full size with the
+rows that couldn't be decoded yet filled with zeros. With
+@ref ImporterFlag::Verbose enabled, the importer prints how many rows were
+decoded.
+
+The decoder state is preserved across @ref openData() calls. If the newly
+opened data start with all data that were opened previously, decoding continues
+from where it stopped instead of starting over, so progressively opening a
+growing buffer decodes each part of it just once. For the check, the importer
+keeps a copy of the data decoded so far, copying only the newly added part on
+each @ref image2D() call. In particular, with @ref openMemory() the previous
+memory can be freed or reused before opening the next part. Animated files
+aren't decoded incrementally.
+
+@section Trade-WebPImporter-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration(). See
+below for all options and their default values:
+
+@snippet MagnumPlugins/WebPImporter/WebPImporter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_WEBPIMPORTER_EXPORT WebPImporter: public AbstractImporter {
     public:
@@ -151,10 +198,17 @@ class MAGNUM_WEBPIMPORTER_EXPORT WebPImporter: public AbstractImporter {
         MAGNUM_WEBPIMPORTER_LOCAL void doClose() override;
         MAGNUM_WEBPIMPORTER_LOCAL void doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) override;
 
+        MAGNUM_WEBPIMPORTER_LOCAL const void* doImporterState() const override;
+
         MAGNUM_WEBPIMPORTER_LOCAL UnsignedInt doImage2DCount() const override;
         MAGNUM_WEBPIMPORTER_LOCAL Containers::Optional<ImageData2D> doImage2D(UnsignedInt id, UnsignedInt level) override;
 
+        struct Animation;
+        struct Incremental;
+
         Containers::Array<char> _in;
+        Containers::Pointer<Animation> _animation;
+        Containers::Pointer<Incremental> _incremental;
 };
 
 }}